@@ -0,0 +1,117 @@
+// Frame benchmark and allocation check for the BroadPhase simulation.
+//
+// Runs the frame graph headless the way the app does (the next frame
+// simulating in the background while the last one is "drawn", every layer
+// on), and reports time per frame and heap allocations per frame.
+//
+//   broad_phase_frame_bench [--shapes N] [--frames N] [--warmup N] [--fail-on-alloc]
+//
+// With --fail-on-alloc it exits non-zero if any frame after the warmup
+// allocates; the broad_phase_alloc_check target runs it that way. Counting
+// needs a -DPHYSICS_ALLOC_TRACKING=ON build.
+
+#include "frame_graph.h"
+#include "physics.h"
+#include "alloc_hooks.h"
+#include "alloc_tracking.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+constexpr float kWorldW = 1280.0f;
+constexpr float kWorldH = 720.0f;
+
+static void print_usage() {
+    std::fprintf(stderr,
+        "usage: broad_phase_frame_bench [options]\n"
+        "  --shapes N        shapes in the world (default 200, the app's maximum)\n"
+        "  --frames N        frames to time after the warmup (default 600)\n"
+        "  --warmup N        frames allowed to allocate while buffers grow (default 60)\n"
+        "  --fail-on-alloc   exit 1 if any frame after the warmup allocates\n");
+}
+
+int main(int argc, char** argv) {
+    int  shapes        = 200;
+    int  frames        = 600;
+    int  warmup        = 60;
+    bool fail_on_alloc = false;
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--shapes") == 0 && has_value) {
+            shapes = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--frames") == 0 && has_value) {
+            frames = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--warmup") == 0 && has_value) {
+            warmup = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--fail-on-alloc") == 0) {
+            fail_on_alloc = true;
+        } else {
+            print_usage();
+            return 1;
+        }
+    }
+    if (shapes < 1 || frames < 1 || warmup < 0) {
+        print_usage();
+        return 1;
+    }
+    if (fail_on_alloc && !alloc_tracking_enabled()) {
+        std::fprintf(stderr, "--fail-on-alloc needs a build configured with -DPHYSICS_ALLOC_TRACKING=ON\n");
+        return 1;
+    }
+
+    std::srand(1);
+    PhysicsWorld world;
+    world.ensure_count(shapes, kWorldW, kWorldH);
+    FrameGraph sim(world);
+    FrameData  buffers[2];
+    int        shown = 0;
+
+    FrameInput in;
+    in.dt             = 1.0f / 60.0f;
+    in.world_w        = kWorldW;
+    in.world_h        = kWorldH;
+    in.brute_compare  = true;
+    in.query_vis      = true;
+    in.selected_shape = 0;
+
+    // Stand-in for drawing: read what the renderer would
+    double sink = 0.0;
+    auto draw = [&](const FrameData& f) {
+        for (const auto& s : f.shapes) sink += s.pos.x;
+        sink += static_cast<double>(f.broad_pairs.size() + f.collision_set.size() + f.query_steps.size());
+    };
+
+    AllocFrameStats allocs(warmup);
+    double total_ms = 0.0, best_ms = 1e30;
+    for (int frame = 0; frame < warmup + frames; ++frame) {
+        auto t0 = std::chrono::steady_clock::now();
+        sim.finish();
+        shown ^= 1;
+        sim.start(in, buffers[shown ^ 1]);
+        draw(buffers[shown]);
+        allocs.end_frame();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        if (frame >= warmup) {
+            total_ms += ms;
+            best_ms = std::min(best_ms, ms);
+        }
+    }
+    sim.finish();
+
+    const FrameStats& st = buffers[shown ^ 1].stats;
+    std::printf("%d shapes, %d threads: %.3f ms/frame mean, %.3f best  (%d pairs, %d collisions%s)\n",
+                shapes, JobSystem::instance().thread_count(), total_ms / frames, best_ms,
+                st.broad_phase_pairs, st.actual_collisions, st.bvh_mismatch ? ", BVH MISMATCH" : "");
+    allocs.print(stdout);
+    if (sink < 0.0) std::printf("\n");
+
+    if (st.bvh_mismatch) return 1;
+    if (fail_on_alloc && allocs.steady_allocates()) {
+        std::fprintf(stderr, "FAIL: %llu allocations after the %d-frame warmup\n",
+                     static_cast<unsigned long long>(allocs.steady_allocs()), warmup);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+// Kernel microbenchmarks for the broad and narrow phase (bench.h):
+//
+//   aabb_overlap         one AABB-AABB test, over every pair of 256 boxes
+//   sat_narrow_phase     shapes_intersect on the pairs whose AABBs overlap,
+//                        a crowded scene's mix of circles and polygons
+//   sat_polygon_polygon  shapes_intersect on overlapping polygon pairs only
+
+#include "aabb.h"
+#include "shape.h"
+#include "bench.h"
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+constexpr int   kShapes = 256;
+constexpr float kWorld  = 480.0f;   // crowded: about a third of the AABB pairs overlap
+
+static std::vector<Shape> random_shapes() {
+    std::srand(7);
+    std::vector<Shape> shapes;
+    shapes.reserve(kShapes);
+    for (int i = 0; i < kShapes; ++i) shapes.push_back(make_random_shape(kWorld, kWorld, i));
+    return shapes;
+}
+
+static std::vector<std::pair<int, int>> overlapping_pairs(const std::vector<Shape>& shapes, bool polygons_only) {
+    std::vector<std::pair<int, int>> pairs;
+    int n = static_cast<int>(shapes.size());
+    for (int i = 0; i < n; ++i)
+        for (int j = i + 1; j < n; ++j) {
+            if (polygons_only && (shapes[i].type == ShapeType::Circle || shapes[j].type == ShapeType::Circle))
+                continue;
+            if (shapes[i].compute_aabb().overlaps(shapes[j].compute_aabb())) pairs.emplace_back(i, j);
+        }
+    return pairs;
+}
+
+BENCHMARK(aabb_overlap) {
+    std::vector<Shape> shapes = random_shapes();
+    std::vector<AABB> boxes;
+    for (const Shape& s : shapes) boxes.push_back(s.compute_aabb());
+    state.set_items(kShapes * (kShapes - 1) / 2.0);
+    while (state.keep_running()) {
+        int hits = 0;
+        for (int i = 0; i < kShapes; ++i)
+            for (int j = i + 1; j < kShapes; ++j) hits += boxes[i].overlaps(boxes[j]);
+        bench_keep(hits);
+    }
+}
+
+BENCHMARK(sat_narrow_phase) {
+    std::vector<Shape> shapes = random_shapes();
+    std::vector<std::pair<int, int>> pairs = overlapping_pairs(shapes, false);
+    state.set_items(static_cast<double>(pairs.size()));
+    while (state.keep_running()) {
+        int hits = 0;
+        for (auto [i, j] : pairs) hits += shapes_intersect(shapes[i], shapes[j]);
+        bench_keep(hits);
+    }
+}
+
+BENCHMARK(sat_polygon_polygon) {
+    std::vector<Shape> shapes = random_shapes();
+    std::vector<std::pair<int, int>> pairs = overlapping_pairs(shapes, true);
+    state.set_items(static_cast<double>(pairs.size()));
+    while (state.keep_running()) {
+        int hits = 0;
+        for (auto [i, j] : pairs) hits += shapes_intersect(shapes[i], shapes[j]);
+        bench_keep(hits);
+    }
+}
+
+BENCHMARK_MAIN()
@@ -1,4 +1,5 @@
 #include "bvh.h"
+#include "job_system.h"
 #include <algorithm>
 #include <numeric>
 
@@ -11,30 +12,34 @@ void BVH::build(const std::vector<AABB>& aabbs) {
     clear();
     if (aabbs.empty()) return;
 
-    std::vector<int> indices(aabbs.size());
-    std::iota(indices.begin(), indices.end(), 0);
+    indices_.resize(aabbs.size());
+    std::iota(indices_.begin(), indices_.end(), 0);
 
-    nodes_.reserve(2 * aabbs.size());
-    build_recursive(indices, aabbs, 0);
+    // A median-split tree over n leaves has exactly 2n - 1 nodes, laid out
+    // depth-first: node, left subtree, right subtree
+    int count = static_cast<int>(indices_.size());
+    nodes_.assign(2 * count - 1, {});
+    max_depth_ = build_recursive(indices_.data(), count, aabbs, 0, 0);
 }
 
-int BVH::build_recursive(std::vector<int>& indices, const std::vector<AABB>& aabbs, int depth) {
-    if (depth > max_depth_) max_depth_ = depth;
+// Subtrees with at least this many leaves build their halves as a fork / join pair
+static constexpr int kParallelBuildLeaves = 512;
 
-    int node_idx = static_cast<int>(nodes_.size());
-    nodes_.push_back({});
+int BVH::build_recursive(int* indices, int count, const std::vector<AABB>& aabbs,
+                         int node_idx, int depth) {
+    BVHNode& node = nodes_[node_idx];
+    node.depth = depth;
+    node.subtree_size = count;
 
     // Compute bounding box of all shapes in this subset
     AABB bounds = aabbs[indices[0]];
-    for (size_t i = 1; i < indices.size(); ++i)
+    for (int i = 1; i < count; ++i)
         bounds = bounds.merged(aabbs[indices[i]]);
+    node.bounds = bounds;
 
-    if (indices.size() == 1) {
-        nodes_[node_idx].bounds = bounds;
-        nodes_[node_idx].depth = depth;
-        nodes_[node_idx].shape_index = indices[0];
-        nodes_[node_idx].subtree_size = 1;
-        return node_idx;
+    if (count == 1) {
+        node.shape_index = indices[0];
+        return depth;
     }
 
     // Choose split axis: longest extent
@@ -43,34 +48,36 @@ int BVH::build_recursive(std::vector<int>& indices, const std::vector<AABB>& aab
     bool split_x = (w >= h);
 
     // Sort by centroid along chosen axis
-    std::sort(indices.begin(), indices.end(), [&](int a, int b) {
+    std::sort(indices, indices + count, [&](int a, int b) {
         if (split_x)
             return aabbs[a].center().x < aabbs[b].center().x;
         else
             return aabbs[a].center().y < aabbs[b].center().y;
     });
 
-    // Median split
-    size_t mid = indices.size() / 2;
-    std::vector<int> left_indices(indices.begin(), indices.begin() + mid);
-    std::vector<int> right_indices(indices.begin() + mid, indices.end());
-
-    int left_idx = build_recursive(left_indices, aabbs, depth + 1);
-    int right_idx = build_recursive(right_indices, aabbs, depth + 1);
-
-    // Set node data (must be after recursive calls due to vector reallocation)
-    nodes_[node_idx].bounds = bounds;
-    nodes_[node_idx].depth = depth;
-    nodes_[node_idx].left = left_idx;
-    nodes_[node_idx].right = right_idx;
-    nodes_[node_idx].subtree_size = nodes_[left_idx].subtree_size +
-                                     nodes_[right_idx].subtree_size;
-
-    return node_idx;
+    // Median split; the left subtree takes the 2 * mid - 1 slots after this node
+    int mid = count / 2;
+    node.left  = node_idx + 1;
+    node.right = node_idx + 2 * mid;
+
+    int left_depth = 0, right_depth = 0;
+    auto build_left = [&] {
+        left_depth = build_recursive(indices, mid, aabbs, node.left, depth + 1);
+    };
+    auto build_right = [&] {
+        right_depth = build_recursive(indices + mid, count - mid, aabbs, node.right, depth + 1);
+    };
+    if (count >= kParallelBuildLeaves) {
+        parallel_invoke(build_left, build_right);
+    } else {
+        build_left();
+        build_right();
+    }
+    return std::max(left_depth, right_depth);
 }
 
 // Self-query: find all overlapping leaf pairs within a subtree or between two subtrees
-void BVH::self_query(int a, int b, std::vector<std::pair<int,int>>& pairs) const {
+void BVH::self_query(int a, int b, PairList& pairs) const {
     if (a < 0 || b < 0) return;
     const BVHNode& na = nodes_[a];
     const BVHNode& nb = nodes_[b];
@@ -115,18 +122,20 @@ void BVH::self_query(int a, int b, std::vector<std::pair<int,int>>& pairs) const
     }
 }
 
-std::vector<std::pair<int,int>> BVH::find_all_pairs() const {
-    std::vector<std::pair<int,int>> pairs;
+PairList BVH::find_all_pairs(std::pmr::memory_resource* mr) const {
+    PairList pairs(mr);
     if (nodes_.empty()) return pairs;
     self_query(0, 0, pairs);
     return pairs;
 }
 
-std::vector<int> BVH::query(const AABB& query_box, int exclude_index) const {
-    std::vector<int> results;
+std::pmr::vector<int> BVH::query(const AABB& query_box, int exclude_index,
+                                 std::pmr::memory_resource* mr) const {
+    std::pmr::vector<int> results(mr);
     if (nodes_.empty()) return results;
 
-    std::vector<int> stack;
+    std::pmr::vector<int> stack(mr);
+    stack.reserve(max_depth_ + 2);   // one pending sibling per level
     stack.push_back(0);
 
     while (!stack.empty()) {
@@ -148,11 +157,13 @@ std::vector<int> BVH::query(const AABB& query_box, int exclude_index) const {
     return results;
 }
 
-std::vector<TraversalStep> BVH::query_with_steps(const AABB& query_box, int query_index) const {
-    std::vector<TraversalStep> steps;
+StepList BVH::query_with_steps(const AABB& query_box, int query_index,
+                               std::pmr::memory_resource* mr) const {
+    StepList steps(mr);
     if (nodes_.empty()) return steps;
 
-    std::vector<int> stack;
+    std::pmr::vector<int> stack(mr);
+    stack.reserve(max_depth_ + 2);   // one pending sibling per level
     stack.push_back(0);
 
     while (!stack.empty()) {
@@ -180,8 +191,8 @@ std::vector<TraversalStep> BVH::query_with_steps(const AABB& query_box, int quer
     return steps;
 }
 
-std::vector<std::pair<int,int>> brute_force_pairs(const std::vector<AABB>& aabbs) {
-    std::vector<std::pair<int,int>> pairs;
+PairList brute_force_pairs(const std::vector<AABB>& aabbs, std::pmr::memory_resource* mr) {
+    PairList pairs(mr);
     int n = static_cast<int>(aabbs.size());
     for (int i = 0; i < n; ++i)
         for (int j = i + 1; j < n; ++j)
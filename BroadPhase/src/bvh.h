@@ -1,5 +1,7 @@
 #pragma once
 #include "aabb.h"
+#include <memory_resource>
+#include <set>
 #include <vector>
 #include <utility>
 
@@ -21,31 +23,46 @@ struct TraversalStep {
     int             partner_shape;  // Partner shape (for LeafTest)
 };
 
+// Per-frame results; they allocate from whatever resource the caller passes
+// (the frame's arena in the app)
+using PairList = std::pmr::vector<std::pair<int,int>>;
+using PairSet  = std::pmr::set<std::pair<int,int>>;
+using StepList = std::pmr::vector<TraversalStep>;
+
 class BVH {
 public:
     void build(const std::vector<AABB>& aabbs);
     void clear();
 
     // Find all overlapping pairs via self-query
-    std::vector<std::pair<int,int>> find_all_pairs() const;
+    PairList find_all_pairs(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) const;
 
     // Query for shapes overlapping a given AABB, recording traversal steps
-    std::vector<TraversalStep> query_with_steps(const AABB& query, int query_index) const;
+    StepList query_with_steps(const AABB& query, int query_index,
+                              std::pmr::memory_resource* mr = std::pmr::get_default_resource()) const;
 
-    // Query for shape indices overlapping a given AABB
-    std::vector<int> query(const AABB& query, int exclude_index) const;
+    // Query for shape indices overlapping a given AABB; the traversal stack
+    // comes from mr too
+    std::pmr::vector<int> query(const AABB& query, int exclude_index,
+                                std::pmr::memory_resource* mr = std::pmr::get_default_resource()) const;
 
     const std::vector<BVHNode>& nodes() const { return nodes_; }
     int root() const { return nodes_.empty() ? -1 : 0; }
     int max_depth() const { return max_depth_; }
 
 private:
-    int build_recursive(std::vector<int>& indices, const std::vector<AABB>& aabbs, int depth);
-    void self_query(int nodeA, int nodeB, std::vector<std::pair<int,int>>& pairs) const;
+    // Builds the subtree over indices[0, count) into nodes_[node_idx ..
+    // node_idx + 2 * count - 1) and returns its deepest level. Node slots are
+    // fixed by the median split, so large subtrees build in parallel.
+    int build_recursive(int* indices, int count, const std::vector<AABB>& aabbs,
+                        int node_idx, int depth);
+    void self_query(int nodeA, int nodeB, PairList& pairs) const;
 
     std::vector<BVHNode> nodes_;
+    std::vector<int>     indices_;   // build scratch, kept between builds
     int max_depth_ = 0;
 };
 
 // Brute-force all pairs that have overlapping AABBs
-std::vector<std::pair<int,int>> brute_force_pairs(const std::vector<AABB>& aabbs);
+PairList brute_force_pairs(const std::vector<AABB>& aabbs,
+                           std::pmr::memory_resource* mr = std::pmr::get_default_resource());
@@ -0,0 +1,124 @@
+#include "frame_graph.h"
+#include "perf_counters.h"
+#include <algorithm>
+
+void FrameData::begin_frame() {
+    broad_pairs        = PairList(&arena);
+    brute_pairs        = PairList(&arena);
+    collision_set      = PairSet(&arena);
+    false_positive_set = PairSet(&arena);
+    query_steps        = StepList(&arena);
+    arena.reset();
+}
+
+FrameGraph::FrameGraph(PhysicsWorld& world) : world_(world) {
+    auto integrate = graph_.add("integrate", [this] {
+        if (!in_.paused)
+            world_.update(in_.dt, in_.speed_mult, in_.world_w, in_.world_h);
+    });
+
+    // The renderer draws the copy while the world moves on
+    graph_.add("snapshot", [this] { out_->shapes = world_.shapes; }, {integrate});
+
+    auto aabbs = graph_.add("aabbs", [this] {
+        int n = static_cast<int>(world_.shapes.size());
+        out_->aabbs.resize(n);
+        for (int i = 0; i < n; ++i)
+            out_->aabbs[i] = world_.shapes[i].compute_aabb();
+    }, {integrate});
+
+    auto bvh = graph_.add("bvh", [this] {
+        PERF_SCOPE("bvh build", out_->aabbs.size(), PerfScope::kAllThreads);
+        out_->bvh.build(out_->aabbs);
+        out_->stats.bvh_node_count = static_cast<int>(out_->bvh.nodes().size());
+    }, {aabbs});
+
+    // Brute force (for comparison layer + BVH verification)
+    auto brute = graph_.add("brute", [this] {
+        if (!in_.brute_compare) return;
+        out_->brute_pairs = brute_force_pairs(out_->aabbs, &out_->arena);
+        out_->stats.brute_force_pairs = static_cast<int>(out_->brute_pairs.size());
+    }, {aabbs});
+
+    auto pairs = graph_.add("pairs", [this] {
+        if (in_.use_bvh) {
+            PERF_SCOPE("bvh self-query", out_->aabbs.size());
+            out_->broad_pairs = out_->bvh.find_all_pairs(&out_->arena);
+        } else {
+            out_->broad_pairs = brute_force_pairs(out_->aabbs, &out_->arena);
+        }
+        out_->stats.broad_phase_pairs = static_cast<int>(out_->broad_pairs.size());
+    }, {bvh});
+
+    // Verify BVH produces same pair set as brute force
+    graph_.add("verify", [this] {
+        if (!in_.brute_compare) return;
+        if (in_.use_bvh) {
+            PairList bvh_sorted(out_->broad_pairs, &out_->arena);
+            PairList bf_sorted(out_->brute_pairs, &out_->arena);
+            std::sort(bvh_sorted.begin(), bvh_sorted.end());
+            std::sort(bf_sorted.begin(), bf_sorted.end());
+            out_->stats.bvh_mismatch = (bvh_sorted != bf_sorted);
+        } else {
+            out_->stats.bvh_mismatch = false;
+        }
+    }, {pairs, brute});
+
+    graph_.add("narrow", [this] {
+        FrameData& f = *out_;
+        PERF_SCOPE("narrow phase", f.broad_pairs.size());
+        int n = static_cast<int>(world_.shapes.size());
+        f.stats.actual_collisions = 0;
+        f.stats.false_positives = 0;
+        for (auto& [i, j] : f.broad_pairs) {
+            if (i < 0 || i >= n || j < 0 || j >= n) continue;
+            auto key = i < j ? std::pair(i,j) : std::pair(j,i);
+            if (shapes_intersect(world_.shapes[i], world_.shapes[j])) {
+                f.collision_set.insert(key);
+                f.stats.actual_collisions++;
+            } else {
+                f.false_positive_set.insert(key);
+                f.stats.false_positives++;
+            }
+        }
+        f.stats.narrow_phase_tests = static_cast<int>(f.broad_pairs.size());
+    }, {pairs});
+
+    // Query steps for selected shape
+    graph_.add("query", [this] {
+        FrameData& f = *out_;
+        int n = static_cast<int>(f.aabbs.size());
+        if (in_.query_vis && in_.selected_shape >= 0 && in_.selected_shape < n)
+            f.query_steps = f.bvh.query_with_steps(f.aabbs[in_.selected_shape], in_.selected_shape,
+                                                   &f.arena);
+    }, {bvh});
+
+    async_.owner = this;
+    async_.execute = [](Job* job) {
+        FrameGraph& fg = *static_cast<AsyncJob*>(job)->owner;
+        fg.graph_.run();
+    };
+}
+
+void FrameGraph::run(const FrameInput& in, FrameData& out) {
+    finish();
+    in_  = in;
+    out_ = &out;
+    out.begin_frame();
+    graph_.run();
+}
+
+void FrameGraph::start(const FrameInput& in, FrameData& out) {
+    finish();
+    in_  = in;
+    out_ = &out;
+    out.begin_frame();
+    running_ = true;
+    JobSystem::instance().submit(async_, pending_);
+}
+
+void FrameGraph::finish() {
+    if (!running_) return;
+    JobSystem::instance().wait(pending_);
+    running_ = false;
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include "aabb.h"
+#include "shape.h"
+#include "bvh.h"
+#include "physics.h"
+#include "task_graph.h"
+#include "frame_arena.h"
+#include <atomic>
+#include <vector>
+
+// Settings one frame's simulation reads, copied from the UI on the main thread
+struct FrameInput {
+    float dt             = 0.0f;
+    float speed_mult     = 1.0f;
+    float world_w        = 0.0f;
+    float world_h        = 0.0f;
+    bool  paused         = false;
+    bool  use_bvh        = true;
+    bool  brute_compare  = false;   // layer 4: brute-force pairs and BVH verification
+    bool  query_vis      = false;   // layer 3: traversal steps for the selected shape
+    int   selected_shape = -1;
+};
+
+struct FrameStats {
+    int  broad_phase_pairs  = 0;
+    int  brute_force_pairs  = 0;
+    int  narrow_phase_tests = 0;
+    int  actual_collisions  = 0;
+    int  false_positives    = 0;
+    int  bvh_node_count     = 0;
+    bool bvh_mismatch       = false;
+};
+
+// Everything the renderer draws for one frame. The app keeps two: one being
+// drawn, one being simulated. Pair lists, collision sets and query steps
+// live in the frame's arena; shapes, AABBs and the BVH keep their capacity
+// from frame to frame.
+struct FrameData {
+    FrameArena          arena;
+    std::vector<Shape>  shapes;   // world state after this frame's step
+    std::vector<AABB>   aabbs;
+    BVH                 bvh;
+    PairList            broad_pairs{&arena};
+    PairList            brute_pairs{&arena};
+    PairSet             collision_set{&arena};
+    PairSet             false_positive_set{&arena};
+    StepList            query_steps{&arena};
+    FrameStats          stats;
+
+    // Drops the last frame's arena buffers and rewinds the arena
+    void begin_frame();
+};
+
+// One frame of simulation as a task graph on the shared job system:
+//
+//   integrate --> snapshot
+//       |
+//     aabbs --> bvh --> pairs --> narrow
+//       |        |        |
+//       |        |        +--> verify
+//       |        +--> query      ^
+//       +--> brute --------------+
+//
+// Brute force and verification run beside the BVH, pairs and narrow phase;
+// query steps run beside pairs. start() runs the graph in the background so
+// the next frame simulates while the main thread draws this one.
+class FrameGraph {
+public:
+    explicit FrameGraph(PhysicsWorld& world);
+
+    // Simulates one frame into out and blocks until done
+    void run(const FrameInput& in, FrameData& out);
+
+    // Starts run() on the job system and returns. Until finish(), the world
+    // and out belong to the simulation.
+    void start(const FrameInput& in, FrameData& out);
+    void finish();
+
+    // Timings and critical path of the last frame
+    const TaskGraph& graph() const { return graph_; }
+
+private:
+    struct AsyncJob : Job {
+        FrameGraph* owner = nullptr;
+    };
+
+    PhysicsWorld&    world_;
+    FrameInput       in_;
+    FrameData*       out_ = nullptr;
+    TaskGraph        graph_;
+    AsyncJob         async_;
+    std::atomic<int> pending_{0};
+    bool             running_ = false;
+};
@@ -5,6 +5,10 @@
 #include "shape.h"
 #include "bvh.h"
 #include "physics.h"
+#include "frame_graph.h"
+#include "perf_counters.h"
+#include "alloc_hooks.h"
+#include "alloc_tracking.h"
 #include "ui.h"
 #include "renderer.h"
 #include <cstdlib>
@@ -12,7 +16,6 @@
 #include <cstring>
 #include <ctime>
 #include <vector>
-#include <set>
 #include <algorithm>
 
 constexpr int   kInitialWidth  = 1400;
@@ -21,7 +24,6 @@ constexpr float kMaxFrameDt    = 0.1f;
 
 struct AppState {
     PhysicsWorld world;
-    BVH          bvh;
     Renderer     renderer;
     UIState      ui;
 
@@ -31,17 +33,21 @@ struct AppState {
     // Slider backing values (float for smooth dragging)
     float slider_count_val = 30.0f;
 
-    // Computed per frame
-    std::vector<AABB>              aabbs;
-    std::vector<std::pair<int,int>> broad_pairs;
-    std::vector<std::pair<int,int>> brute_pairs;
-    std::set<std::pair<int,int>>    collision_set;
-    std::set<std::pair<int,int>>    false_positive_set;
-    std::vector<TraversalStep>      query_steps;
+    // Computed per frame: frames[shown] is drawn while the next frame
+    // simulates into the other one
+    FrameGraph sim{world};
+    FrameData  frames[2];
+    int        shown = 0;
+
+    const FrameData& front() const { return frames[shown]; }
+
+    // Heap allocations per frame (PHYSICS_ALLOC_TRACKING builds)
+    AllocFrameStats allocs;
 
     // FPS tracking
     float fps_timer = 0.0f;
     int   fps_frames = 0;
+    float render_ms = 0.0f;
 };
 
 // --- Slider hit testing ---
@@ -95,6 +101,10 @@ static void key_callback(GLFWwindow* window, int key, int /*scancode*/,
         ui.use_bvh = !ui.use_bvh;
         break;
 
+    case GLFW_KEY_P:
+        ui.show_profile = !ui.show_profile;
+        break;
+
     case GLFW_KEY_SPACE:
         ui.paused = !ui.paused;
         if (!ui.paused) {
@@ -107,13 +117,14 @@ static void key_callback(GLFWwindow* window, int key, int /*scancode*/,
         if (ui.paused) {
             if (ui.build_anim_active) {
                 ui.build_anim_step++;
-                if (ui.build_anim_step >= app->bvh.nodes().size())
+                if (ui.build_anim_step >= app->front().bvh.nodes().size())
                     ui.build_anim_active = false;
-            } else if (ui.selected_shape >= 0 && !app->query_steps.empty()) {
+            } else if (ui.selected_shape >= 0 && !app->front().query_steps.empty()) {
+                int steps = static_cast<int>(app->front().query_steps.size());
                 ui.step_mode = true;
                 ui.step_index++;
-                if (ui.step_index >= (int)app->query_steps.size())
-                    ui.step_index = (int)app->query_steps.size() - 1;
+                if (ui.step_index >= steps)
+                    ui.step_index = steps - 1;
             }
         }
         break;
@@ -290,6 +301,21 @@ int main() {
         prev_time = now;
         if (frame_dt > kMaxFrameDt) frame_dt = kMaxFrameDt;
 
+        // The frame simulated during the last render is the one to draw now
+        app.sim.finish();
+        app.shown ^= 1;
+        app.allocs.end_frame();
+        const FrameStats& stats = app.front().stats;
+        app.ui.bvh_node_count     = stats.bvh_node_count;
+        app.ui.broad_phase_pairs  = stats.broad_phase_pairs;
+        app.ui.brute_force_pairs  = stats.brute_force_pairs;
+        app.ui.bvh_mismatch       = stats.bvh_mismatch;
+        app.ui.narrow_phase_tests = stats.narrow_phase_tests;
+        app.ui.actual_collisions  = stats.actual_collisions;
+        app.ui.false_positives    = stats.false_positives;
+        app.ui.sim_span_ms        = static_cast<float>(app.sim.graph().span_ms());
+        app.ui.sim_work_ms        = static_cast<float>(app.sim.graph().work_ms());
+
         // FPS
         app.fps_timer += frame_dt;
         app.fps_frames++;
@@ -297,107 +323,74 @@ int main() {
             app.ui.fps = app.fps_frames / app.fps_timer;
             app.fps_timer = 0.0f;
             app.fps_frames = 0;
+            if (app.ui.show_profile) {
+                std::printf("sim ");
+                app.sim.graph().print_profile(stdout);
+                std::printf("render %.3f ms (overlaps the next sim)\n", app.render_ms);
+#if defined(PHYSICS_PERF_COUNTERS) || defined(PHYSICS_ALLOC_TRACKING)
+                PerfReport::instance().print(stdout);
+                PerfReport::instance().reset();
+#endif
+#if defined(PHYSICS_ALLOC_TRACKING)
+                app.allocs.print(stdout);
+#endif
+            }
         }
 
+        // Input only touches the world while no simulation is running
+        glfwPollEvents();
+
         float ww = static_cast<float>(app.win_width);
         float wh = static_cast<float>(app.win_height);
 
         // Ensure shape count matches slider
         app.world.ensure_count(app.ui.target_count, ww, wh);
 
-        // Physics update
-        if (!app.ui.paused) {
-            app.world.update(frame_dt, app.ui.speed_mult, ww, wh);
-        }
-
-        // Compute AABBs
-        int n = static_cast<int>(app.world.shapes.size());
-        app.aabbs.resize(n);
-        for (int i = 0; i < n; ++i)
-            app.aabbs[i] = app.world.shapes[i].compute_aabb();
-
-        // Build BVH
-        app.bvh.build(app.aabbs);
-        app.ui.bvh_node_count = static_cast<int>(app.bvh.nodes().size());
-
-        // Broad phase
-        if (app.ui.use_bvh) {
-            app.broad_pairs = app.bvh.find_all_pairs();
-        } else {
-            app.broad_pairs = brute_force_pairs(app.aabbs);
-        }
-        app.ui.broad_phase_pairs = static_cast<int>(app.broad_pairs.size());
-
-        // Brute force (for comparison layer + BVH verification)
-        if (app.ui.show_brute_compare) {
-            app.brute_pairs = brute_force_pairs(app.aabbs);
-            app.ui.brute_force_pairs = static_cast<int>(app.brute_pairs.size());
-
-            // Verify BVH produces same pair set as brute force
-            if (app.ui.use_bvh) {
-                auto bvh_sorted = app.broad_pairs;
-                auto bf_sorted = app.brute_pairs;
-                std::sort(bvh_sorted.begin(), bvh_sorted.end());
-                std::sort(bf_sorted.begin(), bf_sorted.end());
-                app.ui.bvh_mismatch = (bvh_sorted != bf_sorted);
-            } else {
-                app.ui.bvh_mismatch = false;
-            }
-        }
-
-        // Narrow phase
-        app.collision_set.clear();
-        app.false_positive_set.clear();
-        app.ui.actual_collisions = 0;
-        app.ui.false_positives = 0;
-        for (auto& [i, j] : app.broad_pairs) {
-            if (i < 0 || i >= n || j < 0 || j >= n) continue;
-            auto key = i < j ? std::pair(i,j) : std::pair(j,i);
-            if (shapes_intersect(app.world.shapes[i], app.world.shapes[j])) {
-                app.collision_set.insert(key);
-                app.ui.actual_collisions++;
-            } else {
-                app.false_positive_set.insert(key);
-                app.ui.false_positives++;
-            }
-        }
-        app.ui.narrow_phase_tests = static_cast<int>(app.broad_pairs.size());
-
-        // Query steps for selected shape
-        app.query_steps.clear();
-        if (app.ui.selected_shape >= 0 && app.ui.selected_shape < n && app.ui.show_query_vis) {
-            app.query_steps = app.bvh.query_with_steps(
-                app.aabbs[app.ui.selected_shape], app.ui.selected_shape);
-        }
-
         // Clamp selection if shapes were removed
+        int n = static_cast<int>(app.world.shapes.size());
         if (app.ui.selected_shape >= n) app.ui.selected_shape = -1;
         if (app.ui.hovered_shape >= n)  app.ui.hovered_shape = -1;
         if (app.ui.dragged_shape >= n)  app.ui.dragged_shape = -1;
 
-        // Render
+        // Simulate the next frame in the background
+        FrameInput in;
+        in.dt             = frame_dt;
+        in.speed_mult     = app.ui.speed_mult;
+        in.world_w        = ww;
+        in.world_h        = wh;
+        in.paused         = app.ui.paused;
+        in.use_bvh        = app.ui.use_bvh;
+        in.brute_compare  = app.ui.show_brute_compare;
+        in.query_vis      = app.ui.show_query_vis;
+        in.selected_shape = app.ui.selected_shape;
+        app.sim.start(in, app.frames[app.shown ^ 1]);
+
+        // Render this one meanwhile
+        double render_start = glfwGetTime();
         glClearColor(0.05f, 0.05f, 0.08f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
+        const FrameData& f = app.front();
         app.renderer.render_frame(
-            app.world.shapes,
-            app.aabbs,
-            app.bvh,
-            app.broad_pairs,
-            app.brute_pairs,
-            app.collision_set,
-            app.false_positive_set,
-            app.query_steps,
+            f.shapes,
+            f.aabbs,
+            f.bvh,
+            f.broad_pairs,
+            f.brute_pairs,
+            f.collision_set,
+            f.false_positive_set,
+            f.query_steps,
             app.ui,
             app.slider_count_val,
             app.win_width,
             app.win_height
         );
+        app.render_ms = static_cast<float>((glfwGetTime() - render_start) * 1000.0);
 
         glfwSwapBuffers(window);
-        glfwPollEvents();
     }
 
+    app.sim.finish();
     app.renderer.cleanup();
     glfwDestroyWindow(window);
     glfwTerminate();
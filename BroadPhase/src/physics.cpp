@@ -1,4 +1,5 @@
 #include "physics.h"
+#include "job_system.h"
 #include <cstdlib>
 #include <cmath>
 
@@ -6,7 +7,9 @@ void PhysicsWorld::update(float dt, float speed_mult, float world_w, float world
     float eff_dt = dt * speed_mult;
     float margin = 5.0f;
 
-    for (auto& s : shapes) {
+    // Shapes move independently; a few hundred per chunk is worth a handoff
+    parallel_for(0, static_cast<int>(shapes.size()), 256, [&](int i) {
+        Shape& s = shapes[i];
         s.pos += s.vel * eff_dt;
         s.rotation += 0.5f * eff_dt;
 
@@ -27,7 +30,7 @@ void PhysicsWorld::update(float dt, float speed_mult, float world_w, float world
         // Update world verts after position change
         if (s.type != ShapeType::Circle)
             s.update_world_verts();
-    }
+    });
 }
 
 void PhysicsWorld::spawn_shape(float x, float y) {
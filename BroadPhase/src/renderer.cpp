@@ -324,13 +324,13 @@ void Renderer::draw_shape_outline(const Shape& s, float r, float g, float b, flo
 // --- High-level rendering ---
 
 void Renderer::render_pair_lines(const std::vector<Shape>& shapes,
-                                  const std::vector<std::pair<int,int>>& pairs,
+                                  const PairList& pairs,
                                   float r, float g, float b, float a,
                                   int win_w, int win_h) {
     if (pairs.empty()) return;
     // Draw in batches to not exceed VBO
-    std::vector<Vec2> pts;
-    pts.reserve(pairs.size() * 2);
+    std::pmr::vector<Vec2> pts(&arena_);
+    pts.reserve(std::min(pairs.size() * 2, kMaxGeoVerts));
     for (auto& [i, j] : pairs) {
         if (i < 0 || i >= (int)shapes.size() || j < 0 || j >= (int)shapes.size()) continue;
         pts.push_back(shapes[i].pos);
@@ -358,10 +358,10 @@ void Renderer::render_bvh_boxes(const BVH& bvh, const UIState& ui, int win_w, in
 }
 
 void Renderer::render_aabb_overlays(const std::vector<AABB>& aabbs,
-                                     const std::vector<std::pair<int,int>>& broad_pairs,
+                                     const PairList& broad_pairs,
                                      int win_w, int win_h) {
     // Collect indices that are in an overlapping pair
-    std::set<int> overlapping;
+    std::pmr::set<int> overlapping(&arena_);
     for (auto& [i, j] : broad_pairs) {
         overlapping.insert(i);
         overlapping.insert(j);
@@ -379,7 +379,7 @@ void Renderer::render_aabb_overlays(const std::vector<AABB>& aabbs,
 }
 
 void Renderer::render_query_vis(const BVH& bvh,
-                                 const std::vector<TraversalStep>& steps,
+                                 const StepList& steps,
                                  const UIState& ui,
                                  int win_w, int win_h) {
     auto& nodes = bvh.nodes();
@@ -456,13 +456,13 @@ void Renderer::render_tree_diagram(const BVH& bvh, const UIState& ui, int win_w,
 
     // BFS to assign positions
     struct NodePos { int idx; float x, y; };
-    std::vector<NodePos> positions;
+    std::pmr::vector<NodePos> positions(&arena_);
     positions.reserve(nodes.size());
 
     // Simple recursive layout
     struct LayoutHelper {
         const std::vector<BVHNode>& nodes;
-        std::vector<NodePos>& positions;
+        std::pmr::vector<NodePos>& positions;
         float panel_x, panel_w, panel_y_top, panel_h;
         int max_depth;
         int limit;
@@ -571,7 +571,8 @@ void Renderer::render_stats(const UIState& ui, int win_w, int win_h) {
     float s = kTextScale * 0.8f;
 
     // Background
-    AABB bg = {{x - 10, (float)win_h - y - 10 * line_h - 5},
+    int  lines = ui.show_profile ? 12 : 10;
+    AABB bg = {{x - 10, (float)win_h - y - lines * line_h - 5},
                {(float)win_w - 5.0f, (float)win_h - y + 10}};
     draw_filled_rect(bg, 0.05f, 0.05f, 0.1f, 0.85f, win_w, win_h);
 
@@ -617,10 +618,19 @@ void Renderer::render_stats(const UIState& ui, int win_w, int win_h) {
         std::snprintf(buf, sizeof(buf), "False pos: %d", ui.false_positives);
         draw_text(buf, x, y, s, 0.9f, 0.9f, 0.3f, win_w, win_h); y += line_h;
     }
+
+    if (ui.show_profile) {
+        std::snprintf(buf, sizeof(buf), "Sim: %.2f ms", ui.sim_span_ms);
+        draw_text(buf, x, y, s, 0.6f, 0.8f, 0.9f, win_w, win_h); y += line_h;
+
+        float par = ui.sim_span_ms > 0.0f ? ui.sim_work_ms / ui.sim_span_ms : 0.0f;
+        std::snprintf(buf, sizeof(buf), "Task work: %.2f ms (%.1fx)", ui.sim_work_ms, par);
+        draw_text(buf, x, y, s, 0.6f, 0.8f, 0.9f, win_w, win_h); y += line_h;
+    }
 }
 
 void Renderer::render_controls_hint(int win_w, int win_h) {
-    const char* hint = "1-5: layers  B: mode  SPACE: pause  N: step  R: rebuild  +/-: speed  Right-click: spawn";
+    const char* hint = "1-5: layers  B: mode  P: profile  SPACE: pause  N: step  R: rebuild  +/-: speed  Right-click: spawn";
     float tw = stb_easy_font_width(const_cast<char*>(hint)) * kTextScale * 0.7f;
     draw_text(hint, win_w * 0.5f - tw * 0.5f, win_h - 20.0f, kTextScale * 0.7f,
               0.35f, 0.35f, 0.4f, win_w, win_h);
@@ -655,14 +665,16 @@ void Renderer::render_layer_toggles(const UIState& ui, int win_w, int win_h) {
 void Renderer::render_frame(const std::vector<Shape>& shapes,
                              const std::vector<AABB>& aabbs,
                              const BVH& bvh,
-                             const std::vector<std::pair<int,int>>& broad_pairs,
-                             const std::vector<std::pair<int,int>>& brute_pairs,
-                             const std::set<std::pair<int,int>>& collision_set,
-                             const std::set<std::pair<int,int>>& false_positive_set,
-                             const std::vector<TraversalStep>& query_steps,
+                             const PairList& broad_pairs,
+                             const PairList& brute_pairs,
+                             const PairSet& collision_set,
+                             const PairSet& false_positive_set,
+                             const StepList& query_steps,
                              const UIState& ui,
                              float slider_count_val,
                              int win_w, int win_h) {
+    arena_.reset();
+
     // 1. Pair comparison lines (layer 4)
     if (ui.show_brute_compare) {
         render_pair_lines(shapes, brute_pairs, 0.3f, 0.3f, 0.3f, 0.15f, win_w, win_h);
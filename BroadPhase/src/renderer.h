@@ -4,6 +4,7 @@
 #include "shape.h"
 #include "bvh.h"
 #include "ui.h"
+#include "frame_arena.h"
 #include <glad/gl.h>
 #include <cstddef>
 #include <span>
@@ -46,11 +47,11 @@ public:
     void render_frame(const std::vector<Shape>& shapes,
                       const std::vector<AABB>& aabbs,
                       const BVH& bvh,
-                      const std::vector<std::pair<int,int>>& broad_pairs,
-                      const std::vector<std::pair<int,int>>& brute_pairs,
-                      const std::set<std::pair<int,int>>& collision_set,
-                      const std::set<std::pair<int,int>>& false_positive_set,
-                      const std::vector<TraversalStep>& query_steps,
+                      const PairList& broad_pairs,
+                      const PairList& brute_pairs,
+                      const PairSet& collision_set,
+                      const PairSet& false_positive_set,
+                      const StepList& query_steps,
                       const UIState& ui,
                       float slider_count_val,
                       int win_w, int win_h);
@@ -75,21 +76,24 @@ private:
     static constexpr std::size_t kMaxGeoVerts   = 8192;
     static constexpr std::size_t kMaxTextQuads   = 4096;
 
+    // Scratch for one render_frame (line batches, tree layout), rewound at its start
+    FrameArena arena_;
+
     // Helpers
     void draw_shape_fill(const Shape& s, float r, float g, float b, float a, int win_w, int win_h);
     void draw_shape_outline(const Shape& s, float r, float g, float b, float a, int win_w, int win_h);
 
     void render_pair_lines(const std::vector<Shape>& shapes,
-                           const std::vector<std::pair<int,int>>& pairs,
+                           const PairList& pairs,
                            float r, float g, float b, float a,
                            int win_w, int win_h);
 
     void render_bvh_boxes(const BVH& bvh, const UIState& ui, int win_w, int win_h);
     void render_aabb_overlays(const std::vector<AABB>& aabbs,
-                              const std::vector<std::pair<int,int>>& broad_pairs,
+                              const PairList& broad_pairs,
                               int win_w, int win_h);
     void render_query_vis(const BVH& bvh,
-                          const std::vector<TraversalStep>& steps,
+                          const StepList& steps,
                           const UIState& ui,
                           int win_w, int win_h);
     void render_tree_diagram(const BVH& bvh, const UIState& ui, int win_w, int win_h);
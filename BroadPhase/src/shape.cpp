@@ -1,4 +1,5 @@
 #include "shape.h"
+#include "fast_math.h"
 #include <cmath>
 #include <cstdlib>
 #include <algorithm>
@@ -10,8 +11,8 @@ static float randf(float lo, float hi) { return lo + randf() * (hi - lo); }
 // --- Shape methods ---
 
 void Shape::update_world_verts() {
-    float c = std::cos(rotation);
-    float s = std::sin(rotation);
+    float s, c;
+    fast_sincos(rotation, s, c);
     world_verts.resize(local_verts.size());
     for (size_t i = 0; i < local_verts.size(); ++i) {
         Vec2 v = local_verts[i];
@@ -138,15 +139,10 @@ static bool overlap_on_axis(float lo1, float hi1, float lo2, float hi2) {
     return lo1 <= hi2 && lo2 <= hi1;
 }
 
-// Get edge normals for polygon
-static std::vector<Vec2> get_axes(const std::vector<Vec2>& verts) {
-    std::vector<Vec2> axes;
-    int n = static_cast<int>(verts.size());
-    for (int i = 0; i < n; ++i) {
-        Vec2 edge = verts[(i + 1) % n] - verts[i];
-        axes.push_back(edge.perp().normalized());
-    }
-    return axes;
+// Normal of polygon edge i (computed per test, so SAT allocates nothing)
+static Vec2 edge_axis(const std::vector<Vec2>& verts, std::size_t i) {
+    Vec2 edge = verts[(i + 1) % verts.size()] - verts[i];
+    return edge.perp().normalized();
 }
 
 // Circle vs Circle
@@ -158,16 +154,15 @@ static bool circle_vs_circle(const Shape& a, const Shape& b) {
 
 // Polygon vs Polygon (SAT)
 static bool polygon_vs_polygon(const std::vector<Vec2>& va, const std::vector<Vec2>& vb) {
-    auto axes_a = get_axes(va);
-    auto axes_b = get_axes(vb);
-
-    for (auto& axis : axes_a) {
+    for (std::size_t i = 0; i < va.size(); ++i) {
+        Vec2 axis = edge_axis(va, i);
         float lo1, hi1, lo2, hi2;
         project_polygon(va, axis, lo1, hi1);
         project_polygon(vb, axis, lo2, hi2);
         if (!overlap_on_axis(lo1, hi1, lo2, hi2)) return false;
     }
-    for (auto& axis : axes_b) {
+    for (std::size_t i = 0; i < vb.size(); ++i) {
+        Vec2 axis = edge_axis(vb, i);
         float lo1, hi1, lo2, hi2;
         project_polygon(va, axis, lo1, hi1);
         project_polygon(vb, axis, lo2, hi2);
@@ -196,8 +191,8 @@ static bool circle_vs_polygon(const Shape& circle, const std::vector<Vec2>& vert
     }
 
     // Test polygon edge normals
-    auto axes = get_axes(verts);
-    for (auto& ax : axes) {
+    for (std::size_t i = 0; i < verts.size(); ++i) {
+        Vec2 ax = edge_axis(verts, i);
         float lo1, hi1, lo2, hi2;
         project_circle(circle.pos, circle.radius, ax, lo1, hi1);
         project_polygon(verts, ax, lo2, hi2);
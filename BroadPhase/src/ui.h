@@ -11,6 +11,7 @@ struct UIState {
     // Mode
     bool use_bvh              = true;
     bool paused               = false;
+    bool show_profile         = false;  // P: frame timings and critical path
     bool step_mode            = false;  // When paused with selection, step through BVH
 
     // Sliders
@@ -40,6 +41,8 @@ struct UIState {
     int   bvh_node_count      = 0;
     float fps                 = 0.0f;
     bool  bvh_mismatch        = false;
+    float sim_span_ms         = 0.0f;   // Last frame's task graph: wall time
+    float sim_work_ms         = 0.0f;   // and summed task time
 };
 
 struct Slider {
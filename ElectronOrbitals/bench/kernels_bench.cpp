@@ -0,0 +1,46 @@
+// Kernel microbenchmarks for the radial wave function (bench.h):
+//
+//   laguerre_recurrence_4s  L^1_3(rho) by the generic three-term recurrence
+//   laguerre_recurrence_7s  L^1_6(rho), the catalog's longest recurrence
+//   laguerre_horner_4s      Orbital<4,0,0>::radial_poly, the specialized
+//                           kernels' constant Horner expansion of the same polynomial
+
+#include "wavefunction.h"
+#include "orbital_kernels.h"
+#include "bench.h"
+#include <vector>
+
+constexpr int   kCount  = 4096;
+constexpr float kRhoMax = 40.0f;   // beyond the 99% radius of every n <= 7 orbital
+
+static std::vector<float> rho_samples() {
+    std::vector<float> rho(kCount);
+    for (int i = 0; i < kCount; ++i) rho[i] = kRhoMax * (static_cast<float>(i) + 0.5f) / kCount;
+    return rho;
+}
+
+static void run_recurrence(BenchState& state, int n) {
+    PsiRecurrence rc = make_psi_recurrence(n, 0, 0, 1.0f, 1.0f);
+    std::vector<float> rho = rho_samples();
+    std::vector<float> out(kCount);
+    state.set_items(kCount);
+    while (state.keep_running()) {
+        for (int i = 0; i < kCount; ++i) out[i] = laguerre_recurrence(rc, rho[i]);
+        bench_keep(out[kCount / 2]);
+    }
+}
+
+BENCHMARK(laguerre_recurrence_4s) { run_recurrence(state, 4); }
+BENCHMARK(laguerre_recurrence_7s) { run_recurrence(state, 7); }
+
+BENCHMARK(laguerre_horner_4s) {
+    std::vector<float> rho = rho_samples();
+    std::vector<float> out(kCount);
+    state.set_items(kCount);
+    while (state.keep_running()) {
+        for (int i = 0; i < kCount; ++i) out[i] = Orbital<4, 0, 0>::radial_poly(rho[i]);
+        bench_keep(out[kCount / 2]);
+    }
+}
+
+BENCHMARK_MAIN()
@@ -0,0 +1,425 @@
+#include "cpu_renderer.h"
+#include "wavefunction.h"
+#include "parallel.h"
+#include "fast_math.h"
+#include "perf_counters.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+// Ray-sphere intersection: returns false on miss
+static bool intersect_sphere(vec3 ro, vec3 rd, float radius, float& t_near, float& t_far) {
+    float b = dot(ro, rd);
+    float c = dot(ro, ro) - radius * radius;
+    float disc = b * b - c;
+    if (disc < 0.0f) return false;
+    float sq = std::sqrt(disc);
+    t_near = -b - sq;
+    t_far  = -b + sq;
+    return true;
+}
+
+// Squared distance to the origin of the lattice sample closest to it;
+// |ro + rd t|^2 is a parabola in t, so that is the sample nearest t*.
+static float lattice_min_dist_sq(vec3 ro, vec3 rd, float t_near, float step, int steps,
+                                 float jitter) {
+    float t_star = -dot(ro, rd);
+    float i = std::round((t_star - t_near) / step - jitter);
+    i = std::clamp(i, 0.0f, static_cast<float>(steps - 1));
+    vec3 pos = ro + rd * (t_near + (i + jitter) * step);
+    return dot(pos, pos);
+}
+
+// Same ray as get_ray() in the shader for pixel (px, py); image rows run
+// top-down
+static void pixel_ray(const RaymarchUniforms& u, int px, int py, float inv_w, float inv_h,
+                      vec3& ro, vec3& rd) {
+    float ndc_x = (static_cast<float>(px) + 0.5f) * inv_w * 2.0f - 1.0f;
+    float ndc_y = 1.0f - (static_cast<float>(py) + 0.5f) * inv_h * 2.0f;
+    vec4 near_pt = u.inv_view_proj * vec4{ndc_x, ndc_y, -1.0f, 1.0f};
+    vec4 far_pt  = u.inv_view_proj * vec4{ndc_x, ndc_y,  1.0f, 1.0f};
+    vec3 near_p = vec3{near_pt.x, near_pt.y, near_pt.z} / near_pt.w;
+    vec3 far_p  = vec3{far_pt.x, far_pt.y, far_pt.z} / far_pt.w;
+    ro = u.camera_pos;
+    rd = normalize(far_p - near_p);
+}
+
+void CpuRenderer::resize(int width, int height) {
+    if (width == hdr_.width && height == hdr_.height) return;
+    hdr_.resize(width, height);
+    accumulator_.reset();
+}
+
+void CpuRenderer::set_psi_volume(const PsiVolume* vol) {
+    if (vol != volume_) accumulator_.reset();
+    volume_ = vol;
+}
+
+void CpuRenderer::set_orbital_lut(const OrbitalLut* lut) {
+    if (lut != lut_) accumulator_.reset();
+    lut_ = lut;
+}
+
+void CpuRenderer::set_superposition(const Superposition* s) {
+    if (s != superposition_) {
+        accumulator_.reset();
+        combined_.version = -1;
+    }
+    superposition_ = s;
+}
+
+void CpuRenderer::set_occupancy(const OccupancyGrid* grid) {
+    if (grid != occupancy_) accumulator_.reset();
+    occupancy_ = grid;
+}
+
+void CpuRenderer::set_adaptive(bool on) {
+    if (on != adaptive_) accumulator_.reset();
+    adaptive_ = on;
+}
+
+void CpuRenderer::set_progressive(bool on) {
+    if (on != progressive_) accumulator_.reset();
+    progressive_ = on;
+}
+
+void CpuRenderer::set_render_scale(float scale) {
+    scale = std::clamp(scale, kMinRenderScale, 1.0f);
+    if (scale != scale_) accumulator_.reset();
+    scale_ = scale;
+}
+
+void CpuRenderer::draw_raymarch(const RaymarchUniforms& u) {
+    auto t0 = std::chrono::steady_clock::now();
+
+    // Below full scale the march goes to its own smaller image and leaves
+    // the nucleus to the upsample
+    const bool scaled = scale_ < 1.0f;
+    HdrImage& target = scaled ? scaled_ : hdr_;
+    if (scaled) {
+        int w = scaled_size(hdr_.width, scale_);
+        int h = scaled_size(hdr_.height, scale_);
+        if (w != scaled_.width || h != scaled_.height) {
+            scaled_.resize(w, h);
+            transmittance_.assign(static_cast<std::size_t>(w) * h, 1.0f);
+            accumulator_.reset();
+        }
+    }
+
+    // The superposition's density moves with time, so a new time is a new
+    // image for the progressive history too
+    if (superposition_ &&
+        (combined_.version != superposition_->version() || combined_.time != u.time)) {
+        superposition_->combine(u.time, combined_);
+        accumulator_.reset();
+    }
+
+    RaymarchUniforms f = progressive_ ? accumulator_.begin_frame(u) : u;
+    f.defer_nucleus = scaled;
+    march(f, target);
+
+    if (progressive_) {
+        // Blend into the history; target then holds the refined image
+        // Checked separately: a resize plus a scale change can bring the
+        // scaled image to the history's size without any transmittance yet
+        if (history_.width != target.width || history_.height != target.height)
+            history_.resize(target.width, target.height);
+        if (history_transmittance_.size() != transmittance_.size())
+            history_transmittance_.assign(transmittance_.size(), 1.0f);
+        const float w = accumulator_.weight();
+        auto blend = [w](float& hist, float& cur) {
+            hist = (w >= 1.0f) ? cur : hist + (cur - hist) * w;
+            cur  = hist;
+        };
+        parallel_for(target.height, [&](int y) {
+            float* cur  = target.row(y);
+            float* hist = history_.row(y);
+            for (int i = 0; i < target.width * 3; ++i) blend(hist[i], cur[i]);
+            if (scaled) {
+                std::size_t row = static_cast<std::size_t>(y) * target.width;
+                for (int x = 0; x < target.width; ++x)
+                    blend(history_transmittance_[row + x], transmittance_[row + x]);
+            }
+        });
+    }
+
+    if (scaled) upsample(f);
+    last_ms_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// exp(-x) below which the nucleus glow is dropped (about 1e-13)
+constexpr float kGlowCutoff = 30.0f;
+
+// Same taps and weights as kUpsampleFS
+void CpuRenderer::upsample(const RaymarchUniforms& u) {
+    const HdrImage& src = scaled_;
+    const float sx = static_cast<float>(src.width)  / static_cast<float>(hdr_.width);
+    const float sy = static_cast<float>(src.height) / static_cast<float>(hdr_.height);
+    const float inv_w = 1.0f / static_cast<float>(hdr_.width);
+    const float inv_h = 1.0f / static_cast<float>(hdr_.height);
+    const OccupancyGrid* occupancy = active_occupancy();
+    const bool  exact_nucleus = u.long_steps || (occupancy && adaptive_);
+
+    parallel_for(hdr_.height, [&](int y) {
+        float py = (static_cast<float>(y) + 0.5f) * sy - 0.5f;
+        int   y0 = static_cast<int>(std::floor(py));
+        float fy = py - static_cast<float>(y0);
+        int   rows[2] = {std::clamp(y0, 0, src.height - 1), std::clamp(y0 + 1, 0, src.height - 1)};
+        float* out = hdr_.row(y);
+
+        for (int x = 0; x < hdr_.width; ++x) {
+            float px = (static_cast<float>(x) + 0.5f) * sx - 0.5f;
+            int   x0 = static_cast<int>(std::floor(px));
+            float fx = px - static_cast<float>(x0);
+            int   cols[2] = {std::clamp(x0, 0, src.width - 1), std::clamp(x0 + 1, 0, src.width - 1)};
+
+            // 2x2 bilinear taps, weighted down where their transmittance
+            // differs from the nearest texel's
+            int   nearest = (fy >= 0.5f ? 2 : 0) + (fx >= 0.5f ? 1 : 0);
+            float weight[4] = {(1.0f - fx) * (1.0f - fy), fx * (1.0f - fy),
+                               (1.0f - fx) * fy,          fx * fy};
+            std::size_t texel[4];
+            float       t[4];
+            for (int k = 0; k < 4; ++k) {
+                texel[k] = static_cast<std::size_t>(rows[k >> 1]) * src.width + cols[k & 1];
+                t[k] = transmittance_[texel[k]];
+            }
+            if (t[0] != t[1] || t[0] != t[2] || t[0] != t[3]) {
+                for (int k = 0; k < 4; ++k) {
+                    float d = (t[k] - t[nearest]) * (1.0f / kUpsampleSigma);
+                    weight[k] *= fast_exp(-d * d);
+                }
+            }
+
+            vec3  color = {};
+            float transmittance = 0.0f, total = 0.0f;
+            for (int k = 0; k < 4; ++k) {
+                const float* c = src.pixels.data() + texel[k] * 3;
+                color += vec3{c[0], c[1], c[2]} * weight[k];
+                transmittance += t[k] * weight[k];
+                total += weight[k];
+            }
+            // The nearest tap always has bilinear weight >= 1/4 and range weight 1
+            float inv = 1.0f / total;
+            color = color * inv;
+            transmittance *= inv;
+
+            // Nucleus glow at full resolution, from the output pixel's own
+            // ray. No sample gets closer than the ray itself, so rays that
+            // pass far from the nucleus need no lattice.
+            vec3 ro, rd;
+            pixel_ray(u, x, y, inv_w, inv_h, ro, rd);
+            float b = dot(ro, rd);
+            float glow = 0.0f, t_hit_near, t_hit_far;
+            if ((dot(ro, ro) - b * b) * 500.0f < kGlowCutoff &&
+                intersect_sphere(ro, rd, u.bounding_radius, t_hit_near, t_hit_far) &&
+                t_hit_near >= 0.0f) {
+                float min_dist_sq;
+                if (exact_nucleus) {
+                    vec3 p = ro + rd * std::clamp(-b, t_hit_near, t_hit_far);
+                    min_dist_sq = dot(p, p);
+                } else {
+                    float step_size = (t_hit_far - t_hit_near) / static_cast<float>(u.max_steps);
+                    min_dist_sq = lattice_min_dist_sq(ro, rd, t_hit_near, step_size, u.max_steps,
+                                                      u.jitter);
+                }
+                glow = fast_exp(-min_dist_sq * 500.0f) * transmittance;
+            }
+            out[x * 3 + 0] = color.x + 1.0f * glow;
+            out[x * 3 + 1] = color.y + 0.9f * glow;
+            out[x * 3 + 2] = color.z + 0.7f * glow;
+        }
+    });
+}
+
+void CpuRenderer::march(const RaymarchUniforms& u, HdrImage& out) {
+    PERF_SCOPE("ray march", static_cast<double>(out.width) * out.height, PerfScope::kAllThreads);
+    last_kernel_ = kernel_ ? kernel_ : select_orbital_kernel(u.n, u.l, u.m, allow_simd_);
+    samples_.store(0, std::memory_order_relaxed);
+    if (recurrence_.n != u.n || recurrence_.l != u.l || recurrence_.m != u.m)
+        recurrence_ = make_psi_recurrence(u.n, u.l, u.m, u.radial_norm, u.angular_norm);
+
+    int tiles_x = (out.width  + kTileSize - 1) / kTileSize;
+    int tiles_y = (out.height + kTileSize - 1) / kTileSize;
+
+    parallel_for(tiles_x * tiles_y, [&](int tile) {
+        int x0 = (tile % tiles_x) * kTileSize;
+        int y0 = (tile / tiles_x) * kTileSize;
+        march_tile(u, out, x0, y0,
+                   std::min(x0 + kTileSize, out.width),
+                   std::min(y0 + kTileSize, out.height));
+    });
+}
+
+namespace {
+struct CellSpan {
+    float t_begin, t_end;
+    float weight;   // sample density along the ray; 0 = empty
+};
+}
+
+void CpuRenderer::march_tile(const RaymarchUniforms& u, HdrImage& image,
+                             int x0, int y0, int x1, int y1) {
+    std::uint64_t samples = 0;
+    const OccupancyGrid* occupancy = active_occupancy();
+    std::vector<CellSpan> cells;   // adaptive march scratch, reused per pixel
+    const float inv_w = 1.0f / static_cast<float>(image.width);
+    const float inv_h = 1.0f / static_cast<float>(image.height);
+
+    for (int py = y0; py < y1; ++py) {
+        float* out = image.row(py);
+        for (int px = x0; px < x1; ++px) {
+            vec3 ro, rd;
+            pixel_ray(u, px, py, inv_w, inv_h, ro, rd);
+
+            float* pixel = out + px * 3;
+            float* transmittance = u.defer_nucleus
+                ? &transmittance_[static_cast<std::size_t>(py) * image.width + px] : nullptr;
+            float t_hit_near, t_hit_far;
+            if (!intersect_sphere(ro, rd, u.bounding_radius, t_hit_near, t_hit_far) ||
+                t_hit_near < 0.0f) {
+                pixel[0] = pixel[1] = pixel[2] = 0.0f;
+                if (transmittance) *transmittance = 1.0f;
+                continue;
+            }
+
+            float t_near = std::max(t_hit_near, 0.0f);
+            float t_far  = t_hit_far;
+            float step_size = (t_far - t_near) / static_cast<float>(u.max_steps);
+
+            vec3  accum_color = {};
+            float accum_alpha = 0.0f;
+            float min_dist_sq = 1e10f;
+
+            PacketParams pp{u.n, u.l, u.m, u.radial_norm, u.angular_norm,
+                            u.density_scale, u.time * u.anim_speed, &recurrence_};
+            SamplePacket packet;
+            float lane_step[kPacketWidth];   // ray length each lane's sample stands for
+            bool  exact_alpha = u.long_steps;
+
+            // Evaluates packet.t and composites the first `lanes` samples
+            auto march_packet = [&](int lanes) {
+                if (superposition_)
+                    eval_packet_superposition(combined_, pp, ro, rd, packet);
+                else if (volume_)
+                    eval_packet_volume(*volume_, pp, ro, rd, packet);
+                else if (lut_)
+                    eval_packet_lut(*lut_, pp, ro, rd, packet);
+                else
+                    last_kernel_(pp, ro, rd, packet);
+
+                for (int k = 0; k < lanes; ++k) {
+                    if (accum_alpha > 0.99f) break;
+                    ++samples;
+
+                    // Track closest approach to origin for nucleus glow
+                    min_dist_sq = std::min(min_dist_sq, packet.dist_sq[k]);
+
+                    float density = packet.density[k];
+                    vec3  sample_color = color_palette(packet.psi[k], density);
+                    // Long adaptive and progressive steps need the exact
+                    // 1 - exp(-tau); the uniform lattice defaults to the linear form
+                    float tau = density * lane_step[k] * 0.5f;
+                    float sample_alpha = exact_alpha ? 1.0f - fast_exp(-tau)
+                                                     : std::clamp(tau, 0.0f, 1.0f);
+
+                    // Front-to-back compositing
+                    accum_color += sample_color * ((1.0f - accum_alpha) * sample_alpha);
+                    accum_alpha += (1.0f - accum_alpha) * sample_alpha;
+                }
+            };
+
+            // Samples i0 <= i < i1 of the uniform lattice t_near + (i + jitter) * step
+            auto march_range = [&](int i0, int i1) {
+                std::fill_n(lane_step, kPacketWidth, step_size);
+                for (int i = i0; i < i1 && accum_alpha <= 0.99f; i += kPacketWidth) {
+                    for (int k = 0; k < kPacketWidth; ++k)
+                        packet.t[k] = t_near + (static_cast<float>(i + k) + u.jitter) * step_size;
+                    march_packet(std::min(kPacketWidth, i1 - i));
+                }
+            };
+
+            if (occupancy && adaptive_) {
+                // Pass 1: the ray's cells and their sample weights
+                float threshold = occupancy_threshold(*occupancy, u.density_scale,
+                                                      kAdaptiveSkipOpacity);
+                float total = 0.0f;
+                exact_alpha = true;
+                cells.clear();
+                for_each_cell(*occupancy, ro, rd, t_near, t_far, [&](float ta, float tb, float d) {
+                    float weight = (d >= threshold) ? adaptive_weight(d, u.density_scale) : 0.0f;
+                    cells.push_back({ta, tb, weight});
+                    total += weight * (tb - ta);
+                    return true;
+                });
+
+                // Pass 2: max_steps samples evenly spaced in weighted length,
+                // so a sample in a cell stands for du / weight of the ray
+                float du = total / static_cast<float>(u.max_steps);
+                float u_next = u.jitter * du;
+                float u_cell = 0.0f;
+                int   lanes = 0, issued = 0;
+                for (const CellSpan& c : cells) {
+                    if (c.weight <= 0.0f) continue;
+                    float u_end = u_cell + c.weight * (c.t_end - c.t_begin);
+                    float inv_weight = 1.0f / c.weight;
+                    for (; u_next < u_end && issued < u.max_steps; u_next += du, ++issued) {
+                        packet.t[lanes] = c.t_begin + (u_next - u_cell) * inv_weight;
+                        lane_step[lanes] = du * inv_weight;
+                        if (++lanes == kPacketWidth) {
+                            march_packet(lanes);
+                            lanes = 0;
+                            if (accum_alpha > 0.99f) break;
+                        }
+                    }
+                    u_cell = u_end;
+                    if (accum_alpha > 0.99f) break;
+                }
+                if (lanes > 0 && accum_alpha <= 0.99f) {
+                    std::fill(packet.t + lanes, packet.t + kPacketWidth, packet.t[lanes - 1]);
+                    march_packet(lanes);
+                }
+            } else if (occupancy) {
+                // Same lattice, but only the samples that fall in occupied cells
+                float threshold = occupancy_threshold(*occupancy, u.density_scale);
+                float inv_step = 1.0f / step_size;
+                auto first_sample = [&](float t) {
+                    return std::clamp(static_cast<int>(std::ceil((t - t_near) * inv_step - u.jitter)),
+                                      0, u.max_steps);
+                };
+                for_each_occupied_span(*occupancy, threshold, ro, rd, t_near, t_far,
+                                       [&](float ta, float tb) {
+                    march_range(first_sample(ta), first_sample(tb));
+                    return accum_alpha <= 0.99f;
+                });
+                // Skipped samples may include the one nearest the nucleus
+                min_dist_sq = std::min(min_dist_sq, lattice_min_dist_sq(ro, rd, t_near, step_size,
+                                                                        u.max_steps, u.jitter));
+            } else {
+                march_range(0, u.max_steps);
+            }
+            if (u.long_steps || (occupancy && adaptive_)) {
+                // Long steps miss the nucleus, which is glow only, so use
+                // the exact closest approach
+                float t_star = std::clamp(-dot(ro, rd), t_near, t_far);
+                min_dist_sq = std::min(min_dist_sq, dot(ro + rd * t_star, ro + rd * t_star));
+            }
+
+            if (transmittance) {
+                pixel[0] = accum_color.x;
+                pixel[1] = accum_color.y;
+                pixel[2] = accum_color.z;
+                *transmittance = 1.0f - accum_alpha;
+                continue;
+            }
+
+            // Nucleus glow
+            float glow = fast_exp(-min_dist_sq * 500.0f) * (1.0f - accum_alpha);
+            pixel[0] = accum_color.x + 1.0f * glow;
+            pixel[1] = accum_color.y + 0.9f * glow;
+            pixel[2] = accum_color.z + 0.7f * glow;
+        }
+    }
+    samples_.fetch_add(samples, std::memory_order_relaxed);
+}
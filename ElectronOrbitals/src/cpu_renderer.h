@@ -0,0 +1,121 @@
+#pragma once
+#include "raymarch_params.h"
+#include "progressive.h"
+#include "dynamic_resolution.h"
+#include "hdr_image.h"
+#include "wavefunction_simd.h"
+#include "wavefunction.h"
+#include "psi_volume.h"
+#include "superposition.h"
+#include "orbital_lut.h"
+#include "occupancy_grid.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Tile-based, multi-threaded CPU port of the ray march pass. Produces the
+// same HDR image the GL renderer writes into its RGBA16F target, so it can
+// run on machines without a GPU and serve as a reference for the shader.
+class CpuRenderer {
+public:
+    static constexpr int kTileSize = 32;
+
+    void resize(int width, int height);
+    void draw_raymarch(const RaymarchUniforms& u);
+
+    const HdrImage& hdr() const { return hdr_; }
+
+    // March at scale x scale of the resize() size (clamped to
+    // [kMinRenderScale, 1]) and upsample into hdr(): the volume with a
+    // bilateral filter, the nucleus glow per output pixel (see
+    // dynamic_resolution.h). ResolutionScaler picks the scale from
+    // last_frame_ms().
+    void  set_render_scale(float scale);
+    float render_scale() const { return scale_; }
+
+    // Wall-clock time of the most recent draw_raymarch(), upsample included
+    float last_frame_ms() const { return last_ms_; }
+
+    // Samples are evaluated kPacketWidth at a time along each ray. By default
+    // each frame uses the kernel specialized for its orbital on the fastest
+    // ISA the CPU supports; set_kernel() pins one kernel for every orbital
+    // (eval_packet_scalar gives the straight port of the shader math), and
+    // nullptr restores the per-orbital choice.
+    void set_kernel(PacketKernel k) { kernel_ = k; }
+    void set_allow_simd(bool on) { allow_simd_ = on; }
+
+    // Kernel used by the most recent draw_raymarch()
+    PacketKernel kernel() const { return last_kernel_; }
+
+    // Read psi from a precomputed grid (trilinear) instead of evaluating
+    // the wave function; nullptr goes back to the analytic kernels. The
+    // volume must outlive the draws that use it.
+    void set_psi_volume(const PsiVolume* vol);
+    const PsiVolume* psi_volume() const { return volume_; }
+
+    // Read psi from separable radial / angular tables (see orbital_lut.h)
+    // instead of evaluating the wave function; a psi volume takes
+    // precedence. nullptr goes back to the analytic kernels. The tables
+    // must outlive the draws that use them.
+    void set_orbital_lut(const OrbitalLut* lut);
+
+    // Render a time-dependent superposition (built, see superposition.h)
+    // instead of the frame's orbital: each draw whose time (or basis
+    // version) differs from the last combines the basis grid per voxel at
+    // that time, and samples read
+    // the combined (Re, Im) grid. Takes precedence over set_psi_volume();
+    // the occupancy grid is ignored, since it bounds a single orbital.
+    // nullptr goes back to single orbitals. Must outlive the draws.
+    void set_superposition(const Superposition* s);
+
+    // Skip samples in cells the grid marks empty at the frame's density
+    // scale. Sample positions stay on the uniform lattice, so the image
+    // only loses opacity below kSkipOpacity per cell. nullptr disables.
+    void set_occupancy(const OccupancyGrid* grid);
+
+    // With an occupancy grid, spend the max_steps budget unevenly: each
+    // cell's max density bounds the opacity a sample there can add, and
+    // steps shrink where that bound is high (see adaptive_weight()).
+    // Samples leave the uniform lattice.
+    void set_adaptive(bool on);
+
+    // Progressive refinement (see progressive.h): each draw marches
+    // max_steps / kProgressiveStepDivisor samples at a jittered lattice
+    // offset, and hdr() is the blend of the frames since the view changed.
+    void set_progressive(bool on);
+    bool progressive() const { return progressive_; }
+    int  progressive_frames() const { return progressive_ ? accumulator_.frames() : 0; }
+
+    // Wave-function samples composited by the most recent draw_raymarch()
+    std::uint64_t samples() const { return samples_.load(std::memory_order_relaxed); }
+
+private:
+    HdrImage             hdr_;
+    HdrImage             scaled_;       // march target below full scale
+    HdrImage             history_;      // progressive blend so far
+    std::vector<float>   transmittance_;           // per scaled_ pixel
+    std::vector<float>   history_transmittance_;
+    float                scale_       = 1.0f;
+    float                last_ms_     = 0.0f;
+    PacketKernel         kernel_      = nullptr;
+    PacketKernel         last_kernel_ = nullptr;
+    bool                 allow_simd_  = true;
+    const PsiVolume*     volume_      = nullptr;
+    const OrbitalLut*    lut_         = nullptr;
+    const OccupancyGrid* occupancy_   = nullptr;
+    const Superposition* superposition_ = nullptr;
+    SuperpositionFrame   combined_;     // superposition_ at combined_.time
+    PsiRecurrence        recurrence_;   // tables for the last orbital drawn
+    bool                 adaptive_    = false;
+    bool                 progressive_ = false;
+    ProgressiveAccumulator accumulator_;
+
+    std::atomic<std::uint64_t> samples_{0};
+
+    // Occupancy grids bound one orbital's density, not a superposition's
+    const OccupancyGrid* active_occupancy() const { return superposition_ ? nullptr : occupancy_; }
+
+    void march(const RaymarchUniforms& u, HdrImage& out);
+    void upsample(const RaymarchUniforms& u);   // scaled_ -> hdr_
+    void march_tile(const RaymarchUniforms& u, HdrImage& image, int x0, int y0, int x1, int y1);
+};
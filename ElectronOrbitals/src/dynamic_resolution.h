@@ -0,0 +1,63 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+// Dynamic resolution for the ray march pass. The march renders at
+// scale x scale of the output size and is upsampled before bloom and
+// composite; ResolutionScaler picks the scale from measured march times
+// (GL timer queries in the app, wall clock on the CPU path).
+constexpr float kMinRenderScale  = 0.4f;
+constexpr float kRenderScaleStep = 0.05f;
+
+// Upsample of a scaled march. The nucleus glow is the only feature
+// sharper than a few pixels, and it follows from each ray's closest
+// approach, so the march leaves it out (RaymarchUniforms::defer_nucleus)
+// and the upsample adds it per output pixel. The volume color and
+// transmittance are smooth enough for 2x2 bilinear taps; the bilateral
+// range term weights each tap by how close its transmittance is to the
+// nearest texel's (falloff kUpsampleSigma), so opaque lobe silhouettes do
+// not bleed into the background. Mirrored by kUpsampleFS.
+constexpr float kUpsampleSigma = 0.25f;
+
+// Render size for a scale, at least one pixel
+inline int scaled_size(int full, float scale) {
+    return std::max(1, static_cast<int>(std::lround(static_cast<float>(full) * scale)));
+}
+
+class ResolutionScaler {
+public:
+    explicit ResolutionScaler(float target_ms) : target_ms_(target_ms) {}
+
+    void  set_target_ms(float ms) { target_ms_ = ms; }
+    float target_ms() const { return target_ms_; }
+    float scale() const { return scale_; }
+
+    void reset() {
+        scale_ = 1.0f;
+        full_ms_ = 0.0f;
+    }
+
+    // Feeds one march time and the scale it was measured at (timer queries
+    // arrive a few frames late) and returns the scale for the next frame.
+    // Time is taken to grow with the pixel count; the full-resolution
+    // estimate is smoothed, the scale drops at once when over budget and
+    // grows one step at a time with two steps of headroom, so it settles
+    // instead of oscillating.
+    float update(float ms, float measured_scale) {
+        float full = ms / (measured_scale * measured_scale);
+        full_ms_ = (full_ms_ > 0.0f) ? full_ms_ + (full - full_ms_) * 0.25f : full;
+
+        float want = std::sqrt(target_ms_ / std::max(full_ms_, 1e-3f));
+        want = std::floor(want / kRenderScaleStep) * kRenderScaleStep;
+        if (want < scale_)
+            scale_ = std::max(want, kMinRenderScale);
+        else if (want >= scale_ + 2.0f * kRenderScaleStep)
+            scale_ = std::min(scale_ + kRenderScaleStep, 1.0f);
+        return scale_;
+    }
+
+private:
+    float target_ms_;
+    float scale_   = 1.0f;
+    float full_ms_ = 0.0f;   // smoothed full-resolution march time; 0 = none yet
+};
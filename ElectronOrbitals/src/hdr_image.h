@@ -0,0 +1,88 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Linear RGB float image, row-major, top row first.
+struct HdrImage {
+    int width  = 0;
+    int height = 0;
+    std::vector<float> pixels;   // width * height * 3
+
+    void resize(int w, int h) {
+        width  = w;
+        height = h;
+        pixels.assign(static_cast<std::size_t>(w) * h * 3, 0.0f);
+    }
+
+    float*       row(int y)       { return pixels.data() + static_cast<std::size_t>(y) * width * 3; }
+    const float* row(int y) const { return pixels.data() + static_cast<std::size_t>(y) * width * 3; }
+};
+
+// Display-ready 8-bit RGB image (tone mapped, gamma encoded), top row first.
+struct LdrImage {
+    int width  = 0;
+    int height = 0;
+    std::vector<std::uint8_t> pixels;   // width * height * 3
+
+    void resize(int w, int h) {
+        width  = w;
+        height = h;
+        pixels.assign(static_cast<std::size_t>(w) * h * 3, 0);
+    }
+
+    std::uint8_t*       row(int y)       { return pixels.data() + static_cast<std::size_t>(y) * width * 3; }
+    const std::uint8_t* row(int y) const { return pixels.data() + static_cast<std::size_t>(y) * width * 3; }
+};
+
+struct ImageDiff {
+    double mean_abs = 0.0;
+    double max_abs  = 0.0;
+    double psnr     = 0.0;   // dB, against a peak of 1.0; infinite if identical
+};
+
+// Per-channel difference statistics between two images of equal size.
+inline ImageDiff compare_images(const HdrImage& a, const HdrImage& b) {
+    ImageDiff d;
+    if (a.width != b.width || a.height != b.height || a.pixels.empty()) {
+        d.max_abs = INFINITY;
+        d.mean_abs = INFINITY;
+        return d;
+    }
+    double sum_abs = 0.0, sum_sq = 0.0;
+    for (std::size_t i = 0; i < a.pixels.size(); ++i) {
+        double e = std::fabs(static_cast<double>(a.pixels[i]) - b.pixels[i]);
+        sum_abs += e;
+        sum_sq  += e * e;
+        if (e > d.max_abs) d.max_abs = e;
+    }
+    double n = static_cast<double>(a.pixels.size());
+    d.mean_abs = sum_abs / n;
+    double mse = sum_sq / n;
+    d.psnr = (mse > 0.0) ? 10.0 * std::log10(1.0 / mse) : INFINITY;
+    return d;
+}
+
+// The same statistics on 8-bit images, in units of full scale (255), so
+// the PSNR measures the difference as displayed.
+inline ImageDiff compare_images(const LdrImage& a, const LdrImage& b) {
+    ImageDiff d;
+    if (a.width != b.width || a.height != b.height || a.pixels.empty()) {
+        d.max_abs = INFINITY;
+        d.mean_abs = INFINITY;
+        return d;
+    }
+    double sum_abs = 0.0, sum_sq = 0.0;
+    for (std::size_t i = 0; i < a.pixels.size(); ++i) {
+        double e = std::fabs(static_cast<double>(a.pixels[i]) - b.pixels[i]) / 255.0;
+        sum_abs += e;
+        sum_sq  += e * e;
+        if (e > d.max_abs) d.max_abs = e;
+    }
+    double n = static_cast<double>(a.pixels.size());
+    d.mean_abs = sum_abs / n;
+    double mse = sum_sq / n;
+    d.psnr = (mse > 0.0) ? 10.0 * std::log10(1.0 / mse) : INFINITY;
+    return d;
+}
@@ -0,0 +1,1093 @@
+// Headless entry point: everything that runs without a window or GPU.
+//
+//   ElectronOrbitalsHeadless render [options]    CPU ray march one frame to disk
+//   ElectronOrbitalsHeadless frames [options]    orbit camera path over orbitals to numbered images
+//   ElectronOrbitalsHeadless points [options]    sample |psi|^2 to a point cloud file
+//   ElectronOrbitalsHeadless mesh [options]      +/-iso surfaces of a psi volume to a .ply mesh
+//   ElectronOrbitalsHeadless glsl --orbital X    generated shader code for one orbital
+//   ElectronOrbitalsHeadless stats [options]     norm, <r>, <r^2>, nodes, 99% radius by cubature
+//   ElectronOrbitalsHeadless golden [options]    image regression + timing against a stored baseline
+
+#include "vec3.h"
+#include "mat4.h"
+#include "camera.h"
+#include "orbital.h"
+#include "cpu_renderer.h"
+#include "image_io.h"
+#include "orbital_kernels.h"
+#include "point_cloud.h"
+#include "iso_mesh.h"
+#include "superposition.h"
+#include "orbital_lut.h"
+#include "orbital_stats.h"
+#include "post_process.h"
+#include "bounded_queue.h"
+#include "job_system.h"
+#include "alloc_hooks.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+// --- Argument helpers --------------------------------------------------------
+
+struct ArgCursor {
+    int    argc;
+    char** argv;
+    int    i;
+
+    bool done() const { return i >= argc; }
+    const char* peek() const { return argv[i]; }
+
+    // Value following a flag; prints an error and returns nullptr if missing
+    const char* value(const char* flag) {
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "Missing value for %s\n", flag);
+            return nullptr;
+        }
+        i += 2;
+        return argv[i - 1];
+    }
+};
+
+// --- Shared frame setup ------------------------------------------------------
+
+struct ViewOptions {
+    const char* orbital   = "1s";
+    int         width     = 1920;
+    int         height    = 1080;
+    int         max_steps = 128;
+    float       density   = 1.0f;
+    float       azimuth   = 30.0f;
+    float       elevation = 20.0f;
+    float       distance  = -1.0f;   // < 0: bounding_radius * 2.5, like the app
+    float       time      = 0.0f;
+    bool        scalar    = false;   // no SIMD kernels
+    bool        generic   = false;   // runtime-branching kernel instead of Orbital<n,l,m>
+    int         volume    = 0;       // > 0: sample a precomputed psi grid of this resolution
+    bool        lut       = false;   // separable radial / angular tables
+    const char* cache_dir = "orbital_cache";
+    int         skip      = 0;       // > 0: empty-space skipping with a grid of this resolution
+    bool        adaptive  = false;   // bound-driven step sizes (needs a grid; 32^3 if no --skip)
+    float       scale     = 1.0f;    // ray march resolution relative to --size
+    const char* superpose = nullptr; // "1s,2p_z:1:90": superposition instead of --orbital
+};
+
+constexpr int kSuperpositionGrid = 128;   // basis grid for --superpose without --volume
+
+// Parses one view flag at the cursor. Returns 1 if consumed, 0 if the flag
+// is not a view flag, -1 on a malformed value.
+static int parse_view_flag(ArgCursor& args, ViewOptions& v) {
+    const char* flag = args.peek();
+    const char* val = nullptr;
+    if (std::strcmp(flag, "--orbital") == 0) {
+        if (!(val = args.value(flag))) return -1;
+        v.orbital = val;
+    } else if (std::strcmp(flag, "--size") == 0) {
+        if (!(val = args.value(flag))) return -1;
+        if (std::sscanf(val, "%dx%d", &v.width, &v.height) != 2 || v.width < 1 || v.height < 1) {
+            std::fprintf(stderr, "Bad --size '%s' (expected WxH)\n", val);
+            return -1;
+        }
+    } else if (std::strcmp(flag, "--steps") == 0) {
+        if (!(val = args.value(flag))) return -1;
+        v.max_steps = std::atoi(val);
+    } else if (std::strcmp(flag, "--density") == 0) {
+        if (!(val = args.value(flag))) return -1;
+        v.density = static_cast<float>(std::atof(val));
+    } else if (std::strcmp(flag, "--azimuth") == 0) {
+        if (!(val = args.value(flag))) return -1;
+        v.azimuth = static_cast<float>(std::atof(val));
+    } else if (std::strcmp(flag, "--elevation") == 0) {
+        if (!(val = args.value(flag))) return -1;
+        v.elevation = static_cast<float>(std::atof(val));
+    } else if (std::strcmp(flag, "--distance") == 0) {
+        if (!(val = args.value(flag))) return -1;
+        v.distance = static_cast<float>(std::atof(val));
+    } else if (std::strcmp(flag, "--time") == 0) {
+        if (!(val = args.value(flag))) return -1;
+        v.time = static_cast<float>(std::atof(val));
+    } else if (std::strcmp(flag, "--scalar") == 0) {
+        v.scalar = true;
+        ++args.i;
+    } else if (std::strcmp(flag, "--generic") == 0) {
+        v.generic = true;
+        ++args.i;
+    } else if (std::strcmp(flag, "--volume") == 0) {
+        if (!(val = args.value(flag))) return -1;
+        v.volume = std::atoi(val);
+        if (v.volume < 2) {
+            std::fprintf(stderr, "Bad --volume '%s' (expected a resolution >= 2)\n", val);
+            return -1;
+        }
+    } else if (std::strcmp(flag, "--lut") == 0) {
+        v.lut = true;
+        ++args.i;
+    } else if (std::strcmp(flag, "--cache") == 0) {
+        if (!(val = args.value(flag))) return -1;
+        v.cache_dir = val;
+    } else if (std::strcmp(flag, "--skip") == 0) {
+        if (!(val = args.value(flag))) return -1;
+        v.skip = std::atoi(val);
+        if (v.skip < 1) {
+            std::fprintf(stderr, "Bad --skip '%s' (expected a grid resolution >= 1)\n", val);
+            return -1;
+        }
+    } else if (std::strcmp(flag, "--adaptive") == 0) {
+        v.adaptive = true;
+        ++args.i;
+    } else if (std::strcmp(flag, "--superpose") == 0) {
+        if (!(val = args.value(flag))) return -1;
+        v.superpose = val;
+    } else if (std::strcmp(flag, "--scale") == 0) {
+        if (!(val = args.value(flag))) return -1;
+        v.scale = static_cast<float>(std::atof(val));
+        if (v.scale < kMinRenderScale || v.scale > 1.0f) {
+            std::fprintf(stderr, "Bad --scale '%s' (expected %.2f to 1)\n", val, kMinRenderScale);
+            return -1;
+        }
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+// Parses "NAME[:AMP[:PHASE_DEG]],..." (amplitude 1, phase 0 by default)
+// into terms of sup
+static bool parse_superposition(const char* spec, const OrbitalCatalog& catalog,
+                                Superposition& sup) {
+    sup.clear();
+    std::string list = spec;
+    std::size_t begin = 0;
+    while (begin <= list.size()) {
+        std::size_t end = list.find(',', begin);
+        if (end == std::string::npos) end = list.size();
+        std::string term = list.substr(begin, end - begin);
+        begin = end + 1;
+
+        float amplitude = 1.0f, phase_deg = 0.0f;
+        std::size_t colon = term.find(':');
+        std::string name = term.substr(0, colon);
+        if (colon != std::string::npos &&
+            std::sscanf(term.c_str() + colon + 1, "%f:%f", &amplitude, &phase_deg) < 1) {
+            std::fprintf(stderr, "Bad --superpose term '%s' (expected NAME[:AMP[:PHASE_DEG]])\n",
+                         term.c_str());
+            return false;
+        }
+        int idx = catalog.find(name.c_str());
+        if (idx < 0) {
+            std::fprintf(stderr, "Unknown orbital '%s' in --superpose\n", name.c_str());
+            return false;
+        }
+        if (!sup.add(catalog.orbitals[idx], amplitude, phase_deg * (kOrbPi / 180.0f)))
+            return false;
+    }
+    return sup.count() > 0;
+}
+
+// Stand-in orbital for framing and uniforms: the first term, with the
+// superposition's shared bounding radius
+static OrbitalInfo superposition_orbital(const Superposition& sup, const char* spec) {
+    OrbitalInfo orb = sup.term(0).orbital;
+    orb.bounding_radius = sup.extent();
+    orb.name = spec;
+    return orb;
+}
+
+static RaymarchUniforms build_uniforms(const OrbitalInfo& orb, const Camera& camera,
+                                       const ViewOptions& v) {
+    float aspect = static_cast<float>(v.width) / static_cast<float>(v.height);
+    mat4 vp = camera.projection_matrix(aspect) * camera.view_matrix();
+
+    RaymarchUniforms ru{};
+    ru.inv_view_proj   = vp.inverse();
+    ru.camera_pos      = camera.eye_position();
+    ru.n               = orb.n;
+    ru.l               = orb.l;
+    ru.m               = orb.m;
+    ru.radial_norm     = orb.radial_norm;
+    ru.angular_norm    = orb.angular_norm;
+    ru.bounding_radius = orb.bounding_radius;
+    ru.density_scale   = v.density;
+    ru.max_steps       = v.max_steps;
+    ru.time            = v.time;
+    ru.anim_speed      = 1.0f;
+    return ru;
+}
+
+static Camera make_camera(const OrbitalInfo& orb, const ViewOptions& v) {
+    Camera cam;
+    cam.azimuth   = v.azimuth;
+    cam.elevation = v.elevation;
+    cam.distance  = (v.distance > 0.0f) ? v.distance : orb.bounding_radius * 2.5f;
+    return cam;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// --- render ------------------------------------------------------------------
+
+static void print_view_usage() {
+    std::fprintf(stderr,
+        "  --orbital NAME|INDEX   orbital from the catalog (default 1s)\n"
+        "  --size WxH             image size (default 1920x1080)\n"
+        "  --steps N              ray march steps (default 128)\n"
+        "  --density X            density scale (default 1.0)\n"
+        "  --azimuth DEG          camera azimuth (default 30)\n"
+        "  --elevation DEG        camera elevation (default 20)\n"
+        "  --distance D           camera distance (default 2.5 * bounding radius)\n"
+        "  --time T               animation time for the shimmer and superposition phases (default 0)\n"
+        "  --scalar               use the scalar wave-function kernel instead of SIMD\n"
+        "  --generic              use the generic kernel instead of the per-orbital one\n"
+        "  --volume RES           sample a cached RES^3 psi grid instead of the wave function\n"
+        "  --lut                  sample radial and angular lookup tables instead of the wave function\n"
+        "  --cache DIR            psi grid cache directory (default orbital_cache, \"\" = none)\n"
+        "  --skip RES             skip empty space using a RES^3 occupancy grid\n"
+        "  --adaptive             size steps from the occupancy grid's density bounds\n"
+        "  --scale S              ray march at S times the image size, then upsample (default 1)\n"
+        "  --superpose SPEC       time-dependent superposition NAME[:AMP[:DEG]],... of up to\n"
+        "                         %d orbitals instead of --orbital, on --volume grids (default 128)\n",
+        kMaxSuperpositionTerms);
+}
+
+static int cmd_render(ArgCursor args, const OrbitalCatalog& catalog) {
+    ViewOptions view;
+    const char* out_path = "orbital.hdr";
+    int         progressive = 0;   // > 0: frames to accumulate
+
+    while (!args.done()) {
+        int r = parse_view_flag(args, view);
+        if (r < 0) return EXIT_FAILURE;
+        if (r > 0) continue;
+        if (std::strcmp(args.peek(), "--out") == 0) {
+            if (!(out_path = args.value("--out"))) return EXIT_FAILURE;
+            continue;
+        }
+        if (std::strcmp(args.peek(), "--progressive") == 0) {
+            const char* val = args.value("--progressive");
+            if (!val) return EXIT_FAILURE;
+            progressive = std::atoi(val);
+            if (progressive < 1) {
+                std::fprintf(stderr, "Bad --progressive '%s' (expected a frame count >= 1)\n", val);
+                return EXIT_FAILURE;
+            }
+            continue;
+        }
+        std::fprintf(stderr, "Unknown option '%s'\nrender options:\n"
+                     "  --out PATH             .hdr or .pfm output (default orbital.hdr)\n"
+                     "  --progressive N        accumulate N jittered frames of steps / %d each\n",
+                     args.peek(), kProgressiveStepDivisor);
+        print_view_usage();
+        return EXIT_FAILURE;
+    }
+
+    Superposition sup;
+    if (view.superpose && !parse_superposition(view.superpose, catalog, sup))
+        return EXIT_FAILURE;
+    int idx = catalog.find(view.orbital);
+    if (idx < 0) {
+        std::fprintf(stderr, "Unknown orbital '%s'\n", view.orbital);
+        return EXIT_FAILURE;
+    }
+    const OrbitalInfo orb = view.superpose ? superposition_orbital(sup, view.superpose)
+                                           : catalog.orbitals[idx];
+
+    CpuRenderer renderer;
+    renderer.resize(view.width, view.height);
+    renderer.set_render_scale(view.scale);
+    renderer.set_allow_simd(!view.scalar);
+    if (view.generic) renderer.set_kernel(select_packet_kernel(!view.scalar));
+
+    PsiVolumeCache volumes(view.cache_dir);
+    if (view.superpose) {
+        auto tv = std::chrono::steady_clock::now();
+        sup.build(volumes, view.volume > 0 ? view.volume : kSuperpositionGrid);
+        renderer.set_superposition(&sup);
+        std::printf("%s  %d terms on %d^3 basis grids (extent %.0f) ready in %.1f ms\n",
+                    orb.name, sup.count(), sup.resolution(), sup.grid_extent(),
+                    seconds_since(tv) * 1000.0);
+    } else if (view.volume > 0) {
+        auto tv = std::chrono::steady_clock::now();
+        renderer.set_psi_volume(&volumes.get(orb, view.volume));
+        std::printf("%s  %d^3 psi volume ready in %.1f ms\n",
+                    orb.name, view.volume, seconds_since(tv) * 1000.0);
+    }
+    OrbitalLut lut;
+    if (view.lut && !view.superpose && view.volume == 0) {
+        auto tl = std::chrono::steady_clock::now();
+        lut = build_orbital_lut(orb);
+        renderer.set_orbital_lut(&lut);
+        std::printf("%s  lookup tables (%d radial, 6 x %d^2 angular, %.0f KB) built in %.2f ms\n",
+                    orb.name, lut.radial_size, lut.face_size,
+                    static_cast<double>(lut.bytes()) / 1024.0, seconds_since(tl) * 1000.0);
+    }
+
+    if (view.adaptive && view.skip == 0) view.skip = 32;
+    OccupancyGrid occupancy;
+    if (view.skip > 0 && !view.superpose) {
+        auto tg = std::chrono::steady_clock::now();
+        occupancy = build_occupancy_grid(orb, view.skip);
+        std::printf("%s  %d^3 occupancy grid built in %.1f ms, %zu cells occupied\n",
+                    orb.name, view.skip, seconds_since(tg) * 1000.0,
+                    occupancy.occupied(occupancy_threshold(occupancy, view.density)));
+        renderer.set_occupancy(&occupancy);
+        renderer.set_adaptive(view.adaptive);
+    }
+
+    // A still view: progressive frames differ only in their lattice jitter
+    RaymarchUniforms ru = build_uniforms(orb, make_camera(orb, view), view);
+    int frames = std::max(progressive, 1);
+    renderer.set_progressive(progressive > 0);
+    std::uint64_t samples = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) {
+        renderer.draw_raymarch(ru);
+        samples += renderer.samples();
+    }
+    double secs = seconds_since(t0);
+
+    if (!write_hdr_image(out_path, renderer.hdr())) return EXIT_FAILURE;
+    std::printf("%s  %dx%d  %d steps  %s  %.1f ms  %.1f samples/pixel  -> %s\n",
+                orb.name, view.width, view.height, view.max_steps,
+                view.superpose ? "superposition"
+                : view.volume > 0 ? "volume"
+                : view.lut ? "lut" : packet_kernel_name(renderer.kernel()),
+                secs * 1000.0,
+                static_cast<double>(samples) / (static_cast<double>(view.width) * view.height),
+                out_path);
+    if (progressive > 0)
+        std::printf("progressive: %d frames of %d steps, %.1f ms per frame\n",
+                    frames, std::max(view.max_steps / kProgressiveStepDivisor, 1),
+                    secs * 1000.0 / frames);
+    if (view.scale < 1.0f)
+        std::printf("ray march at %dx%d (scale %.2f), bilateral upsample\n",
+                    scaled_size(view.width, view.scale), scaled_size(view.height, view.scale),
+                    view.scale);
+    return EXIT_SUCCESS;
+}
+
+// --- frames ------------------------------------------------------------------
+
+// One frame in flight: the render stage fills hdr, the post stage ldr, and
+// the write stage hands the slot back
+struct FrameSlot {
+    int      index = 0;
+    HdrImage hdr;
+    LdrImage ldr;
+};
+
+static int cmd_frames(ArgCursor args, const OrbitalCatalog& catalog) {
+    ViewOptions      view;
+    std::vector<int> orbitals;
+    int              frames = 120;
+    float            fps = 30.0f;
+    float            bloom = 0.5f;
+    const char*      out_dir = "frames";
+    const char*      format = "png";
+    float            target_ms = 0.0f;   // > 0: dynamic resolution
+
+    while (!args.done()) {
+        const char* flag = args.peek();
+        const char* val = nullptr;
+        if (std::strcmp(flag, "--orbital") == 0) {
+            if (!(val = args.value(flag))) return EXIT_FAILURE;
+            int idx = catalog.find(val);
+            if (idx < 0) {
+                std::fprintf(stderr, "Unknown orbital '%s'\n", val);
+                return EXIT_FAILURE;
+            }
+            orbitals.push_back(idx);
+            continue;
+        }
+        int r = parse_view_flag(args, view);
+        if (r < 0) return EXIT_FAILURE;
+        if (r > 0) continue;
+        if (std::strcmp(flag, "--frames") == 0) {
+            if (!(val = args.value(flag))) return EXIT_FAILURE;
+            frames = std::atoi(val);
+            if (frames < 1) {
+                std::fprintf(stderr, "Bad --frames '%s' (expected a count >= 1)\n", val);
+                return EXIT_FAILURE;
+            }
+        } else if (std::strcmp(flag, "--fps") == 0) {
+            if (!(val = args.value(flag))) return EXIT_FAILURE;
+            fps = static_cast<float>(std::atof(val));
+            if (!(fps > 0.0f)) {
+                std::fprintf(stderr, "Bad --fps '%s' (expected a rate > 0)\n", val);
+                return EXIT_FAILURE;
+            }
+        } else if (std::strcmp(flag, "--bloom") == 0) {
+            if (!(val = args.value(flag))) return EXIT_FAILURE;
+            bloom = static_cast<float>(std::atof(val));
+        } else if (std::strcmp(flag, "--out-dir") == 0) {
+            if (!(out_dir = args.value(flag))) return EXIT_FAILURE;
+        } else if (std::strcmp(flag, "--target-ms") == 0) {
+            if (!(val = args.value(flag))) return EXIT_FAILURE;
+            target_ms = static_cast<float>(std::atof(val));
+            if (target_ms <= 0.0f) {
+                std::fprintf(stderr, "Bad --target-ms '%s' (expected a time > 0)\n", val);
+                return EXIT_FAILURE;
+            }
+        } else if (std::strcmp(flag, "--format") == 0) {
+            if (!(format = args.value(flag))) return EXIT_FAILURE;
+            if (std::strcmp(format, "png") != 0 && std::strcmp(format, "ppm") != 0) {
+                std::fprintf(stderr, "Bad --format '%s' (expected png or ppm)\n", format);
+                return EXIT_FAILURE;
+            }
+        } else {
+            std::fprintf(stderr, "Unknown option '%s'\nframes options:\n"
+                "  --orbital NAME|INDEX   orbital to orbit (repeatable; default: whole catalog)\n"
+                "  --frames N             frames per orbital, one full turn (default 120)\n"
+                "  --fps X                frame rate for the animation time (default 30)\n"
+                "  --bloom X              bloom intensity (default 0.5, as in the app)\n"
+                "  --out-dir DIR          output directory (default frames)\n"
+                "  --format png|ppm       image format (default png)\n"
+                "  --target-ms MS         scale the ray march resolution to take about MS per frame\n", flag);
+            print_view_usage();
+            return EXIT_FAILURE;
+        }
+    }
+    Superposition sup;
+    if (view.superpose) {
+        if (!parse_superposition(view.superpose, catalog, sup)) return EXIT_FAILURE;
+        orbitals.assign(1, 0);   // one turn around the superposition
+    }
+    if (orbitals.empty())
+        for (int i = 0; i < catalog.count; ++i) orbitals.push_back(i);
+
+    std::error_code ec;
+    std::filesystem::create_directories(out_dir, ec);
+    if (ec) {
+        std::fprintf(stderr, "Cannot create %s: %s\n", out_dir, ec.message().c_str());
+        return EXIT_FAILURE;
+    }
+
+    // Render (this thread, itself parallel over tiles) -> post (tone map +
+    // bloom) -> write (encode + file), each stage on its own thread. Slots
+    // are recycled, so at most kSlots frames are in memory.
+    constexpr int kSlots = 4;
+    std::vector<FrameSlot>   slots(kSlots);
+    BoundedQueue<FrameSlot*> free_slots(kSlots), to_post(kSlots), to_write(kSlots);
+    for (auto& s : slots) free_slots.push(&s);
+
+    double post_secs = 0.0, write_secs = 0.0;
+    std::atomic<bool> write_failed{false};
+
+    std::thread post_thread([&] {
+        PostProcess post;
+        FrameSlot* slot;
+        while (to_post.pop(slot)) {
+            auto t = std::chrono::steady_clock::now();
+            post.apply(slot->hdr, bloom, slot->ldr);
+            post_secs += seconds_since(t);
+            to_write.push(slot);
+        }
+        to_write.close();
+    });
+
+    // After a failed write (disk full, say) the writer stops handing slots
+    // back and closes free_slots, so the render loop stops once the slots
+    // it still holds run out; it keeps draining to_write so post never
+    // blocks on it
+    std::thread write_thread([&] {
+        FrameSlot* slot;
+        while (to_write.pop(slot)) {
+            if (write_failed) continue;
+            auto t = std::chrono::steady_clock::now();
+            char path[512];
+            std::snprintf(path, sizeof(path), "%s/frame_%05d.%s", out_dir, slot->index, format);
+            if (!write_ldr_image(path, slot->ldr)) {
+                write_failed = true;
+                free_slots.close();
+                continue;
+            }
+            write_secs += seconds_since(t);
+            free_slots.push(slot);
+        }
+    });
+
+    CpuRenderer renderer;
+    renderer.resize(view.width, view.height);
+    renderer.set_render_scale(view.scale);
+    renderer.set_allow_simd(!view.scalar);
+    if (view.generic) renderer.set_kernel(select_packet_kernel(!view.scalar));
+    ResolutionScaler scaler(target_ms);
+    double scale_sum = 0.0;
+    PsiVolumeCache volumes(view.cache_dir);
+    OccupancyGrid  occupancy;
+    OrbitalLut     lut;
+    if (view.adaptive && view.skip == 0) view.skip = 32;
+
+    auto   t0 = std::chrono::steady_clock::now();
+    double render_secs = 0.0;
+    int    index = 0;
+    for (int idx : orbitals) {
+        if (write_failed) break;
+        const OrbitalInfo orb = view.superpose ? superposition_orbital(sup, view.superpose)
+                                               : catalog.orbitals[idx];
+        if (view.superpose) {
+            sup.build(volumes, view.volume > 0 ? view.volume : kSuperpositionGrid);
+            renderer.set_superposition(&sup);
+        } else if (view.volume > 0) {
+            renderer.set_psi_volume(&volumes.get(orb, view.volume));
+        } else if (view.lut) {
+            lut = build_orbital_lut(orb);
+            renderer.set_orbital_lut(&lut);
+        }
+        if (view.skip > 0 && !view.superpose) {
+            occupancy = build_occupancy_grid(orb, view.skip);
+            renderer.set_occupancy(&occupancy);
+            renderer.set_adaptive(view.adaptive);
+        }
+
+        std::printf("%s  frames %d-%d\n", orb.name, index, index + frames - 1);
+        std::fflush(stdout);
+        for (int f = 0; f < frames; ++f, ++index) {
+            ViewOptions frame_view = view;
+            frame_view.azimuth = view.azimuth + 360.0f * static_cast<float>(f) / static_cast<float>(frames);
+            frame_view.time = static_cast<float>(index) / fps;
+
+            FrameSlot* slot = nullptr;
+            if (write_failed || !free_slots.pop(slot)) {
+                std::fprintf(stderr, "Writing a frame failed, stopping at frame %d\n", index);
+                break;
+            }
+            auto t = std::chrono::steady_clock::now();
+            renderer.draw_raymarch(build_uniforms(orb, make_camera(orb, frame_view), frame_view));
+            scale_sum += renderer.render_scale();
+            if (target_ms > 0.0f)
+                renderer.set_render_scale(scaler.update(renderer.last_frame_ms(),
+                                                        renderer.render_scale()));
+            slot->index = index;
+            slot->hdr = renderer.hdr();
+            render_secs += seconds_since(t);
+            to_post.push(slot);
+        }
+    }
+    to_post.close();
+    post_thread.join();
+    write_thread.join();
+
+    double secs = seconds_since(t0);
+    std::printf("%d frames  %dx%d  %.2f s  (%.2f frames/s)  -> %s/frame_*.%s\n"
+                "stage busy time: render %.2f s  post %.2f s  write %.2f s\n",
+                index, view.width, view.height, secs, index / secs, out_dir, format,
+                render_secs, post_secs, write_secs);
+    if (target_ms > 0.0f)
+        std::printf("dynamic resolution: target %.1f ms, mean scale %.2f, last %.2f\n",
+                    target_ms, scale_sum / index, renderer.render_scale());
+    return write_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// --- points ------------------------------------------------------------------
+
+static int cmd_points(ArgCursor args, const OrbitalCatalog& catalog) {
+    const char*   name = "1s";
+    const char*   out_path = "orbital.pts";
+    long long     count = 1000000;
+    std::uint64_t seed = 1;
+
+    while (!args.done()) {
+        const char* flag = args.peek();
+        const char* val = nullptr;
+        if (std::strcmp(flag, "--orbital") == 0) {
+            if (!(name = args.value(flag))) return EXIT_FAILURE;
+        } else if (std::strcmp(flag, "--count") == 0) {
+            if (!(val = args.value(flag))) return EXIT_FAILURE;
+            count = std::atoll(val);
+            if (count < 1) {
+                std::fprintf(stderr, "Bad --count '%s' (expected a positive number)\n", val);
+                return EXIT_FAILURE;
+            }
+        } else if (std::strcmp(flag, "--seed") == 0) {
+            if (!(val = args.value(flag))) return EXIT_FAILURE;
+            seed = std::strtoull(val, nullptr, 10);
+        } else if (std::strcmp(flag, "--out") == 0) {
+            if (!(out_path = args.value(flag))) return EXIT_FAILURE;
+        } else {
+            std::fprintf(stderr, "Unknown option '%s'\npoints options:\n"
+                "  --orbital NAME|INDEX   orbital from the catalog (default 1s)\n"
+                "  --count N              points to draw (default 1000000)\n"
+                "  --seed S               RNG seed (default 1)\n"
+                "  --out PATH             .pts output (default orbital.pts)\n", flag);
+            return EXIT_FAILURE;
+        }
+    }
+
+    int idx = catalog.find(name);
+    if (idx < 0) {
+        std::fprintf(stderr, "Unknown orbital '%s'\n", name);
+        return EXIT_FAILURE;
+    }
+    const auto& orb = catalog.orbitals[idx];
+
+    auto t0 = std::chrono::steady_clock::now();
+    PointCloud cloud = sample_point_cloud(orb, static_cast<std::size_t>(count), seed);
+    double secs = seconds_since(t0);
+
+    // <r> = (3n^2 - l(l+1)) / 2 for hydrogen; the sample mean should agree
+    double mean_r = 0.0;
+    for (const auto& p : cloud.points)
+        mean_r += std::sqrt(static_cast<double>(p.x) * p.x + static_cast<double>(p.y) * p.y +
+                            static_cast<double>(p.z) * p.z);
+    mean_r /= static_cast<double>(cloud.points.size());
+    double expected_r = 0.5 * (3.0 * orb.n * orb.n - orb.l * (orb.l + 1));
+
+    if (!write_point_cloud(out_path, cloud)) return EXIT_FAILURE;
+    std::printf("%s  %lld points  %d threads  %.1f ms  (%.1f M points/s)  <r> %.3f (exact %.3f)  -> %s\n",
+                orb.name, count, JobSystem::instance().thread_count(),
+                secs * 1000.0, static_cast<double>(count) / secs * 1e-6,
+                mean_r, expected_r, out_path);
+    return EXIT_SUCCESS;
+}
+
+// --- mesh --------------------------------------------------------------------
+
+static int cmd_mesh(ArgCursor args, const OrbitalCatalog& catalog) {
+    const char* name = "1s";
+    const char* out_path = nullptr;
+    const char* cache_dir = "orbital_cache";
+    int         resolution = 128;
+    float       iso = 0.0f;        // 0: the level enclosing 90% of the probability
+
+    while (!args.done()) {
+        const char* flag = args.peek();
+        const char* val = nullptr;
+        if (std::strcmp(flag, "--orbital") == 0) {
+            if (!(name = args.value(flag))) return EXIT_FAILURE;
+        } else if (std::strcmp(flag, "--volume") == 0) {
+            if (!(val = args.value(flag))) return EXIT_FAILURE;
+            resolution = std::atoi(val);
+            if (resolution < 2) {
+                std::fprintf(stderr, "Bad --volume '%s' (expected a resolution >= 2)\n", val);
+                return EXIT_FAILURE;
+            }
+        } else if (std::strcmp(flag, "--iso") == 0) {
+            if (!(val = args.value(flag))) return EXIT_FAILURE;
+            iso = static_cast<float>(std::atof(val));
+            if (!(iso > 0.0f)) {
+                std::fprintf(stderr, "Bad --iso '%s' (expected a psi level > 0)\n", val);
+                return EXIT_FAILURE;
+            }
+        } else if (std::strcmp(flag, "--cache") == 0) {
+            if (!(cache_dir = args.value(flag))) return EXIT_FAILURE;
+        } else if (std::strcmp(flag, "--out") == 0) {
+            if (!(out_path = args.value(flag))) return EXIT_FAILURE;
+        } else {
+            std::fprintf(stderr, "Unknown option '%s'\nmesh options:\n"
+                "  --orbital NAME|INDEX   orbital from the catalog (default 1s)\n"
+                "  --volume RES           psi grid resolution (default 128)\n"
+                "  --iso X                |psi| level (default: surface enclosing 90%% probability)\n"
+                "  --cache DIR            psi grid / mesh cache directory (default orbital_cache, \"\" = none)\n"
+                "  --out PATH             also write the mesh here (.ply)\n", flag);
+            return EXIT_FAILURE;
+        }
+    }
+
+    int idx = catalog.find(name);
+    if (idx < 0) {
+        std::fprintf(stderr, "Unknown orbital '%s'\n", name);
+        return EXIT_FAILURE;
+    }
+    const auto& orb = catalog.orbitals[idx];
+
+    PsiVolumeCache volumes(cache_dir);
+    auto tv = std::chrono::steady_clock::now();
+    const PsiVolume& vol = volumes.get(orb, resolution);
+    if (iso <= 0.0f) iso = enclosed_probability_iso(vol, 0.9f);
+    std::printf("%s  %d^3 psi volume ready in %.1f ms, iso %.6g\n",
+                orb.name, resolution, seconds_since(tv) * 1000.0, static_cast<double>(iso));
+
+    IsoMeshCache meshes(cache_dir);
+    bool loaded = false;
+    auto t0 = std::chrono::steady_clock::now();
+    const IsoMesh& mesh = meshes.get(vol, iso, &loaded);
+    double secs = seconds_since(t0);
+    std::printf("%s  %zu triangles (%zu +, %zu -)  %zu vertices  %s in %.1f ms  %.1f MB\n",
+                orb.name, mesh.triangles(), mesh.positive_triangles,
+                mesh.triangles() - mesh.positive_triangles, mesh.vertices.size(),
+                loaded ? "loaded" : "extracted", secs * 1000.0,
+                static_cast<double>(mesh.bytes()) / (1024.0 * 1024.0));
+
+    if (out_path) {
+        if (!write_iso_mesh(out_path, mesh)) return EXIT_FAILURE;
+        std::printf("-> %s\n", out_path);
+    }
+    return EXIT_SUCCESS;
+}
+
+// --- glsl --------------------------------------------------------------------
+
+static int cmd_glsl(ArgCursor args, const OrbitalCatalog& catalog) {
+    const char* name = "1s";
+    while (!args.done()) {
+        if (std::strcmp(args.peek(), "--orbital") == 0) {
+            if (!(name = args.value("--orbital"))) return EXIT_FAILURE;
+            continue;
+        }
+        std::fprintf(stderr, "Unknown option '%s'\nglsl options:\n  --orbital NAME|INDEX\n", args.peek());
+        return EXIT_FAILURE;
+    }
+
+    int idx = catalog.find(name);
+    if (idx < 0) {
+        std::fprintf(stderr, "Unknown orbital '%s'\n", name);
+        return EXIT_FAILURE;
+    }
+    const auto& orb = catalog.orbitals[idx];
+    if (specialized_index(orb.n, orb.l, orb.m) < 0) {
+        std::fprintf(stderr, "%s has no specialized shader\n", orb.name);
+        return EXIT_FAILURE;
+    }
+    std::fputs(orbital_psi_glsl(orb.n, orb.l, orb.m, orb.radial_norm, orb.angular_norm).c_str(),
+               stdout);
+    return EXIT_SUCCESS;
+}
+
+// --- stats -------------------------------------------------------------------
+
+static int cmd_stats(ArgCursor args, const OrbitalCatalog& catalog) {
+    const char* name = nullptr;   // all orbitals
+    double      tolerance = 1e-10;
+
+    while (!args.done()) {
+        const char* flag = args.peek();
+        const char* val = nullptr;
+        if (std::strcmp(flag, "--orbital") == 0) {
+            if (!(name = args.value(flag))) return EXIT_FAILURE;
+        } else if (std::strcmp(flag, "--tolerance") == 0) {
+            if (!(val = args.value(flag))) return EXIT_FAILURE;
+            tolerance = std::atof(val);
+            if (!(tolerance > 0.0)) {
+                std::fprintf(stderr, "Bad --tolerance '%s' (expected a number > 0)\n", val);
+                return EXIT_FAILURE;
+            }
+        } else {
+            std::fprintf(stderr, "Unknown option '%s'\nstats options:\n"
+                "  --orbital NAME|INDEX   one orbital (default: the whole catalog)\n"
+                "  --tolerance T          relative cubature tolerance (default 1e-10)\n", flag);
+            return EXIT_FAILURE;
+        }
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<OrbitalStats> stats;
+    std::vector<int> indices;
+    if (name) {
+        int idx = catalog.find(name);
+        if (idx < 0) {
+            std::fprintf(stderr, "Unknown orbital '%s'\n", name);
+            return EXIT_FAILURE;
+        }
+        stats.push_back(compute_orbital_stats(catalog.orbitals[idx], tolerance));
+        indices.push_back(idx);
+    } else {
+        stats = compute_catalog_stats(catalog, tolerance);
+        for (int i = 0; i < catalog.count; ++i) indices.push_back(i);
+    }
+    double secs = seconds_since(t0);
+
+    std::printf("%-12s %12s %10s %12s %9s  nodes\n", "orbital", "norm - 1", "<r>", "<r^2>", "r99");
+    double worst_norm = 0.0, worst_r = 0.0, worst_r2 = 0.0;
+    long long evals = 0;
+    for (std::size_t k = 0; k < stats.size(); ++k) {
+        const auto& orb = catalog.orbitals[indices[k]];
+        const auto& s = stats[k];
+        double n2 = static_cast<double>(orb.n) * orb.n, ll = orb.l * (orb.l + 1.0);
+        double exact_r  = 0.5 * (3.0 * n2 - ll);
+        double exact_r2 = 0.5 * n2 * (5.0 * n2 + 1.0 - 3.0 * ll);
+        worst_norm = std::max(worst_norm, std::fabs(s.norm - 1.0));
+        worst_r    = std::max(worst_r, std::fabs(s.mean_r / exact_r - 1.0));
+        worst_r2   = std::max(worst_r2, std::fabs(s.mean_r2 / exact_r2 - 1.0));
+        evals += s.evaluations;
+
+        std::printf("%-12s %12.3e %10.4f %12.4f %9.3f ", orb.name, s.norm - 1.0,
+                    s.mean_r, s.mean_r2, s.r_enclosed);
+        for (int i = 0; i < s.node_count; ++i) std::printf(" %.4f", s.nodes[i]);
+        std::printf("\n");
+    }
+    std::printf("%zu orbitals  %d threads  %.1f ms  %.2f M evaluations\n"
+                "worst |norm - 1| %.2e  <r> rel. error %.2e  <r^2> rel. error %.2e\n",
+                stats.size(), JobSystem::instance().thread_count(), secs * 1000.0,
+                static_cast<double>(evals) * 1e-6, worst_norm, worst_r, worst_r2);
+    return EXIT_SUCCESS;
+}
+
+// --- golden ------------------------------------------------------------------
+
+// Fixed cameras every orbital is checked from: the app's default view and
+// one from below, so both lobes of asymmetric orbitals are covered
+struct GoldenCamera {
+    float azimuth, elevation;
+};
+constexpr GoldenCamera kGoldenCameras[] = {{30.0f, 20.0f}, {120.0f, -50.0f}};
+constexpr int          kGoldenCameraCount = static_cast<int>(std::size(kGoldenCameras));
+
+static std::string golden_path(const char* dir, int orbital, int camera) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "orbital_%03d_cam%d.pfm", orbital, camera);
+    return (std::filesystem::path(dir) / name).string();
+}
+
+// Timing baseline: one "name": ms pair per line, which is all the reader
+// below has to understand
+static bool write_golden_baseline(const char* path, const ViewOptions& v,
+                                  const OrbitalCatalog& catalog, const std::vector<int>& orbitals,
+                                  const std::vector<double>& ms) {
+    std::FILE* f = std::fopen(path, "w");
+    if (!f) {
+        std::fprintf(stderr, "Cannot open %s for writing\n", path);
+        return false;
+    }
+    double total = 0.0;
+    std::fprintf(f, "{\n  \"size\": [%d, %d],\n  \"steps\": %d,\n  \"cameras\": %d,\n"
+                 "  \"render_ms\": {\n", v.width, v.height, v.max_steps, kGoldenCameraCount);
+    for (std::size_t k = 0; k < orbitals.size(); ++k) {
+        std::fprintf(f, "    \"%s\": %.3f%s\n", catalog.orbitals[orbitals[k]].name, ms[k],
+                     k + 1 < orbitals.size() ? "," : "");
+        total += ms[k];
+    }
+    std::fprintf(f, "  },\n  \"total_ms\": %.3f\n}\n", total);
+    std::fclose(f);
+    return true;
+}
+
+// Render time of one orbital from a baseline file's text; < 0 if absent
+static double golden_baseline_ms(const std::string& json, const char* name) {
+    std::string key = std::string("\"") + name + "\": ";
+    std::size_t at = json.find(key);
+    return at == std::string::npos ? -1.0 : std::strtod(json.c_str() + at + key.size(), nullptr);
+}
+
+static int cmd_golden(ArgCursor args, const OrbitalCatalog& catalog) {
+    ViewOptions      view;
+    std::vector<int> orbitals;
+    const char*      dir = "golden";
+    const char*      json_path = nullptr;
+    bool             update = false;
+    double           min_psnr = 40.0;   // dB, on the displayed 8-bit image
+    int              repeat = 1;
+    view.width  = 160;
+    view.height = 90;
+
+    while (!args.done()) {
+        const char* flag = args.peek();
+        const char* val = nullptr;
+        if (std::strcmp(flag, "--orbital") == 0) {
+            if (!(val = args.value(flag))) return EXIT_FAILURE;
+            int idx = catalog.find(val);
+            if (idx < 0) {
+                std::fprintf(stderr, "Unknown orbital '%s'\n", val);
+                return EXIT_FAILURE;
+            }
+            orbitals.push_back(idx);
+            continue;
+        }
+        int r = parse_view_flag(args, view);
+        if (r < 0) return EXIT_FAILURE;
+        if (r > 0) continue;
+        if (std::strcmp(flag, "--dir") == 0) {
+            if (!(dir = args.value(flag))) return EXIT_FAILURE;
+        } else if (std::strcmp(flag, "--update") == 0) {
+            update = true;
+            ++args.i;
+        } else if (std::strcmp(flag, "--psnr") == 0) {
+            if (!(val = args.value(flag))) return EXIT_FAILURE;
+            min_psnr = std::atof(val);
+        } else if (std::strcmp(flag, "--repeat") == 0) {
+            if (!(val = args.value(flag))) return EXIT_FAILURE;
+            repeat = std::atoi(val);
+            if (repeat < 1) {
+                std::fprintf(stderr, "Bad --repeat '%s' (expected a count >= 1)\n", val);
+                return EXIT_FAILURE;
+            }
+        } else if (std::strcmp(flag, "--json") == 0) {
+            if (!(json_path = args.value(flag))) return EXIT_FAILURE;
+        } else {
+            std::fprintf(stderr, "Unknown option '%s'\ngolden options:\n"
+                "  --orbital NAME|INDEX   orbital to check (repeatable; default: whole catalog)\n"
+                "  --dir DIR              golden images and baseline.json (default golden)\n"
+                "  --update               write the goldens and timing baseline instead of comparing\n"
+                "  --psnr DB              lowest displayed-image PSNR that passes (default 40)\n"
+                "  --repeat N             time the best of N renders per camera (default 1)\n"
+                "  --json PATH            also write this run's timings in baseline form\n"
+                "the view options select the configuration under test (default size 160x90;\n"
+                "cameras are fixed):\n", flag);
+            print_view_usage();
+            return EXIT_FAILURE;
+        }
+    }
+    if (view.superpose) {
+        std::fprintf(stderr, "golden checks catalog orbitals; --superpose is not supported\n");
+        return EXIT_FAILURE;
+    }
+    if (orbitals.empty())
+        for (int i = 0; i < catalog.count; ++i) orbitals.push_back(i);
+
+    std::string baseline_path = (std::filesystem::path(dir) / "baseline.json").string();
+    std::string baseline;
+    if (update) {
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        if (ec) {
+            std::fprintf(stderr, "Cannot create %s: %s\n", dir, ec.message().c_str());
+            return EXIT_FAILURE;
+        }
+    } else if (std::FILE* f = std::fopen(baseline_path.c_str(), "r")) {
+        char buf[4096];
+        for (std::size_t n; (n = std::fread(buf, 1, sizeof(buf), f)) > 0;) baseline.append(buf, n);
+        std::fclose(f);
+    } else {
+        std::fprintf(stderr, "No %s; run golden --update on the reference configuration first\n",
+                     baseline_path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    CpuRenderer renderer;
+    renderer.resize(view.width, view.height);
+    renderer.set_render_scale(view.scale);
+    renderer.set_allow_simd(!view.scalar);
+    if (view.generic) renderer.set_kernel(select_packet_kernel(!view.scalar));
+    PsiVolumeCache volumes(view.cache_dir);
+    OccupancyGrid  occupancy;
+    OrbitalLut     lut;
+    PostProcess    post;
+    LdrImage       shown, expected;
+    HdrImage       golden;
+    if (view.adaptive && view.skip == 0) view.skip = 32;
+
+    std::vector<double> ms(orbitals.size(), 0.0);
+    double total = 0.0, total_base = 0.0, worst_psnr = INFINITY;
+    int    failures = 0;
+    if (!update)
+        std::printf("%-12s %9s %9s %8s %10s\n", "orbital", "ms", "base ms", "speedup", "min PSNR");
+
+    for (std::size_t k = 0; k < orbitals.size(); ++k) {
+        const OrbitalInfo& orb = catalog.orbitals[orbitals[k]];
+        if (view.volume > 0) {
+            renderer.set_psi_volume(&volumes.get(orb, view.volume));
+        } else if (view.lut) {
+            lut = build_orbital_lut(orb);
+            renderer.set_orbital_lut(&lut);
+        }
+        if (view.skip > 0) {
+            occupancy = build_occupancy_grid(orb, view.skip);
+            renderer.set_occupancy(&occupancy);
+            renderer.set_adaptive(view.adaptive);
+        }
+
+        double psnr = INFINITY;
+        bool   missing = false;
+        for (int c = 0; c < kGoldenCameraCount; ++c) {
+            ViewOptions cam_view = view;
+            cam_view.azimuth   = kGoldenCameras[c].azimuth;
+            cam_view.elevation = kGoldenCameras[c].elevation;
+            RaymarchUniforms ru = build_uniforms(orb, make_camera(orb, cam_view), cam_view);
+
+            double best = INFINITY;
+            for (int rep = 0; rep < repeat; ++rep) {
+                auto t = std::chrono::steady_clock::now();
+                renderer.draw_raymarch(ru);
+                best = std::min(best, seconds_since(t) * 1000.0);
+            }
+            ms[k] += best;
+
+            std::string path = golden_path(dir, orbitals[k], c);
+            if (update) {
+                if (!write_pfm(path.c_str(), renderer.hdr())) return EXIT_FAILURE;
+                continue;
+            }
+            if (!read_pfm(path.c_str(), golden) || golden.width != view.width ||
+                golden.height != view.height) {
+                missing = true;
+                continue;
+            }
+            // Compared as displayed: tone mapped, with the app's bloom
+            post.apply(renderer.hdr(), 0.5f, shown);
+            post.apply(golden, 0.5f, expected);
+            psnr = std::min(psnr, compare_images(shown, expected).psnr);
+        }
+        total += ms[k];
+        if (update) continue;
+
+        double base = golden_baseline_ms(baseline, orb.name);
+        if (base > 0.0) total_base += base;
+        bool pass = !missing && psnr >= min_psnr;
+        if (!pass) ++failures;
+        worst_psnr = std::min(worst_psnr, psnr);
+        std::printf("%-12s %9.2f %9.2f %7.2fx %10.1f%s\n", orb.name, ms[k], base,
+                    base > 0.0 ? base / ms[k] : 0.0, psnr,
+                    missing ? "  FAIL (no golden image of this size)" : pass ? "" : "  FAIL");
+    }
+
+    if (update) {
+        if (!write_golden_baseline(baseline_path.c_str(), view, catalog, orbitals, ms))
+            return EXIT_FAILURE;
+        std::printf("%zu orbitals x %d cameras  %dx%d  %.1f ms  -> %s\n", orbitals.size(),
+                    kGoldenCameraCount, view.width, view.height, total, dir);
+        return EXIT_SUCCESS;
+    }
+    if (json_path && !write_golden_baseline(json_path, view, catalog, orbitals, ms))
+        return EXIT_FAILURE;
+    std::printf("%zu orbitals x %d cameras  %.1f ms vs %.1f ms baseline (%.2fx)  "
+                "min PSNR %.1f dB  %d below %.1f dB\n",
+                orbitals.size(), kGoldenCameraCount, total, total_base,
+                total > 0.0 ? total_base / total : 0.0, worst_psnr, failures, min_psnr);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// --- Main --------------------------------------------------------------------
+
+struct Command {
+    const char* name;
+    int (*run)(ArgCursor args, const OrbitalCatalog& catalog);
+    const char* help;
+};
+
+static const Command kCommands[] = {
+    {"render", cmd_render, "CPU ray march one frame to an HDR image"},
+    {"frames", cmd_frames, "render an orbit around each orbital to numbered images"},
+    {"points", cmd_points, "sample electron positions from |psi|^2 to a .pts file"},
+    {"mesh",   cmd_mesh,   "extract the +/-iso surfaces of a psi volume to a cached .ply mesh"},
+    {"glsl",   cmd_glsl,   "print the generated orbital_psi() GLSL for one orbital"},
+    {"stats",  cmd_stats,  "norm, <r>, <r^2>, radial nodes and 99% radius by adaptive cubature"},
+    {"golden", cmd_golden, "render every orbital from fixed cameras, compare to golden images and timings"},
+};
+
+static void print_usage() {
+    std::fprintf(stderr, "usage: ElectronOrbitalsHeadless <command> [options]\n\ncommands:\n");
+    for (const auto& c : kCommands)
+        std::fprintf(stderr, "  %-10s %s\n", c.name, c.help);
+    std::fprintf(stderr, "\ncommon view options:\n");
+    print_view_usage();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    OrbitalCatalog catalog;
+    catalog.build();
+
+    for (const auto& c : kCommands)
+        if (std::strcmp(argv[1], c.name) == 0)
+            return c.run(ArgCursor{argc, argv, 2}, catalog);
+
+    std::fprintf(stderr, "Unknown command '%s'\n", argv[1]);
+    print_usage();
+    return EXIT_FAILURE;
+}
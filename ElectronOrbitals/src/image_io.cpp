@@ -0,0 +1,235 @@
+#include "image_io.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static bool has_extension(const char* path, const char* ext) {
+    std::size_t n = std::strlen(path), e = std::strlen(ext);
+    return n >= e && std::strcmp(path + n - e, ext) == 0;
+}
+
+bool write_pfm(const char* path, const HdrImage& img) {
+    std::FILE* f = std::fopen(path, "wb");
+    if (!f) {
+        std::fprintf(stderr, "Cannot open %s for writing\n", path);
+        return false;
+    }
+    // Negative scale marks little-endian data
+    std::fprintf(f, "PF\n%d %d\n-1.0\n", img.width, img.height);
+    bool ok = true;
+    for (int y = img.height - 1; y >= 0 && ok; --y)
+        ok = std::fwrite(img.row(y), sizeof(float), static_cast<std::size_t>(img.width) * 3, f)
+             == static_cast<std::size_t>(img.width) * 3;
+    std::fclose(f);
+    return ok;
+}
+
+std::uint64_t file_bytes_left(std::FILE* f) {
+    long at = std::ftell(f);
+    if (at < 0 || std::fseek(f, 0, SEEK_END) != 0) return 0;
+    long end = std::ftell(f);
+    std::fseek(f, at, SEEK_SET);
+    return end > at ? static_cast<std::uint64_t>(end - at) : 0;
+}
+
+bool read_pfm(const char* path, HdrImage& img) {
+    std::FILE* f = std::fopen(path, "rb");
+    if (!f) {
+        std::fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+    // Header: "PF", width, height, scale, then exactly one whitespace byte
+    char   magic[3] = {};
+    int    w = 0, h = 0;
+    double scale = 0.0;
+    bool ok = std::fscanf(f, "%2s %d %d %lf", magic, &w, &h, &scale) == 4 &&
+              std::strcmp(magic, "PF") == 0 && w > 0 && h > 0 && std::fgetc(f) != EOF &&
+              static_cast<std::uint64_t>(w) * static_cast<std::uint64_t>(h) <=
+                  file_bytes_left(f) / (3 * sizeof(float));
+    if (ok) {
+        img.resize(w, h);
+        for (int y = h - 1; y >= 0 && ok; --y)
+            ok = std::fread(img.row(y), sizeof(float), static_cast<std::size_t>(w) * 3, f)
+                 == static_cast<std::size_t>(w) * 3;
+    }
+    std::fclose(f);
+    if (!ok) {
+        std::fprintf(stderr, "%s is not a readable color PFM\n", path);
+        return false;
+    }
+
+    // Positive scale: big-endian data
+    if (scale > 0.0) {
+        for (float& v : img.pixels) {
+            std::uint32_t u;
+            std::memcpy(&u, &v, 4);
+            u = (u >> 24) | ((u >> 8) & 0xff00u) | ((u << 8) & 0xff0000u) | (u << 24);
+            std::memcpy(&v, &u, 4);
+        }
+    }
+    return true;
+}
+
+// Shared exponent encoding: mantissas scaled so the largest channel
+// lands in [128, 256).
+static void float_to_rgbe(const float* rgb, std::uint8_t* out) {
+    float v = rgb[0];
+    if (rgb[1] > v) v = rgb[1];
+    if (rgb[2] > v) v = rgb[2];
+    if (v < 1e-32f) {
+        out[0] = out[1] = out[2] = out[3] = 0;
+        return;
+    }
+    int e;
+    float scale = std::frexp(v, &e) * 256.0f / v;
+    for (int c = 0; c < 3; ++c) {
+        float ch = rgb[c] > 0.0f ? rgb[c] : 0.0f;
+        out[c] = static_cast<std::uint8_t>(ch * scale);
+    }
+    out[3] = static_cast<std::uint8_t>(e + 128);
+}
+
+bool write_radiance_hdr(const char* path, const HdrImage& img) {
+    std::FILE* f = std::fopen(path, "wb");
+    if (!f) {
+        std::fprintf(stderr, "Cannot open %s for writing\n", path);
+        return false;
+    }
+    std::fprintf(f, "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y %d +X %d\n",
+                 img.height, img.width);
+
+    std::vector<std::uint8_t> line(static_cast<std::size_t>(img.width) * 4);
+    bool ok = true;
+    for (int y = 0; y < img.height && ok; ++y) {
+        const float* src = img.row(y);
+        for (int x = 0; x < img.width; ++x)
+            float_to_rgbe(src + x * 3, line.data() + x * 4);
+        ok = std::fwrite(line.data(), 1, line.size(), f) == line.size();
+    }
+    std::fclose(f);
+    return ok;
+}
+
+bool write_hdr_image(const char* path, const HdrImage& img) {
+    if (has_extension(path, ".pfm")) return write_pfm(path, img);
+    return write_radiance_hdr(path, img);
+}
+
+bool write_ppm(const char* path, const LdrImage& img) {
+    std::FILE* f = std::fopen(path, "wb");
+    if (!f) {
+        std::fprintf(stderr, "Cannot open %s for writing\n", path);
+        return false;
+    }
+    std::fprintf(f, "P6\n%d %d\n255\n", img.width, img.height);
+    bool ok = std::fwrite(img.pixels.data(), 1, img.pixels.size(), f) == img.pixels.size();
+    std::fclose(f);
+    return ok;
+}
+
+static std::uint32_t crc32(const std::uint8_t* data, std::size_t len, std::uint32_t crc = 0) {
+    static const auto table = [] {
+        std::array<std::uint32_t, 256> t{};
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (std::size_t i = 0; i < len; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void put_be32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    out.push_back(static_cast<std::uint8_t>(v >> 24));
+    out.push_back(static_cast<std::uint8_t>(v >> 16));
+    out.push_back(static_cast<std::uint8_t>(v >> 8));
+    out.push_back(static_cast<std::uint8_t>(v));
+}
+
+// Length, type, data, CRC over type + data
+static void put_chunk(std::vector<std::uint8_t>& out, const char* type,
+                      const std::uint8_t* data, std::size_t len) {
+    put_be32(out, static_cast<std::uint32_t>(len));
+    std::size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + len);
+    put_be32(out, crc32(out.data() + start, len + 4));
+}
+
+bool write_png(const char* path, const LdrImage& img) {
+    // Scanlines with filter type 0 (none)
+    const std::size_t stride = static_cast<std::size_t>(img.width) * 3;
+    std::vector<std::uint8_t> raw((stride + 1) * img.height);
+    for (int y = 0; y < img.height; ++y) {
+        raw[y * (stride + 1)] = 0;
+        std::memcpy(&raw[y * (stride + 1) + 1], img.row(y), stride);
+    }
+
+    // zlib: header, stored blocks of up to 65535 bytes, Adler-32
+    constexpr std::size_t kBlock = 65535;
+    std::vector<std::uint8_t> z;
+    z.reserve(raw.size() + raw.size() / kBlock * 5 + 16);
+    z.push_back(0x78);
+    z.push_back(0x01);
+    std::size_t pos = 0;
+    do {
+        std::size_t len = std::min(kBlock, raw.size() - pos);
+        bool last = pos + len == raw.size();
+        z.push_back(last ? 1 : 0);
+        z.push_back(static_cast<std::uint8_t>(len));
+        z.push_back(static_cast<std::uint8_t>(len >> 8));
+        z.push_back(static_cast<std::uint8_t>(~len));
+        z.push_back(static_cast<std::uint8_t>(~len >> 8));
+        z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    } while (pos < raw.size());
+
+    std::uint32_t a = 1, b = 0;
+    for (std::size_t i = 0; i < raw.size(); ) {
+        // 5552 bytes is the most that cannot overflow b before the modulo
+        std::size_t end = std::min(raw.size(), i + 5552);
+        for (; i < end; ++i) {
+            a += raw[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    put_be32(z, (b << 16) | a);
+
+    std::uint8_t ihdr[13] = {};
+    for (int i = 0; i < 4; ++i) {
+        ihdr[i]     = static_cast<std::uint8_t>(static_cast<std::uint32_t>(img.width) >> (24 - 8 * i));
+        ihdr[4 + i] = static_cast<std::uint8_t>(static_cast<std::uint32_t>(img.height) >> (24 - 8 * i));
+    }
+    ihdr[8] = 8;   // bit depth
+    ihdr[9] = 2;   // color type: RGB
+
+    static const std::uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::vector<std::uint8_t> png(kSignature, kSignature + 8);
+    png.reserve(z.size() + 64);
+    put_chunk(png, "IHDR", ihdr, sizeof(ihdr));
+    put_chunk(png, "IDAT", z.data(), z.size());
+    put_chunk(png, "IEND", nullptr, 0);
+
+    std::FILE* f = std::fopen(path, "wb");
+    if (!f) {
+        std::fprintf(stderr, "Cannot open %s for writing\n", path);
+        return false;
+    }
+    bool ok = std::fwrite(png.data(), 1, png.size(), f) == png.size();
+    std::fclose(f);
+    return ok;
+}
+
+bool write_ldr_image(const char* path, const LdrImage& img) {
+    if (has_extension(path, ".ppm")) return write_ppm(path, img);
+    return write_png(path, img);
+}
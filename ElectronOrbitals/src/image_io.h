@@ -0,0 +1,33 @@
+#pragma once
+#include "hdr_image.h"
+#include <cstdint>
+#include <cstdio>
+
+// Bytes from f's position to the end of the file (0 if unknown). Readers
+// bound the sizes a header claims by it before allocating for them, so a
+// corrupt or truncated file cannot ask for a huge buffer.
+std::uint64_t file_bytes_left(std::FILE* f);
+
+// Portable float map (.pfm): little-endian RGB32F, bottom row first.
+bool write_pfm(const char* path, const HdrImage& img);
+
+// Reads a color (PF) float map in either byte order; false and an error
+// if the file is missing or not one.
+bool read_pfm(const char* path, HdrImage& img);
+
+// Radiance RGBE (.hdr), written as flat (uncompressed) scanlines.
+bool write_radiance_hdr(const char* path, const HdrImage& img);
+
+// Picks the format from the extension (.pfm or .hdr; anything else -> .hdr).
+bool write_hdr_image(const char* path, const HdrImage& img);
+
+// Binary PPM (P6), 8-bit RGB.
+bool write_ppm(const char* path, const LdrImage& img);
+
+// PNG, 8-bit RGB. The zlib stream uses stored (uncompressed) deflate
+// blocks: no compression, but no dependency and next to no encode time,
+// and every decoder reads it.
+bool write_png(const char* path, const LdrImage& img);
+
+// Picks the format from the extension (.ppm or .png; anything else -> .png).
+bool write_ldr_image(const char* path, const LdrImage& img);
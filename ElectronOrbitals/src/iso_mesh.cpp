@@ -0,0 +1,399 @@
+#include "iso_mesh.h"
+#include "parallel.h"
+#include "image_io.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <unordered_map>
+
+// --- Case table --------------------------------------------------------------
+
+namespace {
+
+// Cube corner i sits at (i & 1, i >> 1 & 1, i >> 2 & 1). Edge a * 4 + k runs
+// along axis a from the k-th corner with bit a clear.
+constexpr int kMaxCaseEdges = 15;   // five triangles
+
+struct McCase {
+    int         count = 0;                 // edge indices, three per triangle
+    std::int8_t edges[kMaxCaseEdges] = {};
+};
+
+int edge_between(int c0, int c1) {
+    int a = std::countr_zero(static_cast<unsigned>(c0 ^ c1));
+    int low = std::min(c0, c1);
+    int b = (a + 1) % 3, c = (a + 2) % 3;
+    if (b > c) std::swap(b, c);
+    return a * 4 + ((low >> b) & 1) + (((low >> c) & 1) << 1);
+}
+
+int edge_low_corner(int e) {
+    int a = e / 4, k = e % 4;
+    int b = (a + 1) % 3, c = (a + 2) % 3;
+    if (b > c) std::swap(b, c);
+    return ((k & 1) << b) | (((k >> 1) & 1) << c);
+}
+
+// Builds the 256 cases instead of transcribing the classic table. On each
+// face, every run of inside corners (in counter-clockwise order seen from
+// outside the cube) gives one segment from the edge where the walk enters
+// the run to the edge where it leaves. A face with two diagonal inside
+// corners thus keeps them apart, and since that choice depends only on the
+// face's own corners, neighbouring cubes agree and the surface is closed.
+// Each crossed edge ends one segment and starts another, so the segments
+// chain into loops, which are fanned into triangles.
+std::array<McCase, 256> build_case_table() {
+    std::array<McCase, 256> table{};
+    for (int cube = 1; cube < 255; ++cube) {
+        int next[12];
+        std::fill(std::begin(next), std::end(next), -1);
+
+        for (int a = 0; a < 3; ++a) {
+            for (int side = 0; side < 2; ++side) {
+                int b = (a + 1) % 3, c = (a + 2) % 3;
+                int cyc[4] = {side << a, (side << a) | (1 << b),
+                              (side << a) | (1 << b) | (1 << c), (side << a) | (1 << c)};
+                if (side == 0) std::swap(cyc[1], cyc[3]);   // outward normal is -a
+
+                bool in[4];
+                for (int k = 0; k < 4; ++k) in[k] = (cube >> cyc[k]) & 1;
+                for (int k = 0; k < 4; ++k) {
+                    if (in[k] || !in[(k + 1) % 4]) continue;
+                    int enter = edge_between(cyc[k], cyc[(k + 1) % 4]);
+                    int j = (k + 1) % 4;
+                    while (in[(j + 1) % 4]) j = (j + 1) % 4;
+                    next[enter] = edge_between(cyc[j], cyc[(j + 1) % 4]);
+                }
+            }
+        }
+
+        McCase& mc = table[cube];
+        bool used[12] = {};
+        for (int start = 0; start < 12; ++start) {
+            if (next[start] < 0 || used[start]) continue;
+            int loop[12], len = 0;
+            for (int e = start; !used[e]; e = next[e]) {
+                used[e] = true;
+                loop[len++] = e;
+            }
+            for (int i = 1; i + 1 < len; ++i) {
+                mc.edges[mc.count++] = static_cast<std::int8_t>(loop[0]);
+                mc.edges[mc.count++] = static_cast<std::int8_t>(loop[i]);
+                mc.edges[mc.count++] = static_cast<std::int8_t>(loop[i + 1]);
+            }
+        }
+    }
+    return table;
+}
+
+const std::array<McCase, 256>& case_table() {
+    static const std::array<McCase, 256> table = build_case_table();
+    return table;
+}
+
+// --- Extraction --------------------------------------------------------------
+
+// Marks an index that refers to the slab above (an entry of Slab::foreign)
+constexpr std::uint32_t kForeign = 1u << 31;
+
+struct Slab {
+    std::unordered_map<std::uint64_t, std::uint32_t> owned;   // edge id -> local vertex
+    std::vector<MeshVertex>    vertices;
+    std::vector<std::uint64_t> foreign;    // top-plane edge ids, owned by the slab above
+    std::vector<std::uint32_t> indices;    // local, or kForeign | foreign entry
+};
+
+// Appends the f = +iso surface of f = sign * psi
+void extract_surface(const PsiVolume& vol, float iso, float sign, IsoMesh& out) {
+    const auto&  cases = case_table();
+    const int    res = vol.resolution;
+    const float  voxel = 2.0f * vol.extent / static_cast<float>(res);
+    const float* psi = vol.psi.data();
+
+    auto at = [&](int x, int y, int z) {
+        return psi[(static_cast<std::size_t>(z) * res + y) * res + x];
+    };
+    auto center = [&](int i) { return -vol.extent + (static_cast<float>(i) + 0.5f) * voxel; };
+    // Central differences, one-sided at the faces of the grid
+    auto gradient = [&](int x, int y, int z) {
+        int x0 = std::max(x - 1, 0), x1 = std::min(x + 1, res - 1);
+        int y0 = std::max(y - 1, 0), y1 = std::min(y + 1, res - 1);
+        int z0 = std::max(z - 1, 0), z1 = std::min(z + 1, res - 1);
+        return vec3{(at(x1, y, z) - at(x0, y, z)) / (static_cast<float>(x1 - x0) * voxel),
+                    (at(x, y1, z) - at(x, y0, z)) / (static_cast<float>(y1 - y0) * voxel),
+                    (at(x, y, z1) - at(x, y, z0)) / (static_cast<float>(z1 - z0) * voxel)};
+    };
+
+    const int cells = res - 1;
+    std::vector<Slab> slabs(cells);
+
+    parallel_for(cells, [&](int z) {
+        Slab& slab = slabs[z];
+        for (int y = 0; y < cells; ++y) {
+            for (int x = 0; x < cells; ++x) {
+                float f[8];
+                int   cube = 0;
+                for (int i = 0; i < 8; ++i) {
+                    f[i] = sign * at(x + (i & 1), y + ((i >> 1) & 1), z + ((i >> 2) & 1));
+                    if (f[i] > iso) cube |= 1 << i;
+                }
+                const McCase& mc = cases[cube];
+                for (int k = 0; k < mc.count; ++k) {
+                    int e = mc.edges[k], axis = e / 4;
+                    int c0 = edge_low_corner(e), c1 = c0 | (1 << axis);
+                    int gx = x + (c0 & 1), gy = y + ((c0 >> 1) & 1), gz = z + ((c0 >> 2) & 1);
+                    std::uint64_t id = ((static_cast<std::uint64_t>(gz) * res + gy) * res + gx) * 3 + axis;
+
+                    if (gz == z + 1 && z + 1 < cells) {
+                        slab.indices.push_back(kForeign | static_cast<std::uint32_t>(slab.foreign.size()));
+                        slab.foreign.push_back(id);
+                        continue;
+                    }
+
+                    auto [it, fresh] = slab.owned.try_emplace(id, static_cast<std::uint32_t>(slab.vertices.size()));
+                    if (fresh) {
+                        int   hx = gx + (axis == 0), hy = gy + (axis == 1), hz = gz + (axis == 2);
+                        float t = (iso - f[c0]) / (f[c1] - f[c0]);
+                        vec3  pa = {center(gx), center(gy), center(gz)};
+                        vec3  pb = {center(hx), center(hy), center(hz)};
+                        vec3  ga = gradient(gx, gy, gz), gb = gradient(hx, hy, hz);
+                        slab.vertices.push_back({pa + (pb - pa) * t,
+                                                 normalize(ga + (gb - ga) * t) * -sign});
+                    }
+                    slab.indices.push_back(it->second);
+                }
+            }
+        }
+    });
+
+    // Every edge in a slab's top plane is crossed by the slab above too, so
+    // the foreign lookups below always find their vertex
+    std::vector<std::size_t> vertex_offset(cells + 1), index_offset(cells + 1);
+    vertex_offset[0] = out.vertices.size();
+    index_offset[0] = out.indices.size();
+    for (int z = 0; z < cells; ++z) {
+        vertex_offset[z + 1] = vertex_offset[z] + slabs[z].vertices.size();
+        index_offset[z + 1] = index_offset[z] + slabs[z].indices.size();
+    }
+    out.vertices.resize(vertex_offset[cells]);
+    out.indices.resize(index_offset[cells]);
+
+    parallel_for(cells, [&](int z) {
+        const Slab& slab = slabs[z];
+        std::copy(slab.vertices.begin(), slab.vertices.end(), out.vertices.begin() + vertex_offset[z]);
+        std::uint32_t* dst = out.indices.data() + index_offset[z];
+        for (std::uint32_t i : slab.indices) {
+            std::size_t v;
+            if (i & kForeign) {
+                v = vertex_offset[z + 1] + slabs[z + 1].owned.find(slab.foreign[i & ~kForeign])->second;
+            } else {
+                v = vertex_offset[z] + i;
+            }
+            *dst++ = static_cast<std::uint32_t>(v);
+        }
+    });
+}
+
+} // namespace
+
+IsoMesh extract_iso_mesh(const PsiVolume& vol, float iso) {
+    IsoMesh mesh;
+    mesh.n = vol.n;
+    mesh.l = vol.l;
+    mesh.m = vol.m;
+    mesh.resolution = vol.resolution;
+    mesh.extent = vol.extent;
+    mesh.iso = iso;
+
+    extract_surface(vol, iso, 1.0f, mesh);
+    mesh.positive_vertices = mesh.vertices.size();
+    mesh.positive_triangles = mesh.triangles();
+    extract_surface(vol, iso, -1.0f, mesh);
+    return mesh;
+}
+
+float enclosed_probability_iso(const PsiVolume& vol, float fraction) {
+    std::vector<float> density(vol.psi.size());
+    std::transform(vol.psi.begin(), vol.psi.end(), density.begin(), [](float p) { return p * p; });
+    std::sort(density.begin(), density.end(), std::greater<float>());
+
+    double total = 0.0;
+    for (float d : density) total += d;
+    // Halfway to the next smaller value, so the level does not sit exactly
+    // on the voxels that have it (often many, by symmetry), which would
+    // pinch triangles down to zero area
+    double target = total * fraction, sum = 0.0;
+    for (std::size_t i = 0; i < density.size(); ++i) {
+        sum += density[i];
+        if (sum >= target) {
+            std::size_t j = i + 1;
+            while (j < density.size() && density[j] == density[i]) ++j;
+            float below = (j < density.size()) ? density[j] : 0.0f;
+            return std::sqrt(0.5f * (density[i] + below));
+        }
+    }
+    return 0.0f;
+}
+
+// --- File I/O ----------------------------------------------------------------
+
+namespace {
+constexpr int kIsoMeshVersion = 1;
+constexpr std::size_t kPlyVertexBytes = 6 * sizeof(float) + 3;
+constexpr std::size_t kPlyFaceBytes   = 1 + 3 * sizeof(std::uint32_t);
+
+std::string ply_header(const IsoMesh& mesh) {
+    char buf[1024];
+    std::snprintf(buf, sizeof(buf),
+                  "ply\n"
+                  "format binary_little_endian 1.0\n"
+                  "comment ElectronOrbitals iso mesh %d\n"
+                  "comment orbital %d %d %d\n"
+                  "comment volume %d %.9g\n"
+                  "comment iso %.9g\n"
+                  "comment positive %zu %zu\n"
+                  "element vertex %zu\n"
+                  "property float x\nproperty float y\nproperty float z\n"
+                  "property float nx\nproperty float ny\nproperty float nz\n"
+                  "property uchar red\nproperty uchar green\nproperty uchar blue\n"
+                  "element face %zu\n"
+                  "property list uchar uint vertex_indices\n"
+                  "end_header\n",
+                  kIsoMeshVersion, mesh.n, mesh.l, mesh.m, mesh.resolution,
+                  static_cast<double>(mesh.extent), static_cast<double>(mesh.iso),
+                  mesh.positive_vertices, mesh.positive_triangles,
+                  mesh.vertices.size(), mesh.triangles());
+    return buf;
+}
+
+// Palette end colors: teal for psi > 0, coral for psi < 0
+constexpr std::uint8_t kPositiveColor[3] = {26, 153, 204};
+constexpr std::uint8_t kNegativeColor[3] = {230, 102, 77};
+}
+
+bool write_iso_mesh(const char* path, const IsoMesh& mesh) {
+    std::FILE* f = std::fopen(path, "wb");
+    if (!f) {
+        std::fprintf(stderr, "Cannot open %s for writing\n", path);
+        return false;
+    }
+
+    std::string header = ply_header(mesh);
+    std::vector<std::uint8_t> body(mesh.vertices.size() * kPlyVertexBytes +
+                                   mesh.triangles() * kPlyFaceBytes);
+    std::uint8_t* p = body.data();
+    for (std::size_t i = 0; i < mesh.vertices.size(); ++i) {
+        const MeshVertex& v = mesh.vertices[i];
+        float xyz[6] = {v.pos.x, v.pos.y, v.pos.z, v.normal.x, v.normal.y, v.normal.z};
+        std::memcpy(p, xyz, sizeof(xyz));
+        std::memcpy(p + sizeof(xyz), i < mesh.positive_vertices ? kPositiveColor : kNegativeColor, 3);
+        p += kPlyVertexBytes;
+    }
+    for (std::size_t t = 0; t < mesh.triangles(); ++t) {
+        *p = 3;
+        std::memcpy(p + 1, &mesh.indices[t * 3], 3 * sizeof(std::uint32_t));
+        p += kPlyFaceBytes;
+    }
+
+    bool ok = std::fwrite(header.data(), 1, header.size(), f) == header.size() &&
+              std::fwrite(body.data(), 1, body.size(), f) == body.size();
+    std::fclose(f);
+    if (!ok) std::fprintf(stderr, "Failed writing %s\n", path);
+    return ok;
+}
+
+bool read_iso_mesh(const char* path, IsoMesh& mesh) {
+    std::FILE* f = std::fopen(path, "rb");
+    if (!f) return false;
+
+    // Parse the fields we write, then require the header to be exactly the
+    // one write_iso_mesh would produce for them
+    std::string header;
+    char line[256];
+    std::size_t vertex_count = 0, face_count = 0;
+    int version = 0;
+    while (std::fgets(line, sizeof(line), f)) {
+        header += line;
+        double extent = 0.0, iso = 0.0;
+        if (std::sscanf(line, "comment ElectronOrbitals iso mesh %d", &version) == 1) continue;
+        if (std::sscanf(line, "comment orbital %d %d %d", &mesh.n, &mesh.l, &mesh.m) == 3) continue;
+        if (std::sscanf(line, "comment volume %d %lf", &mesh.resolution, &extent) == 2) {
+            mesh.extent = static_cast<float>(extent);
+            continue;
+        }
+        if (std::sscanf(line, "comment iso %lf", &iso) == 1) {
+            mesh.iso = static_cast<float>(iso);
+            continue;
+        }
+        if (std::sscanf(line, "comment positive %zu %zu",
+                        &mesh.positive_vertices, &mesh.positive_triangles) == 2) continue;
+        if (std::sscanf(line, "element vertex %zu", &vertex_count) == 1) continue;
+        if (std::sscanf(line, "element face %zu", &face_count) == 1) continue;
+        if (std::strcmp(line, "end_header\n") == 0 || header.size() > 4096) break;
+    }
+
+    // Counts the rest of the file cannot hold are corrupt; checked before
+    // they size anything
+    std::uint64_t left = file_bytes_left(f);
+    bool ok = vertex_count <= left / kPlyVertexBytes &&
+              face_count <= (left - vertex_count * kPlyVertexBytes) / kPlyFaceBytes;
+    if (ok) {
+        mesh.vertices.resize(vertex_count);
+        mesh.indices.resize(face_count * 3);
+        ok = version == kIsoMeshVersion && header == ply_header(mesh);
+    }
+    if (ok) {
+        std::vector<std::uint8_t> body(vertex_count * kPlyVertexBytes + face_count * kPlyFaceBytes);
+        ok = std::fread(body.data(), 1, body.size(), f) == body.size();
+        const std::uint8_t* p = body.data();
+        for (std::size_t i = 0; ok && i < vertex_count; ++i, p += kPlyVertexBytes) {
+            float xyz[6];
+            std::memcpy(xyz, p, sizeof(xyz));
+            mesh.vertices[i] = {{xyz[0], xyz[1], xyz[2]}, {xyz[3], xyz[4], xyz[5]}};
+        }
+        for (std::size_t t = 0; ok && t < face_count; ++t, p += kPlyFaceBytes) {
+            std::memcpy(&mesh.indices[t * 3], p + 1, 3 * sizeof(std::uint32_t));
+            ok = *p == 3 && mesh.indices[t * 3] < vertex_count &&
+                 mesh.indices[t * 3 + 1] < vertex_count && mesh.indices[t * 3 + 2] < vertex_count;
+        }
+    }
+    std::fclose(f);
+    if (!ok) std::fprintf(stderr, "Ignoring unreadable mesh %s\n", path);
+    return ok;
+}
+
+// --- Cache -------------------------------------------------------------------
+
+std::string IsoMeshCache::file_path(const PsiVolume& vol, float iso) const {
+    char name[96];
+    std::snprintf(name, sizeof(name), "mesh_%d_%d_%d_%d_%.9g.ply",
+                  vol.n, vol.l, vol.m, vol.resolution, static_cast<double>(iso));
+    return (std::filesystem::path(dir_) / name).string();
+}
+
+const IsoMesh& IsoMeshCache::get(const PsiVolume& vol, float iso, bool* loaded) {
+    Key key{vol.n, vol.l, vol.m, vol.resolution, std::bit_cast<std::uint32_t>(iso)};
+    if (loaded) *loaded = true;
+    auto it = meshes_.find(key);
+    if (it != meshes_.end()) return *it->second;
+
+    auto mesh = std::make_unique<IsoMesh>();
+    std::string path = dir_.empty() ? std::string() : file_path(vol, iso);
+
+    // A file extracted from a volume of another extent is stale
+    if (path.empty() || !read_iso_mesh(path.c_str(), *mesh) ||
+        mesh->extent != vol.extent || mesh->iso != iso) {
+        *mesh = extract_iso_mesh(vol, iso);
+        if (loaded) *loaded = false;
+        if (!path.empty()) {
+            std::error_code ec;
+            std::filesystem::create_directories(dir_, ec);
+            write_iso_mesh(path.c_str(), *mesh);
+        }
+    }
+    return *meshes_.emplace(key, std::move(mesh)).first->second;
+}
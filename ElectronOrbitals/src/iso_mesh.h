@@ -0,0 +1,74 @@
+#pragma once
+#include "vec3.h"
+#include "psi_volume.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct MeshVertex {
+    vec3 pos;
+    vec3 normal;   // unit, pointing out of the lobe
+};
+
+// The psi = +iso and psi = -iso surfaces of one psi volume. Vertices and
+// triangles of the positive lobes come first; triangles wind
+// counter-clockwise seen from outside the lobe.
+struct IsoMesh {
+    int   n = 0, l = 0, m = 0;
+    int   resolution = 0;       // of the psi volume it came from
+    float extent     = 0.0f;
+    float iso        = 0.0f;
+    std::vector<MeshVertex>    vertices;
+    std::vector<std::uint32_t> indices;    // three per triangle
+    std::size_t positive_vertices  = 0;
+    std::size_t positive_triangles = 0;
+
+    std::size_t triangles() const { return indices.size() / 3; }
+    std::size_t bytes() const {
+        return vertices.size() * sizeof(MeshVertex) + indices.size() * sizeof(std::uint32_t);
+    }
+};
+
+// Marching cubes over the cells between voxel centers, one z slab per work
+// item. Each slab welds its vertices through a hash of global edge ids and
+// owns every edge except those in its top plane, which it looks up in the
+// slab above once all slabs are done. Normals are the interpolated central
+// difference gradient.
+IsoMesh extract_iso_mesh(const PsiVolume& vol, float iso);
+
+// |psi| level whose lobes hold the given fraction of the probability in
+// the volume; 0.9 is the usual textbook surface.
+float enclosed_probability_iso(const PsiVolume& vol, float fraction);
+
+// Binary little-endian PLY (x y z nx ny nz red green blue per vertex,
+// positive lobes teal and negative coral, like the palette). Orbital and
+// iso level ride in comment lines, so read_iso_mesh only accepts files
+// written by write_iso_mesh.
+bool write_iso_mesh(const char* path, const IsoMesh& mesh);
+bool read_iso_mesh(const char* path, IsoMesh& mesh);
+
+// Meshes keyed by (volume, iso), like PsiVolumeCache: get() returns the
+// in-memory copy, else loads <dir>/mesh_<n>_<l>_<m>_<res>_<iso>.ply, else
+// extracts and writes it. An empty dir keeps the cache in memory only.
+class IsoMeshCache {
+public:
+    explicit IsoMeshCache(std::string dir = {}) : dir_(std::move(dir)) {}
+
+    // loaded, if given, reports whether the mesh came from disk
+    const IsoMesh& get(const PsiVolume& vol, float iso, bool* loaded = nullptr);
+
+    std::size_t count() const { return meshes_.size(); }
+
+private:
+    using Key = std::array<std::int64_t, 5>;   // n, l, m, resolution, iso bits
+
+    std::string dir_;
+    std::map<Key, std::unique_ptr<IsoMesh>> meshes_;
+
+    std::string file_path(const PsiVolume& vol, float iso) const;
+};
@@ -5,6 +5,13 @@
 #include "camera.h"
 #include "orbital.h"
 #include "renderer.h"
+#include "cpu_renderer.h"
+#include "image_io.h"
+#include "psi_volume.h"
+#include "superposition.h"
+#include "orbital_lut.h"
+#include "occupancy_grid.h"
+#include <chrono>
 #include <cstdlib>
 #include <cstdio>
 #include <cmath>
@@ -17,6 +24,9 @@ constexpr int   kInitialWidth  = 1920;
 constexpr int   kInitialHeight = 1080;
 constexpr float kMaxFrameDt    = 0.1f;
 constexpr float kTextScale     = 2.0f;
+constexpr int   kVolumeResolution = 128;   // psi grid voxels per axis (8 MB per orbital)
+constexpr int   kOccupancyResolution = 32; // empty-space skipping cells per axis
+constexpr float kMarchBudgetMs = 10.0f;    // ray march GPU time target (60 Hz with room for post)
 
 // --- Application state -------------------------------------------------------
 
@@ -35,6 +45,24 @@ struct AppState {
     float anim_speed     = 1.0f;
     float anim_time      = 0.0f;
     bool  paused         = false;
+    bool  capture_requested = false;   // C: compare GPU frame against CPU reference
+    bool  use_volume     = false;      // V: sample cached psi grids instead of evaluating
+    bool  use_lut        = false;      // L: sample radial / angular tables instead of evaluating
+    bool  skip_empty     = true;       // E: empty-space skipping
+    bool  adaptive_steps = false;      // D: step sizes from the grid's density bounds
+    bool  progressive    = false;      // P: accumulate jittered low-step frames
+    bool  dynamic_resolution = true;   // T: scale the ray march to kMarchBudgetMs
+    ResolutionScaler scaler{kMarchBudgetMs};
+    float march_ms       = 0.0f;       // latest timer query result
+    int   pinned_index   = -1;         // O: >= 0 shows (pinned + selected) / sqrt 2
+
+    // Superposition of pinned_index and orbital_index, rebuilt when either changes
+    Superposition superposition;
+    int           superposition_pair[2] = {-1, -1};
+
+    PsiVolumeCache volumes{"orbital_cache"};
+    OccupancyGrid  occupancy[OrbitalCatalog::kMaxOrbitals];   // built on first use
+    OrbitalLut     luts[OrbitalCatalog::kMaxOrbitals];        // built on first use
 
     // Mouse state
     bool   left_dragging  = false;
@@ -42,14 +70,113 @@ struct AppState {
     double last_mx = 0, last_my = 0;
 };
 
+// Loads (or builds and saves) the psi grids of the n <= 4 orbitals and
+// uploads them, so that switching between those in volume mode is only a
+// lookup. All 140 at 128^3 would take over a gigabyte; the rest load on
+// first use.
+static void warm_volume_cache(AppState& app) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < app.catalog.count; ++i) {
+        const auto& orb = app.catalog.orbitals[i];
+        if (orb.n <= kSpecializedMaxN)
+            app.renderer.set_psi_volume(&app.volumes.get(orb, kVolumeResolution));
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::printf("psi volumes: %zu x %d^3 ready in %.2f s (%.0f MB)\n",
+                app.volumes.count(), kVolumeResolution, secs,
+                static_cast<double>(app.volumes.memory_bytes()) / (1024.0 * 1024.0));
+}
+
+static const PsiVolume* current_volume(AppState& app, const OrbitalInfo& orb) {
+    return app.use_volume ? &app.volumes.get(orb, kVolumeResolution) : nullptr;
+}
+
+static const OrbitalLut* current_lut(AppState& app) {
+    if (!app.use_lut) return nullptr;
+    OrbitalLut& lut = app.luts[app.orbital_index];
+    if (lut.radial_size == 0) lut = build_orbital_lut(app.catalog.orbitals[app.orbital_index]);
+    return &lut;
+}
+
+static const OccupancyGrid* current_occupancy(AppState& app) {
+    if (!app.skip_empty && !app.adaptive_steps) return nullptr;
+    OccupancyGrid& grid = app.occupancy[app.orbital_index];
+    if (grid.resolution == 0)
+        grid = build_occupancy_grid(app.catalog.orbitals[app.orbital_index], kOccupancyResolution);
+    return &grid;
+}
+
+// The pinned and the selected orbital in equal parts, from their psi grids
+// at kVolumeResolution; nullptr when nothing is pinned
+static const Superposition* current_superposition(AppState& app) {
+    if (app.pinned_index < 0) return nullptr;
+    if (app.superposition_pair[0] != app.pinned_index ||
+        app.superposition_pair[1] != app.orbital_index) {
+        auto t0 = std::chrono::steady_clock::now();
+        app.superposition.clear();
+        app.superposition.add(app.catalog.orbitals[app.pinned_index], 1.0f);
+        if (app.orbital_index != app.pinned_index)
+            app.superposition.add(app.catalog.orbitals[app.orbital_index], 1.0f);
+        app.superposition.build(app.volumes, kVolumeResolution);
+        app.superposition_pair[0] = app.pinned_index;
+        app.superposition_pair[1] = app.orbital_index;
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        std::printf("superposition basis %d^3 x %d ready in %.2f s\n",
+                    kVolumeResolution, app.superposition.count(), secs);
+    }
+    return &app.superposition;
+}
+
+// Bounding radius of what is on screen
+static float view_radius(const AppState& app) {
+    float r = app.catalog.orbitals[app.orbital_index].bounding_radius;
+    if (app.pinned_index >= 0)
+        r = std::max(r, app.catalog.orbitals[app.pinned_index].bounding_radius);
+    return r;
+}
+
 static void switch_orbital(AppState& app, int new_index) {
     if (new_index < 0) new_index = app.catalog.count - 1;
     if (new_index >= app.catalog.count) new_index = 0;
     app.orbital_index = new_index;
 
-    const auto& orb = app.catalog.orbitals[new_index];
-    float default_dist = orb.bounding_radius * 2.5f;
-    app.camera.set_distance_target(default_dist, orb.bounding_radius);
+    float radius = view_radius(app);
+    app.camera.set_distance_target(radius * 2.5f, radius);
+}
+
+// --- CPU reference comparison ----------------------------------------------
+
+// Renders the frame the GPU just produced with the CPU reference renderer,
+// writes both HDR images and prints how far apart they are.
+static void capture_reference(AppState& app, const RaymarchUniforms& ru,
+                              const OrbitalInfo& orb, int fb_w, int fb_h) {
+    HdrImage gpu;
+    app.renderer.read_hdr(gpu);
+
+    CpuRenderer cpu;
+    cpu.resize(fb_w, fb_h);
+    cpu.set_render_scale(app.renderer.render_scale());
+    cpu.set_psi_volume(current_volume(app, orb));
+    cpu.set_orbital_lut(current_lut(app));
+    cpu.set_superposition(current_superposition(app));
+    cpu.set_occupancy(current_occupancy(app));
+    cpu.set_adaptive(app.adaptive_steps);
+    cpu.draw_raymarch(ru);
+
+    char gpu_path[96], cpu_path[96];
+    std::snprintf(gpu_path, sizeof(gpu_path), "%s_gpu.pfm", orb.name);
+    std::snprintf(cpu_path, sizeof(cpu_path), "%s_cpu.pfm", orb.name);
+    write_pfm(gpu_path, gpu);
+    write_pfm(cpu_path, cpu.hdr());
+
+    // The CPU side is one full march, so a progressive GPU image only
+    // matches once it has converged
+    ImageDiff d = compare_images(gpu, cpu.hdr());
+    std::printf("%s: GPU vs CPU  mean abs %.5f  max abs %.5f  PSNR %.1f dB  (%s, %s)",
+                orb.name, d.mean_abs, d.max_abs, d.psnr, gpu_path, cpu_path);
+    if (app.renderer.progressive())
+        std::printf("  GPU progressive, %d frames", app.renderer.progressive_frames());
+    std::printf("\n");
 }
 
 // --- Cycle step counts -------------------------------------------------------
@@ -110,6 +237,37 @@ static void key_callback(GLFWwindow* window, int key, int /*scancode*/,
     case GLFW_KEY_SPACE:
         app->paused = !app->paused;
         break;
+    case GLFW_KEY_C:
+        app->capture_requested = true;
+        break;
+    case GLFW_KEY_G:
+        app->renderer.set_specialized_shaders(!app->renderer.specialized_shaders());
+        break;
+    case GLFW_KEY_E:
+        app->skip_empty = !app->skip_empty;
+        break;
+    case GLFW_KEY_D:
+        app->adaptive_steps = !app->adaptive_steps;
+        break;
+    case GLFW_KEY_P:
+        app->progressive = !app->progressive;
+        break;
+    case GLFW_KEY_T:
+        app->dynamic_resolution = !app->dynamic_resolution;
+        app->scaler.reset();
+        break;
+    case GLFW_KEY_L:
+        app->use_lut = !app->use_lut;
+        break;
+    case GLFW_KEY_O:
+        app->pinned_index = (app->pinned_index < 0) ? app->orbital_index : -1;
+        switch_orbital(*app, app->orbital_index);
+        break;
+    case GLFW_KEY_V:
+        app->use_volume = !app->use_volume;
+        if (app->use_volume && app->volumes.count() < static_cast<std::size_t>(kSpecializedCount))
+            warm_volume_cache(*app);
+        break;
     case GLFW_KEY_R:
         app->density_scale   = 1.0f;
         app->bloom_intensity = 0.5f;
@@ -256,14 +414,33 @@ int main() {
         ru.m              = orb.m;
         ru.radial_norm    = orb.radial_norm;
         ru.angular_norm   = orb.angular_norm;
-        ru.bounding_radius = orb.bounding_radius;
+        ru.bounding_radius = view_radius(app);
         ru.density_scale  = app.density_scale;
         ru.max_steps      = app.max_steps;
         ru.time           = app.anim_time;
         ru.anim_speed     = app.anim_speed;
 
+        app.renderer.set_psi_volume(current_volume(app, orb));
+        app.renderer.set_orbital_lut(current_lut(app));
+        app.renderer.set_superposition(current_superposition(app));
+        app.renderer.set_occupancy(current_occupancy(app));
+        app.renderer.set_adaptive_steps(app.adaptive_steps);
+        app.renderer.set_progressive(app.progressive);
+
+        // Dynamic resolution from the (few frames old) GPU march times
+        float march_ms, march_scale;
+        if (app.renderer.poll_march_time(march_ms, march_scale)) {
+            app.march_ms = march_ms;
+            if (app.dynamic_resolution) app.scaler.update(march_ms, march_scale);
+        }
+        app.renderer.set_render_scale(app.dynamic_resolution ? app.scaler.scale() : 1.0f);
         app.renderer.draw_raymarch(ru);
 
+        if (app.capture_requested) {
+            app.capture_requested = false;
+            capture_reference(app, ru, orb, fb_w, fb_h);
+        }
+
         // --- Pass 2: Bloom ---
         app.renderer.draw_bloom();
 
@@ -280,21 +457,42 @@ int main() {
         float s = kTextScale;
 
         // Orbital label (top-left)
-        app.renderer.draw_text(orb.full_label, 15.0f, 12.0f, s,
-                               0.9f, 0.9f, 0.9f, w, h);
+        if (app.pinned_index >= 0 && app.pinned_index != app.orbital_index) {
+            char label[96];
+            std::snprintf(label, sizeof(label), "(%s + %s) / sqrt 2",
+                          app.catalog.orbitals[app.pinned_index].name, orb.name);
+            app.renderer.draw_text(label, 15.0f, 12.0f, s, 0.9f, 0.9f, 0.9f, w, h);
+        } else {
+            app.renderer.draw_text(orb.full_label, 15.0f, 12.0f, s,
+                                   0.9f, 0.9f, 0.9f, w, h);
+        }
 
         // Parameter readout (bottom-left)
         {
-            char buf[128];
-            std::snprintf(buf, sizeof(buf), "density: %.2f  bloom: %.1f  steps: %d",
-                          app.density_scale, app.bloom_intensity, app.max_steps);
+            char progress[48] = "";
+            if (app.progressive)
+                std::snprintf(progress, sizeof(progress), "  progressive: %d frames",
+                              app.renderer.progressive_frames());
+            char buf[256];
+            std::snprintf(buf, sizeof(buf), "density: %.2f  bloom: %.1f  steps: %d  shader: %s%s%s"
+                          "  march: %.1f ms at %d%%%s",
+                          app.density_scale, app.bloom_intensity, app.max_steps,
+                          app.pinned_index >= 0 ? "superposition"
+                          : app.use_volume ? "volume"
+                          : app.use_lut ? "lookup tables"
+                          : app.renderer.specialized_shaders() ? "per-orbital" : "generic",
+                          app.pinned_index >= 0 ? ""
+                          : app.adaptive_steps ? " + adaptive" : app.skip_empty ? " + skip" : "",
+                          progress, app.march_ms,
+                          static_cast<int>(std::lround(app.renderer.render_scale() * 100.0f)),
+                          app.dynamic_resolution ? " (dynamic)" : "");
             app.renderer.draw_text(buf, 15.0f, static_cast<float>(h) - 55.0f, s,
                                    0.6f, 0.6f, 0.6f, w, h);
         }
 
         // Controls hint (bottom-center)
         {
-            const char* hint = "SPACE: pause  <-/->: orbital  Up/Down: density  B: bloom  S: steps  R: reset";
+            const char* hint = "SPACE: pause  <-/->: orbital  Up/Down: density  B: bloom  S: steps  G: shader  V: volume  L: tables  E: skip  D: adaptive  P: progressive  T: dynamic res  O: superpose  C: CPU compare  R: reset";
             float tw = stb_easy_font_width(const_cast<char*>(hint)) * s;
             app.renderer.draw_text(hint, w * 0.5f - tw * 0.5f,
                                    static_cast<float>(h) - 28.0f, s,
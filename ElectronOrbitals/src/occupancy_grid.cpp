@@ -0,0 +1,69 @@
+#include "occupancy_grid.h"
+#include "wavefunction.h"
+#include "parallel.h"
+
+OccupancyGrid build_occupancy_grid(const OrbitalInfo& orb, int resolution) {
+    OccupancyGrid grid;
+    grid.resolution = std::max(resolution, 1);
+    grid.extent = orb.bounding_radius;
+
+    const int res = grid.resolution;
+    const int pts = res * kOccupancySubsamples + 1;   // lattice points per axis
+    const float spacing = grid.cell_size() / static_cast<float>(kOccupancySubsamples);
+    const PsiRecurrence rc = make_psi_recurrence(orb);
+
+    // |psi|^2 on the lattice; cell faces share their points
+    std::vector<float> lattice(static_cast<std::size_t>(pts) * pts * pts);
+    parallel_for(pts, [&](int z) {
+        float* slice = lattice.data() + static_cast<std::size_t>(z) * pts * pts;
+        for (int y = 0; y < pts; ++y) {
+            for (int x = 0; x < pts; ++x) {
+                vec3 pos = {-grid.extent + static_cast<float>(x) * spacing,
+                            -grid.extent + static_cast<float>(y) * spacing,
+                            -grid.extent + static_cast<float>(z) * spacing};
+                float psi = eval_psi(rc, pos, length(pos));
+                slice[y * pts + x] = psi * psi;
+            }
+        }
+    });
+
+    auto lattice_at = [&](int x, int y, int z) {
+        return lattice[(static_cast<std::size_t>(z) * pts + y) * pts + x];
+    };
+    auto index = [&](int x, int y, int z) {
+        return (static_cast<std::size_t>(z) * res + y) * res + x;
+    };
+
+    // Per-cell max over its lattice points
+    std::vector<float> cell_max(static_cast<std::size_t>(res) * res * res);
+    parallel_for(res, [&](int cz) {
+        for (int cy = 0; cy < res; ++cy) {
+            for (int cx = 0; cx < res; ++cx) {
+                float m = 0.0f;
+                for (int z = 0; z <= kOccupancySubsamples; ++z)
+                    for (int y = 0; y <= kOccupancySubsamples; ++y)
+                        for (int x = 0; x <= kOccupancySubsamples; ++x)
+                            m = std::max(m, lattice_at(cx * kOccupancySubsamples + x,
+                                                       cy * kOccupancySubsamples + y,
+                                                       cz * kOccupancySubsamples + z));
+                cell_max[index(cx, cy, cz)] = m;
+            }
+        }
+    });
+
+    // Dilate by one cell (26-neighbourhood)
+    grid.max_density.assign(cell_max.size(), 0.0f);
+    parallel_for(res, [&](int cz) {
+        for (int cy = 0; cy < res; ++cy) {
+            for (int cx = 0; cx < res; ++cx) {
+                float m = 0.0f;
+                for (int z = std::max(cz - 1, 0); z <= std::min(cz + 1, res - 1); ++z)
+                    for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, res - 1); ++y)
+                        for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, res - 1); ++x)
+                            m = std::max(m, cell_max[index(x, y, z)]);
+                grid.max_density[index(cx, cy, cz)] = m;
+            }
+        }
+    });
+    return grid;
+}
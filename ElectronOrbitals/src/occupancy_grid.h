@@ -0,0 +1,124 @@
+#pragma once
+#include "vec3.h"
+#include "orbital.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Coarse max-|psi|^2 grid over the orbital's bounding cube, used to skip
+// cells whose density cannot add visible opacity. Each cell holds the
+// largest |psi|^2 found on a (kOccupancySubsamples + 1)^3 lattice inside
+// it, dilated by one cell so peaks between lattice points are not lost.
+constexpr int kOccupancySubsamples = 4;
+
+// Upper bound on the opacity a skipped cell may have contributed
+constexpr float kSkipOpacity = 1.0f / 512.0f;
+
+// Tighter bound for the adaptive march: its samples are already spent
+// where the density is, so sampling faint cells costs little
+constexpr float kAdaptiveSkipOpacity = 1.0f / 4096.0f;
+
+struct OccupancyGrid {
+    int   resolution = 0;       // cells per axis
+    float extent     = 0.0f;    // half-size of the cube (the bounding radius)
+    std::vector<float> max_density;   // resolution^3, x fastest; unscaled |psi|^2
+
+    float cell_size() const { return 2.0f * extent / static_cast<float>(resolution); }
+
+    float cell(int x, int y, int z) const {
+        return max_density[(static_cast<std::size_t>(z) * resolution + y) * resolution + x];
+    }
+
+    std::size_t occupied(float threshold) const {
+        return static_cast<std::size_t>(std::count_if(max_density.begin(), max_density.end(),
+                                                       [&](float d) { return d >= threshold; }));
+    }
+};
+
+OccupancyGrid build_occupancy_grid(const OrbitalInfo& orb, int resolution);
+
+// Cells whose max_density is below this are empty at the given density
+// scale: even at the shimmer peak (x1.06) and along the cell diagonal,
+// sample_alpha = density * step * 0.5 sums to less than skip_opacity.
+inline float occupancy_threshold(const OccupancyGrid& grid, float density_scale,
+                                 float skip_opacity = kSkipOpacity) {
+    float diagonal = std::sqrt(3.0f) * grid.cell_size();
+    return skip_opacity / (density_scale * 1.06f * 0.5f * diagonal);
+}
+
+// Adaptive march sample weight for a cell of the given max_density: the
+// square root of its opacity bound per unit length. Weighting by the bound
+// itself (equal opacity per sample) starves the faint outer lobes; the
+// square root still gives dense cells several times finer steps.
+inline float adaptive_weight(float max_density, float density_scale) {
+    return std::sqrt(max_density * density_scale * 1.06f * 0.5f);
+}
+
+// Walks the cells the ray crosses in [t0, t1) (3D DDA) and calls
+// fn(t_begin, t_end, max_density) for each, front to back. fn returns
+// false to stop the walk.
+template <typename Fn>
+void for_each_cell(const OccupancyGrid& grid, vec3 ro, vec3 rd, float t0, float t1, Fn&& fn) {
+    const int   res  = grid.resolution;
+    const float cell = grid.cell_size();
+    const float o[3] = {ro.x, ro.y, ro.z};
+    const float d[3] = {rd.x, rd.y, rd.z};
+
+    int   c[3], step[3];
+    float t_max[3], t_delta[3];
+    for (int a = 0; a < 3; ++a) {
+        float g = (o[a] + d[a] * t0 + grid.extent) / cell;
+        c[a] = std::clamp(static_cast<int>(std::floor(g)), 0, res - 1);
+        if (d[a] > 0.0f) {
+            step[a] = 1;
+            t_max[a] = (static_cast<float>(c[a] + 1) * cell - grid.extent - o[a]) / d[a];
+            t_delta[a] = cell / d[a];
+        } else if (d[a] < 0.0f) {
+            step[a] = -1;
+            t_max[a] = (static_cast<float>(c[a]) * cell - grid.extent - o[a]) / d[a];
+            t_delta[a] = -cell / d[a];
+        } else {
+            step[a] = 0;
+            t_max[a] = INFINITY;
+            t_delta[a] = INFINITY;
+        }
+    }
+
+    float t = t0;
+    while (t < t1) {
+        int   axis = (t_max[0] < t_max[1]) ? (t_max[0] < t_max[2] ? 0 : 2)
+                                           : (t_max[1] < t_max[2] ? 1 : 2);
+        // The last cell before the walk leaves the grid runs to t1
+        int   next = c[axis] + step[axis];
+        bool  last = next < 0 || next >= res;
+        float t_exit = last ? t1 : std::min(t_max[axis], t1);
+
+        if (!fn(t, t_exit, grid.cell(c[0], c[1], c[2])) || last) return;
+
+        t = t_exit;
+        c[axis] = next;
+        t_max[axis] += t_delta[axis];
+    }
+}
+
+// Calls fn(t_begin, t_end) for every maximal run of occupied cells the ray
+// crosses in [t0, t1), front to back. fn returns false to stop the walk.
+template <typename Fn>
+void for_each_occupied_span(const OccupancyGrid& grid, float threshold,
+                            vec3 ro, vec3 rd, float t0, float t1, Fn&& fn) {
+    float span_begin = -1.0f;   // < 0: not inside an occupied run
+    float span_end   = -1.0f;
+    bool  stopped    = false;
+    for_each_cell(grid, ro, rd, t0, t1, [&](float ta, float tb, float max_density) {
+        if (max_density >= threshold) {
+            if (span_begin < 0.0f) span_begin = ta;
+            span_end = tb;
+        } else if (span_begin >= 0.0f) {
+            stopped = !fn(span_begin, ta);
+            span_begin = -1.0f;
+        }
+        return !stopped;
+    });
+    if (span_begin >= 0.0f && !stopped) fn(span_begin, span_end);
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 constexpr float kOrbPi = 3.14159265358979323846f;
 
@@ -45,28 +47,22 @@ inline float compute_angular_norm(int l, int m) {
     return static_cast<float>(norm);
 }
 
-// Bounding radius: roughly proportional to n^2, tuned so density is negligible beyond
-inline float compute_bounding_radius(int n) {
-    // Empirical fit: good enough for visual purposes
-    switch (n) {
-        case 1: return 8.0f;
-        case 2: return 20.0f;
-        case 3: return 38.0f;
-        case 4: return 60.0f;
-        default: return static_cast<float>(n * n * 4);
-    }
-}
+// Bounding radius: the sphere enclosing kBoundingProbability (99%) of
+// |psi|^2, by adaptive cubature over the radial density (orbital_stats.cpp).
+// Depends on n and l only; computed once for the catalog range.
+float compute_bounding_radius(int n, int l);
 
-// Build the full catalog of 30 orbitals (n=1..4)
+// Build the full catalog of 140 orbitals (n=1..7)
 struct OrbitalCatalog {
-    static constexpr int kMaxOrbitals = 30;
+    static constexpr int kMaxN        = 7;
+    static constexpr int kMaxOrbitals = 140;   // sum of n^2 for n = 1..kMaxN
     OrbitalInfo orbitals[kMaxOrbitals];
     int count = 0;
 
     // Spectroscopic subshell letters
     static char subshell_letter(int l) {
-        constexpr char letters[] = "spdf";
-        return (l < 4) ? letters[l] : '?';
+        constexpr char letters[] = "spdfghi";
+        return (l < 7) ? letters[l] : '?';
     }
 
     // Name strings (stored as static buffers)
@@ -102,7 +98,7 @@ struct OrbitalCatalog {
 
     void build() {
         count = 0;
-        for (int n = 1; n <= 4; ++n) {
+        for (int n = 1; n <= kMaxN; ++n) {
             for (int l = 0; l < n; ++l) {
                 for (int m = -l; m <= l; ++m) {
                     auto& o = orbitals[count];
@@ -111,15 +107,22 @@ struct OrbitalCatalog {
                     o.m = m;
                     o.radial_norm    = compute_radial_norm(n, l);
                     o.angular_norm   = compute_angular_norm(l, m);
-                    o.bounding_radius = compute_bounding_radius(n);
+                    o.bounding_radius = compute_bounding_radius(n, l);
+
+                    // Past f there are no Cartesian names; "5g_m-2" etc.
+                    char suffix[16];
+                    if (l <= 3)
+                        std::snprintf(suffix, sizeof(suffix), "%s", m_suffix(l, m));
+                    else
+                        std::snprintf(suffix, sizeof(suffix), "_m%d", m);
 
                     std::snprintf(name_bufs[count], sizeof(name_bufs[count]),
-                                  "%d%c%s", n, subshell_letter(l), m_suffix(l, m));
+                                  "%d%c%s", n, subshell_letter(l), suffix);
                     o.name = name_bufs[count];
 
                     std::snprintf(label_bufs[count], sizeof(label_bufs[count]),
                                   "%d%c%s (n=%d l=%d m=%d)",
-                                  n, subshell_letter(l), m_suffix(l, m), n, l, m);
+                                  n, subshell_letter(l), suffix, n, l, m);
                     o.full_label = label_bufs[count];
 
                     ++count;
@@ -127,4 +130,16 @@ struct OrbitalCatalog {
             }
         }
     }
+
+    // Look up an orbital by name ("2p_z") or by catalog index ("5").
+    // Returns -1 if nothing matches.
+    int find(const char* key) const {
+        for (int i = 0; i < count; ++i)
+            if (std::strcmp(orbitals[i].name, key) == 0) return i;
+        char* end = nullptr;
+        long idx = std::strtol(key, &end, 10);
+        if (end != key && *end == '\0' && idx >= 0 && idx < count)
+            return static_cast<int>(idx);
+        return -1;
+    }
 };
@@ -0,0 +1,111 @@
+#include "orbital_kernels.h"
+#include "wavefunction_simd.h"
+#include "fast_math.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <utility>
+
+// --- Portable specialized packet kernels ------------------------------------
+
+// Same contract as eval_packet_scalar, but with n, l, m baked in. The lane
+// loop is branch-free, so the compiler is free to vectorize it.
+template <int N, int L, int M>
+static void eval_packet_orbital(const PacketParams& p, vec3 ro, vec3 rd, SamplePacket& io) {
+    using Orb = Orbital<N, L, M>;
+    const float norm = p.radial_norm * p.angular_norm;
+
+    for (int i = 0; i < kPacketWidth; ++i) {
+        float t = io.t[i];
+        float x = ro.x + rd.x * t;
+        float y = ro.y + rd.y * t;
+        float z = ro.z + rd.z * t;
+        float d2 = x * x + y * y + z * z;
+        float r = std::sqrt(d2);
+        bool  valid = r >= 1e-6f;
+        float inv_r = valid ? 1.0f / r : 0.0f;
+
+        float rho = r * Orb::kRhoScale;
+        float psi = norm * fast_exp(-0.5f * rho) * Orb::radial_poly(rho)
+                  * Orb::angular(x * inv_r, y * inv_r, z * inv_r);
+        psi = valid ? psi : 0.0f;
+
+        float density = psi * psi * p.density_scale;
+        density *= 1.0f + 0.06f * fast_sin(p.phase + r * 4.0f + x * 1.7f + y * 2.3f + z * 3.1f);
+
+        io.psi[i] = psi;
+        io.density[i] = density;
+        io.dist_sq[i] = d2;
+    }
+}
+
+template <std::size_t... I>
+static constexpr std::array<PacketKernel, sizeof...(I)> make_kernel_table(std::index_sequence<I...>) {
+    return {{&eval_packet_orbital<specialized_orbital(I).n,
+                                  specialized_orbital(I).l,
+                                  specialized_orbital(I).m>...}};
+}
+
+static constexpr auto kScalarKernels = make_kernel_table(std::make_index_sequence<kSpecializedCount>{});
+
+PacketKernel specialized_scalar_kernel(int index) {
+    return (index >= 0 && index < kSpecializedCount) ? kScalarKernels[index] : nullptr;
+}
+
+// --- GLSL generation ---------------------------------------------------------
+
+// Float literal GLSL will not read as an int
+static std::string glsl_float(double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%#.9g", v);
+    return buf;
+}
+
+std::string orbital_psi_glsl(int n, int l, int m, float radial_norm, float angular_norm) {
+    int k = n - l - 1;
+    double norm = static_cast<double>(radial_norm) * angular_norm;
+
+    // Horner form with the normalization folded into every coefficient
+    std::string poly = glsl_float(norm * laguerre_coefficient(k, 2 * l + 1, k));
+    for (int i = k - 1; i >= 0; --i)
+        poly = glsl_float(norm * laguerre_coefficient(k, 2 * l + 1, i)) + " + rho * (" + poly + ")";
+
+    std::string rho_pow;
+    for (int i = 0; i < l; ++i) rho_pow += "rho * ";
+
+    // Q_l^|m|(w) in powers of w^2, as Orbital<n,l,m>::angular
+    int am = std::abs(m);
+    int parity = (l - am) % 2;
+    int last = (l - am) / 2;
+    std::string legendre = glsl_float(legendre_coefficient(l, am, parity + 2 * last));
+    for (int i = last - 1; i >= 0; --i)
+        legendre = glsl_float(legendre_coefficient(l, am, parity + 2 * i)) + " + w2 * (" + legendre + ")";
+    if (parity) legendre = "w * (" + legendre + ")";
+
+    // Re / Im of (u + iv)^|m| by the multiple-angle recurrence
+    std::string azimuthal;
+    if (am > 0) azimuthal = "    float c1 = u, s1 = v;\n";
+    for (int i = 2; i <= am; ++i) {
+        char line[128];
+        std::snprintf(line, sizeof(line),
+                      "    float c%d = c%d * u - s%d * v, s%d = s%d * u + c%d * v;\n",
+                      i, i - 1, i - 1, i, i - 1, i - 1);
+        azimuthal += line;
+    }
+    std::string phi = (am == 0) ? "" : (m < 0 ? " * s" : " * c") + std::to_string(am);
+
+    char header[96];
+    std::snprintf(header, sizeof(header), "// Generated for n=%d l=%d m=%d\n", n, l, m);
+
+    std::string src = header;
+    src += "float orbital_psi(vec3 pos, float r) {\n";
+    src += "    float rho = r * " + glsl_float(2.0 / n) + ";\n";
+    src += "    vec3 d = pos / r;\n";
+    src += "    float u = d.x, v = d.y, w = d.z, w2 = w * w;\n";
+    src += "    float poly = " + poly + ";\n";
+    src += azimuthal;
+    src += "    float q = " + legendre + ";\n";
+    src += "    return exp(-0.5 * rho) * " + rho_pow + "poly * q" + phi + ";\n";
+    src += "}\n";
+    return src;
+}
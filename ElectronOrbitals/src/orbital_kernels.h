@@ -0,0 +1,157 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <string>
+
+// Compile-time specialized wave-function evaluators.
+//
+// Orbital<n, l, m> expands the Laguerre and associated Legendre
+// polynomials into constant Horner coefficients and unrolls rho^l and the
+// multiple-angle recurrence, so a specialized packet kernel does no
+// per-sample branching on l/m and no recurrence loop. orbital_psi_glsl()
+// emits the same expansion as GLSL for the per-orbital ray march shader.
+
+// Orbitals with n <= kSpecializedMaxN get their own kernels and shaders;
+// anything else falls back to the generic path.
+constexpr int kSpecializedMaxN  = 4;
+constexpr int kSpecializedCount = 30;   // sum of n^2 for n = 1..4
+
+struct QuantumNumbers {
+    int n, l, m;
+};
+
+// Position of (n, l, m) in catalog order (n, then l, then m ascending);
+// -1 if the orbital has no specialization.
+constexpr int specialized_index(int n, int l, int m) {
+    if (n < 1 || n > kSpecializedMaxN || l < 0 || l >= n || m < -l || m > l) return -1;
+    int index = 0;
+    for (int i = 1; i < n; ++i) index += i * i;
+    for (int i = 0; i < l; ++i) index += 2 * i + 1;
+    return index + m + l;
+}
+
+constexpr QuantumNumbers specialized_orbital(int index) {
+    for (int n = 1; n <= kSpecializedMaxN; ++n)
+        for (int l = 0; l < n; ++l)
+            for (int m = -l; m <= l; ++m)
+                if (index-- == 0) return {n, l, m};
+    return {0, 0, 0};
+}
+
+// Coefficient of x^i in L^alpha_k(x) = sum_i (-1)^i C(k + alpha, k - i) x^i / i!
+constexpr double laguerre_coefficient(int k, int alpha, int i) {
+    double c = 1.0;
+    for (int j = 1; j <= k - i; ++j)            // C(k + alpha, k - i)
+        c = c * static_cast<double>(i + alpha + j) / static_cast<double>(j);
+    for (int j = 2; j <= i; ++j)                // / i!
+        c /= static_cast<double>(j);
+    return (i % 2 == 0) ? c : -c;
+}
+
+// Coefficient of w^i in Q_l^m(w) = d^m P_l(w) / dw^m, from
+// P_l(w) = 2^-l sum_k (-1)^k C(l, k) C(2l - 2k, l) w^(l - 2k). Then
+// P_l^m(w) = (1 - w^2)^(m/2) Q_l^m(w), without the Condon-Shortley phase.
+constexpr double binomial(int n, int k) {
+    double c = 1.0;
+    for (int j = 1; j <= k; ++j) c = c * static_cast<double>(n - k + j) / static_cast<double>(j);
+    return c;
+}
+
+constexpr double legendre_coefficient(int l, int m, int i) {
+    int twice_k = l - m - i;
+    if (twice_k < 0 || twice_k % 2 != 0) return 0.0;
+    int k = twice_k / 2;
+    int p = l - 2 * k;                                  // power before d^m/dw^m
+    double c = binomial(l, k) * binomial(2 * l - 2 * k, l);
+    for (int j = 0; j < m; ++j) c *= static_cast<double>(p - j);
+    for (int j = 0; j < l; ++j) c *= 0.5;
+    return (k % 2 == 0) ? c : -c;
+}
+
+// Broadcasts a constant to T; works for float and for GCC/Clang vector
+// types such as __m256, so the templates below serve both kernels.
+template <typename T>
+inline T splat_as(float c) { return T{} + c; }
+
+template <int N, int L, int M>
+struct Orbital {
+    static_assert(N >= 1 && L >= 0 && L < N && M >= -L && M <= L, "invalid quantum numbers");
+
+    static constexpr int   kK        = N - L - 1;
+    static constexpr int   kAlpha    = 2 * L + 1;
+    static constexpr float kRhoScale = 2.0f / static_cast<float>(N);
+    static constexpr int   kAbsM     = M < 0 ? -M : M;
+    static constexpr int   kParity   = (L - kAbsM) % 2;   // Q_l^|m| is odd or even in w
+
+    static constexpr std::array<float, kK + 1> kLaguerre = [] {
+        std::array<float, kK + 1> c{};
+        for (int i = 0; i <= kK; ++i)
+            c[i] = static_cast<float>(laguerre_coefficient(kK, kAlpha, i));
+        return c;
+    }();
+
+    // Q_l^|m| in powers of w^2: coefficient i goes with w^(kParity + 2i)
+    static constexpr std::array<float, (L - kAbsM) / 2 + 1> kLegendre = [] {
+        std::array<float, (L - kAbsM) / 2 + 1> c{};
+        for (int i = 0; i < static_cast<int>(c.size()); ++i)
+            c[i] = static_cast<float>(legendre_coefficient(L, kAbsM, kParity + 2 * i));
+        return c;
+    }();
+
+    // rho^l * L^(2l+1)_(n-l-1)(rho); the caller applies exp(-rho/2) and norms
+    template <typename T>
+    static T radial_poly(T rho) { return rho_pow<L>(rho) * horner<0>(rho); }
+
+    // Unnormalized real Y_lm from the unit direction (u, v, w):
+    // Q_l^|m|(w) times Re (m >= 0) or Im (m < 0) of (u + iv)^|m|
+    template <typename T>
+    static T angular(T u, T v, T w) {
+        T q = legendre_horner<0>(w * w);
+        if constexpr (kParity == 1) q = q * w;
+        return q * azimuthal(u, v);
+    }
+
+private:
+    template <int P, typename T>
+    static T rho_pow(T x) {
+        if constexpr (P == 0) return splat_as<T>(1.0f);
+        else if constexpr (P == 1) return x;
+        else return x * rho_pow<P - 1>(x);
+    }
+
+    template <int I, typename T>
+    static T horner(T x) {
+        if constexpr (I == kK) return splat_as<T>(kLaguerre[I]);
+        else return kLaguerre[I] + x * horner<I + 1>(x);
+    }
+
+    template <int I, typename T>
+    static T legendre_horner(T w2) {
+        constexpr int kLast = static_cast<int>(kLegendre.size()) - 1;
+        if constexpr (I == kLast) return splat_as<T>(kLegendre[I]);
+        else return kLegendre[I] + w2 * legendre_horner<I + 1>(w2);
+    }
+
+    // Multiple-angle recurrence (c + is) <- (c + is)(u + iv), unrolled
+    template <typename T>
+    static T azimuthal(T u, T v) {
+        if constexpr (kAbsM == 0) {
+            return splat_as<T>(1.0f);
+        } else {
+            T c = u, s = v;
+            for (int i = 1; i < kAbsM; ++i) {
+                T cn = c * u - s * v;
+                s = s * u + c * v;
+                c = cn;
+            }
+            if constexpr (M < 0) return s;
+            else return c;
+        }
+    }
+};
+
+// GLSL for `float orbital_psi(vec3 pos, float r)` expanded for one orbital,
+// with both normalization constants folded into the polynomial. Drop-in
+// replacement for the generic radial() * spherical_harmonic() in the ray
+// march shader.
+std::string orbital_psi_glsl(int n, int l, int m, float radial_norm, float angular_norm);
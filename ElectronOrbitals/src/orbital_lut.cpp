@@ -0,0 +1,125 @@
+#include "orbital_lut.h"
+#include "wavefunction.h"
+#include "fast_math.h"
+#include <algorithm>
+#include <cmath>
+
+// --- Sampling ----------------------------------------------------------------
+
+float OrbitalLut::sample_radial(float r) const {
+    float hi = static_cast<float>(radial_size - 1);
+    float f = std::min(r * (hi / r_max), hi);
+    int   i = std::min(static_cast<int>(f), radial_size - 2);
+    float t = f - static_cast<float>(i);
+    return radial[i] + (radial[i + 1] - radial[i]) * t;
+}
+
+// Face and in-face coordinates in [-1, 1] of a direction; ties go to the
+// lower axis, as in the shader
+static int cube_face(vec3 d, float& u, float& v) {
+    float ax = std::fabs(d.x), ay = std::fabs(d.y), az = std::fabs(d.z);
+    if (ax >= ay && ax >= az) {
+        float inv = 1.0f / ax;
+        u = d.y * inv;
+        v = d.z * inv;
+        return d.x < 0.0f ? 1 : 0;
+    }
+    if (ay >= az) {
+        float inv = 1.0f / ay;
+        u = d.x * inv;
+        v = d.z * inv;
+        return d.y < 0.0f ? 3 : 2;
+    }
+    float inv = 1.0f / az;
+    u = d.x * inv;
+    v = d.y * inv;
+    return d.z < 0.0f ? 5 : 4;
+}
+
+float OrbitalLut::sample_angular(vec3 dir) const {
+    float u, v;
+    int   face = cube_face(dir, u, v);
+    float hi = static_cast<float>(face_size - 1);
+    float half = 0.5f * hi;
+    float fu = std::clamp(u * half + half, 0.0f, hi);
+    float fv = std::clamp(v * half + half, 0.0f, hi);
+    int   iu = std::min(static_cast<int>(fu), face_size - 2);
+    int   iv = std::min(static_cast<int>(fv), face_size - 2);
+    float tu = fu - static_cast<float>(iu);
+    float tv = fv - static_cast<float>(iv);
+
+    const float* c = angular.data() +
+                     (static_cast<std::size_t>(face) * face_size + iv) * face_size + iu;
+    float c0 = c[0]         + (c[1]             - c[0])         * tu;
+    float c1 = c[face_size] + (c[face_size + 1] - c[face_size]) * tu;
+    return c0 + (c1 - c0) * tv;
+}
+
+void eval_packet_lut(const OrbitalLut& lut, const PacketParams& p, vec3 ro, vec3 rd,
+                     SamplePacket& io) {
+    for (int i = 0; i < kPacketWidth; ++i) {
+        vec3  pos = ro + rd * io.t[i];
+        float d2 = dot(pos, pos);
+        float r = std::sqrt(d2);
+
+        float psi = lut.sample(pos, r);
+        float density = psi * psi * p.density_scale;
+        density *= 1.0f + 0.06f * fast_sin(p.phase + r * 4.0f
+                                           + dot(pos, vec3{1.7f, 2.3f, 3.1f}));
+        io.psi[i] = psi;
+        io.density[i] = density;
+        io.dist_sq[i] = d2;
+    }
+}
+
+// --- Building ----------------------------------------------------------------
+
+OrbitalLut build_orbital_lut(const OrbitalInfo& orb, int radial_size, int face_size) {
+    OrbitalLut lut;
+    lut.n = orb.n;
+    lut.l = orb.l;
+    lut.m = orb.m;
+    lut.r_max = orb.bounding_radius;
+    lut.radial_size = std::max(radial_size, 2);
+    lut.face_size = std::max(face_size, 2);
+
+    const PsiRecurrence rc = make_psi_recurrence(orb);
+
+    // Radial factor, with the whole normalization
+    lut.radial.resize(lut.radial_size);
+    for (int i = 0; i < lut.radial_size; ++i) {
+        float r = lut.r_max * static_cast<float>(i) / static_cast<float>(lut.radial_size - 1);
+        float rho = 2.0f * r / static_cast<float>(rc.n);
+        lut.radial[i] = rc.norm * std::exp(-rho * 0.5f) * fast_ipow(rho, rc.l) *
+                        laguerre_recurrence(rc, rho);
+    }
+
+    // Angular factor at each face point's direction
+    const int fs = lut.face_size;
+    lut.angular.resize(static_cast<std::size_t>(6) * fs * fs);
+    for (int face = 0; face < 6; ++face) {
+        int   axis = face / 2;
+        float sign = (face & 1) ? -1.0f : 1.0f;
+        for (int iv = 0; iv < fs; ++iv) {
+            for (int iu = 0; iu < fs; ++iu) {
+                float u = -1.0f + 2.0f * static_cast<float>(iu) / static_cast<float>(fs - 1);
+                float v = -1.0f + 2.0f * static_cast<float>(iv) / static_cast<float>(fs - 1);
+                vec3 d = (axis == 0) ? vec3{sign, u, v}
+                       : (axis == 1) ? vec3{u, sign, v}
+                                     : vec3{u, v, sign};
+                d = normalize(d);
+
+                // Y from the same recurrences as eval_psi(), without the norm
+                float c = 1.0f, s = 0.0f;
+                for (int k = 0; k < (rc.m < 0 ? -rc.m : rc.m); ++k) {
+                    float cn = c * d.x - s * d.y;
+                    s = s * d.x + c * d.y;
+                    c = cn;
+                }
+                float Y = legendre_recurrence(rc, d.z) * ((rc.m < 0) ? s : c);
+                lut.angular[(static_cast<std::size_t>(face) * fs + iv) * fs + iu] = Y;
+            }
+        }
+    }
+    return lut;
+}
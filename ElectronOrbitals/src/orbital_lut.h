@@ -0,0 +1,54 @@
+#pragma once
+#include "vec3.h"
+#include "orbital.h"
+#include "wavefunction_simd.h"
+#include <cstddef>
+#include <vector>
+
+// Separable lookup tables: psi = R_nl(r) * Y_lm(direction), so an orbital
+// fits in a 1D radial table and a table over directions, about 100 KB
+// instead of the 8 MB of a 128^3 PsiVolume. A sample is two filtered
+// lookups in place of the Laguerre and Legendre recurrences, exp and rho^l.
+//
+// The radial table holds norm * exp(-rho/2) rho^l L(rho) at
+// kLutRadialSize points from r = 0 to r_max inclusive. The angular table
+// is a cube: six faces of kLutFaceSize^2 points, face 2a + (sign < 0) for
+// major axis a, addressed by the other two coordinates (in x, y, z order)
+// divided by the major one. Both tables put their first and last texels on
+// the ends of the range (the face edges), so neighbouring faces store the
+// same values along a shared edge and bilinear filtering never clamps: the
+// lookup is continuous everywhere. The GPU keeps the faces in a 2D array
+// texture and picks the face itself (kRaymarchLutPsiFS), which the CPU
+// sample() reproduces.
+constexpr int kLutRadialSize = 1024;
+constexpr int kLutFaceSize   = 64;
+
+struct OrbitalLut {
+    int   n = 0, l = 0, m = 0;
+    float r_max       = 0.0f;   // radial table range (the bounding radius)
+    int   radial_size = 0;
+    int   face_size   = 0;
+    std::vector<float> radial;    // radial_size
+    std::vector<float> angular;   // 6 * face_size^2, face-major, then v, then u
+
+    // Linear in r, clamped to r_max
+    float sample_radial(float r) const;
+
+    // Bilinear on the face the direction points at; dir need not be unit
+    float sample_angular(vec3 dir) const;
+
+    float sample(vec3 pos, float r) const {
+        return (r < 1e-10f) ? 0.0f : sample_radial(r) * sample_angular(pos);
+    }
+
+    std::size_t bytes() const { return (radial.size() + angular.size()) * sizeof(float); }
+};
+
+// Evaluates the tables from the psi recurrences (wavefunction.h)
+OrbitalLut build_orbital_lut(const OrbitalInfo& orb, int radial_size = kLutRadialSize,
+                             int face_size = kLutFaceSize);
+
+// Same contract as the analytic packet kernels, with psi from the tables;
+// the shimmer term is still applied per sample.
+void eval_packet_lut(const OrbitalLut& lut, const PacketParams& p, vec3 ro, vec3 rd,
+                     SamplePacket& io);
@@ -0,0 +1,304 @@
+#include "orbital_stats.h"
+#include "parallel.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <queue>
+
+// --- Gauss-Kronrod rule ------------------------------------------------------
+
+// 15-point Kronrod abscissae on [-1, 1] (QUADPACK qk15); the odd ones
+// (and 0) are the 7-point Gauss abscissae
+static constexpr double kXgk[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.0};
+static constexpr double kWgk[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714};
+static constexpr double kWg[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327};
+
+// The rule as 15 points with both weight sets (Gauss weight 0 off its points)
+struct Rule15 {
+    double x[15], wk[15], wg[15];
+    constexpr Rule15() : x(), wk(), wg() {
+        for (int j = 0; j < 7; ++j) {
+            x[j] = -kXgk[j];
+            x[14 - j] = kXgk[j];
+            wk[j] = wk[14 - j] = kWgk[j];
+            wg[j] = wg[14 - j] = (j & 1) ? kWg[j / 2] : 0.0;
+        }
+        x[7] = 0.0;
+        wk[7] = kWgk[7];
+        wg[7] = kWg[3];
+    }
+};
+static constexpr Rule15 kRule;
+
+struct Interval {
+    double a, b, value, error;
+    bool operator<(const Interval& o) const { return error < o.error; }
+};
+
+template <typename Fn>
+static Interval gauss_kronrod(Fn& f, double a, double b, int& evals) {
+    double c = 0.5 * (a + b), h = 0.5 * (b - a);
+    double k = 0.0, g = 0.0;
+    for (int j = 0; j < 15; ++j) {
+        double fx = f(c + h * kRule.x[j]);
+        k += kRule.wk[j] * fx;
+        g += kRule.wg[j] * fx;
+    }
+    evals += 15;
+    return {a, b, k * h, std::fabs(k - g) * h};
+}
+
+// Adaptive integration over the partition `breaks` (sorted). Returns the
+// final intervals sorted by a, so callers can build a cumulative integral.
+template <typename Fn>
+static std::vector<Interval> integrate_adaptive(Fn&& f, const std::vector<double>& breaks,
+                                                double tolerance, int& evals) {
+    std::priority_queue<Interval> worst;
+    double total = 0.0, error = 0.0;
+    for (std::size_t i = 0; i + 1 < breaks.size(); ++i) {
+        Interval iv = gauss_kronrod(f, breaks[i], breaks[i + 1], evals);
+        total += iv.value;
+        error += iv.error;
+        worst.push(iv);
+    }
+
+    constexpr int kMaxIntervals = 4096;
+    while (error > tolerance * std::max(1.0, std::fabs(total)) &&
+           static_cast<int>(worst.size()) < kMaxIntervals) {
+        Interval iv = worst.top();
+        worst.pop();
+        double mid = 0.5 * (iv.a + iv.b);
+        Interval lo = gauss_kronrod(f, iv.a, mid, evals);
+        Interval hi = gauss_kronrod(f, mid, iv.b, evals);
+        total += lo.value + hi.value - iv.value;
+        error += lo.error + hi.error - iv.error;
+        worst.push(lo);
+        worst.push(hi);
+    }
+
+    std::vector<Interval> out;
+    out.reserve(worst.size());
+    for (; !worst.empty(); worst.pop()) out.push_back(worst.top());
+    std::sort(out.begin(), out.end(),
+              [](const Interval& x, const Interval& y) { return x.a < y.a; });
+    return out;
+}
+
+// --- Radial and angular factors ----------------------------------------------
+
+// L^(2l+1)_(n-l-1)(rho), same recurrence as laguerre_recurrence() in double
+static double laguerre(int n, int l, double rho) {
+    int alpha = 2 * l + 1;
+    double L0 = 0.0, L1 = 1.0;
+    for (int i = 0; i < n - l - 1; ++i) {
+        double L2 = ((2 * i + 1 + alpha - rho) * L1 - (i + alpha) * L0) / (i + 1);
+        L0 = L1;
+        L1 = L2;
+    }
+    return L1;
+}
+
+// r^2 R(r)^2 up to the normalization constant
+static double radial_density(int n, int l, double r) {
+    double rho = 2.0 * r / n;
+    double R = std::exp(-0.5 * rho) * std::pow(rho, l) * laguerre(n, l, rho);
+    return r * r * R * R;
+}
+
+// P_l^|m|(w) without the Condon-Shortley phase, like the renderer
+static double legendre(int l, int am, double w) {
+    double s = std::sqrt(std::max(0.0, 1.0 - w * w));
+    double P0 = 0.0, P1 = 1.0;
+    for (int i = 1; i <= am; ++i) P1 *= (2 * i - 1) * s;
+    for (int j = am + 1; j <= l; ++j) {
+        double P2 = ((2 * j - 1) * w * P1 - (j + am - 1) * P0) / (j - am);
+        P0 = P1;
+        P1 = P2;
+    }
+    return P1;
+}
+
+// Radial node radii: sign changes of the Laguerre factor, bisected. All of
+// its roots lie below rho = 4n. Stores at most `capacity`.
+static int radial_nodes(int n, int l, double* nodes, int capacity) {
+    constexpr int kScan = 4096;
+    const double rho_max = 4.0 * n + 8.0;
+    int count = 0;
+    double a = 0.0, fa = laguerre(n, l, 0.0);
+    for (int i = 1; i <= kScan && count < std::min(n - l - 1, capacity); ++i) {
+        double b = rho_max * i / kScan, fb = laguerre(n, l, b);
+        if ((fa < 0.0) != (fb < 0.0)) {
+            double lo = a, hi = b;
+            for (int it = 0; it < 60; ++it) {
+                double mid = 0.5 * (lo + hi);
+                if ((laguerre(n, l, mid) < 0.0) == (fa < 0.0)) lo = mid; else hi = mid;
+            }
+            nodes[count++] = 0.5 * (lo + hi) * n * 0.5;
+        }
+        a = b;
+        fa = fb;
+    }
+    return count;
+}
+
+// Integration partition: 0, the nodes, then out to rho = 150 where
+// exp(-rho) has buried every polynomial factor
+static std::vector<double> radial_breaks(int n, const double* nodes, int node_count) {
+    std::vector<double> breaks{0.0};
+    for (int i = 0; i < node_count; ++i) breaks.push_back(nodes[i]);
+    double r_far = 75.0 * n;
+    double r = std::max(breaks.back(), 1.0 * n * n);
+    if (r > breaks.back()) breaks.push_back(r);
+    while ((r *= 2.0) < r_far) breaks.push_back(r);
+    breaks.push_back(r_far);
+    return breaks;
+}
+
+// Radius where the cumulative radial integral reaches `target`, by
+// bisection inside the adaptive interval that crosses it
+static double cumulative_radius(int n, int l, const std::vector<Interval>& parts,
+                                double target, int& evals) {
+    auto f = [&](double r) { return radial_density(n, l, r); };
+    double below = 0.0;
+    for (const auto& iv : parts) {
+        if (below + iv.value < target) {
+            below += iv.value;
+            continue;
+        }
+        double lo = iv.a, hi = iv.b;
+        for (int it = 0; it < 48; ++it) {
+            double mid = 0.5 * (lo + hi);
+            if (below + gauss_kronrod(f, iv.a, mid, evals).value < target) lo = mid; else hi = mid;
+        }
+        return 0.5 * (lo + hi);
+    }
+    return parts.empty() ? 0.0 : parts.back().b;
+}
+
+// --- Stats -------------------------------------------------------------------
+
+double enclosed_radius(int n, int l, double probability) {
+    double nodes[OrbitalCatalog::kMaxN];
+    int    node_count = radial_nodes(n, l, nodes, OrbitalCatalog::kMaxN);
+    int    evals = 0;
+    auto parts = integrate_adaptive([&](double r) { return radial_density(n, l, r); },
+                                    radial_breaks(n, nodes, node_count), 1e-10, evals);
+    double total = 0.0;
+    for (const auto& iv : parts) total += iv.value;
+    return cumulative_radius(n, l, parts, probability * total, evals);
+}
+
+OrbitalStats compute_orbital_stats(const OrbitalInfo& orb, double tolerance) {
+    OrbitalStats s;
+    const int n = orb.n, l = orb.l, am = std::abs(orb.m);
+    s.node_count = radial_nodes(n, l, s.nodes, OrbitalCatalog::kMaxN);
+    auto breaks = radial_breaks(n, s.nodes, s.node_count);
+
+    // Radial moments 0, 1, 2 of r^2 R^2 with the catalog's N_nl
+    const double rn2 = static_cast<double>(orb.radial_norm) * orb.radial_norm;
+    double moment[3];
+    std::vector<Interval> parts;
+    for (int k = 0; k < 3; ++k) {
+        auto p = integrate_adaptive([&](double r) { return rn2 * radial_density(n, l, r) * std::pow(r, k); },
+                                    breaks, tolerance, s.evaluations);
+        moment[k] = 0.0;
+        for (const auto& iv : p) {
+            moment[k] += iv.value;
+            s.error += iv.error;
+        }
+        if (k == 0) parts = std::move(p);
+    }
+    s.mean_r  = moment[1] / moment[0];
+    s.mean_r2 = moment[2] / moment[0];
+    for (auto& iv : parts) iv.value /= rn2;   // cumulative_radius integrates the unscaled density
+    s.r_enclosed = cumulative_radius(n, l, parts, kBoundingProbability * moment[0] / rn2,
+                                     s.evaluations);
+
+    // Angular: Y^2 over (w = cos theta, phi) rectangles, adaptive on the
+    // tensor-product rule; splits halve the longer side in units of the domain
+    const double an2 = static_cast<double>(orb.angular_norm) * orb.angular_norm;
+    auto y2 = [&](double w, double phi) {
+        double P = legendre(l, am, w);
+        double t = (orb.m < 0) ? std::sin(am * phi) : std::cos(am * phi);
+        return an2 * P * P * t * t;
+    };
+    struct Rect {
+        double w0, w1, p0, p1, value, error;
+        bool operator<(const Rect& o) const { return error < o.error; }
+    };
+    auto rule2d = [&](double w0, double w1, double p0, double p1) {
+        double cw = 0.5 * (w0 + w1), hw = 0.5 * (w1 - w0);
+        double cp = 0.5 * (p0 + p1), hp = 0.5 * (p1 - p0);
+        double k = 0.0, g = 0.0;
+        for (int i = 0; i < 15; ++i) {
+            double w = cw + hw * kRule.x[i];
+            for (int j = 0; j < 15; ++j) {
+                double fx = y2(w, cp + hp * kRule.x[j]);
+                k += kRule.wk[i] * kRule.wk[j] * fx;
+                g += kRule.wg[i] * kRule.wg[j] * fx;
+            }
+        }
+        s.evaluations += 225;
+        return Rect{w0, w1, p0, p1, k * hw * hp, std::fabs(k - g) * hw * hp};
+    };
+    constexpr double kTwoPi = 6.283185307179586476925286766559;
+    std::priority_queue<Rect> worst;
+    worst.push(rule2d(-1.0, 1.0, 0.0, kTwoPi));
+    double angular = worst.top().value, angular_error = worst.top().error;
+    while (angular_error > tolerance * std::max(1.0, angular) && worst.size() < 1024) {
+        Rect r = worst.top();
+        worst.pop();
+        Rect a, b;
+        if ((r.w1 - r.w0) / 2.0 >= (r.p1 - r.p0) / kTwoPi) {
+            double mid = 0.5 * (r.w0 + r.w1);
+            a = rule2d(r.w0, mid, r.p0, r.p1);
+            b = rule2d(mid, r.w1, r.p0, r.p1);
+        } else {
+            double mid = 0.5 * (r.p0 + r.p1);
+            a = rule2d(r.w0, r.w1, r.p0, mid);
+            b = rule2d(r.w0, r.w1, mid, r.p1);
+        }
+        angular += a.value + b.value - r.value;
+        angular_error += a.error + b.error - r.error;
+        worst.push(a);
+        worst.push(b);
+    }
+
+    s.norm = moment[0] * angular;
+    s.error += angular_error;
+    return s;
+}
+
+std::vector<OrbitalStats> compute_catalog_stats(const OrbitalCatalog& catalog, double tolerance) {
+    std::vector<OrbitalStats> stats(catalog.count);
+    parallel_for(catalog.count, [&](int i) {
+        stats[i] = compute_orbital_stats(catalog.orbitals[i], tolerance);
+    });
+    return stats;
+}
+
+// --- Bounding radius ---------------------------------------------------------
+
+float compute_bounding_radius(int n, int l) {
+    constexpr int kN = OrbitalCatalog::kMaxN;
+    static const std::array<float, kN * kN> table = [] {
+        std::array<float, kN * kN> t{};
+        parallel_for(kN * kN, [&](int i) {
+            int tn = i / kN + 1, tl = i % kN;
+            if (tl < tn) t[i] = static_cast<float>(enclosed_radius(tn, tl));
+        });
+        return t;
+    }();
+    if (n >= 1 && n <= kN && l >= 0 && l < n) return table[(n - 1) * kN + l];
+    return static_cast<float>(enclosed_radius(n, l));
+}
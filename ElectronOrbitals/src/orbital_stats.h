@@ -0,0 +1,44 @@
+#pragma once
+#include "orbital.h"
+#include <vector>
+
+// Physical quantities of one orbital by adaptive cubature, in double
+// precision with the catalog's normalization constants:
+//
+//   norm      integral of |psi|^2 over space, radial times angular (should be 1)
+//   <r>, <r^2> radial expectation values (exact: (3n^2 - l(l+1)) / 2 and
+//             n^2 (5n^2 + 1 - 3l(l+1)) / 2)
+//   nodes     radii of the n - l - 1 radial nodes (roots of the Laguerre factor)
+//   r_enclosed radius of the sphere holding kBoundingProbability of |psi|^2
+//
+// The radial integrals use adaptive Gauss-Kronrod (7 / 15 points): the
+// interval with the largest error estimate is halved until the total
+// estimate is below the tolerance, starting from a partition at the radial
+// nodes. The angular integral of Y^2 runs the tensor-product rule over
+// (cos theta, phi) rectangles the same way. psi separates, so these two
+// give the full 3D normalization.
+//
+// r_enclosed replaces a hand-tuned radius as OrbitalInfo::bounding_radius
+// (compute_bounding_radius below): it follows the cloud per (n, l) rather
+// than per n, so the ray march sphere, psi grids and occupancy grids hug it.
+constexpr double kBoundingProbability = 0.99;
+
+struct OrbitalStats {
+    double norm         = 0.0;
+    double mean_r       = 0.0;
+    double mean_r2      = 0.0;
+    double r_enclosed   = 0.0;
+    int    node_count   = 0;
+    double nodes[OrbitalCatalog::kMaxN] = {};
+    double error        = 0.0;   // sum of the cubature error estimates
+    int    evaluations  = 0;     // integrand evaluations, radial and angular
+};
+
+// Radius enclosing `probability` of the (n, l) radial density
+double enclosed_radius(int n, int l, double probability = kBoundingProbability);
+
+OrbitalStats compute_orbital_stats(const OrbitalInfo& orb, double tolerance = 1e-10);
+
+// Every catalog orbital, one work item per orbital across all threads
+std::vector<OrbitalStats> compute_catalog_stats(const OrbitalCatalog& catalog,
+                                                double tolerance = 1e-10);
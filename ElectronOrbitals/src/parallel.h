@@ -0,0 +1,11 @@
+#pragma once
+#include "job_system.h"
+
+// Runs fn(i) for every i in [0, count) on the shared job system and blocks
+// until done. Items are split one by one and stolen as threads free up, so
+// uneven items (tiles that hit the cloud vs. empty sky) balance themselves,
+// and passes that overlap (render and post process) share one pool.
+template <typename Fn>
+void parallel_for(int count, Fn&& fn) {
+    parallel_for(0, count, 1, fn);
+}
@@ -0,0 +1,187 @@
+#include "point_cloud.h"
+#include "wavefunction.h"
+#include "orbital_stats.h"
+#include "image_io.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// --- Sampling ----------------------------------------------------------------
+
+namespace {
+
+// Bins per marginal table. The pdf is taken as constant over a bin, so
+// drawing within a bin is a linear interpolation of its CDF.
+constexpr int kRadialBins = 8192;
+constexpr int kPolarBins  = 4096;
+constexpr int kAzimuthBins = 4096;
+
+// Radial probability left beyond the end of the radial table; points that
+// would fall there are drawn inside it instead
+constexpr double kRadialTail = 1e-9;
+
+// CDF of a 1D density tabulated at bin midpoints over [lo, hi]
+struct InverseCdf {
+    float lo = 0.0f, hi = 0.0f;
+    std::vector<double> cdf;   // bins + 1 edges, cdf.front() = 0, cdf.back() = 1
+
+    template <typename Pdf>
+    void build(float lo_, float hi_, int bins, Pdf&& pdf) {
+        lo = lo_;
+        hi = hi_;
+        cdf.assign(bins + 1, 0.0);
+        double width = static_cast<double>(hi - lo) / bins;
+        for (int i = 0; i < bins; ++i) {
+            double x = lo + (i + 0.5) * width;
+            cdf[i + 1] = cdf[i] + std::max(static_cast<double>(pdf(static_cast<float>(x))), 0.0);
+        }
+        for (double& c : cdf) c /= cdf.back();
+    }
+
+    // Maps u in [0, 1) to a coordinate distributed by the table
+    float sample(double u) const {
+        auto it = std::upper_bound(cdf.begin() + 1, cdf.end() - 1, u);
+        int    i = static_cast<int>(it - cdf.begin()) - 1;
+        double span = cdf[i + 1] - cdf[i];
+        double f = span > 0.0 ? (u - cdf[i]) / span : 0.5;
+        int    bins = static_cast<int>(cdf.size()) - 1;
+        return lo + (hi - lo) * static_cast<float>((i + f) / bins);
+    }
+};
+
+// PCG32 (O'Neill): small state, and independent streams by choosing the
+// increment, so every chunk gets its own sequence from one seed.
+struct Pcg32 {
+    std::uint64_t state = 0, inc = 1;
+
+    Pcg32(std::uint64_t seed, std::uint64_t stream) : inc((stream << 1) | 1u) {
+        next();
+        state += seed;
+        next();
+    }
+
+    std::uint32_t next() {
+        std::uint64_t old = state;
+        state = old * 6364136223846793005ull + inc;
+        auto xorshifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+        auto rot = static_cast<std::uint32_t>(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    // Uniform in [0, 1) with 32 bits of resolution
+    double uniform() { return next() * (1.0 / 4294967296.0); }
+};
+
+} // namespace
+
+PointCloud sample_point_cloud(const OrbitalInfo& orb, std::size_t count, std::uint64_t seed) {
+    PointCloud cloud;
+    cloud.n = orb.n;
+    cloud.l = orb.l;
+    cloud.m = orb.m;
+    cloud.points.resize(count);
+
+    const PsiRecurrence rc = make_psi_recurrence(orb);
+    const int am = std::abs(orb.m);
+
+    // r^2 R(r)^2 out to the radius enclosing all but kRadialTail of it
+    // (about 3x the 1s bounding radius, 2x for n = 7)
+    InverseCdf radial;
+    float r_max = static_cast<float>(enclosed_radius(orb.n, orb.l, 1.0 - kRadialTail));
+    radial.build(0.0f, r_max, kRadialBins, [&](float r) {
+        float rho = 2.0f * r / static_cast<float>(orb.n);
+        float R = std::exp(-0.5f * rho) * fast_ipow(rho, orb.l) * laguerre_recurrence(rc, rho);
+        return r * r * R * R;
+    });
+
+    // (P_l^|m|(w))^2 with w = cos theta; dOmega = dw dphi, so no sin theta
+    InverseCdf polar;
+    polar.build(-1.0f, 1.0f, kPolarBins, [&](float w) {
+        float q = legendre_recurrence(rc, w);
+        return q * q * fast_ipow(1.0f - w * w, am);
+    });
+
+    // cos^2 or sin^2 (|m| phi); uniform for m = 0
+    InverseCdf azimuth;
+    azimuth.build(0.0f, 2.0f * kOrbPi, kAzimuthBins, [&](float phi) {
+        float a = (orb.m < 0) ? std::sin(am * phi) : std::cos(am * phi);
+        return a * a;
+    });
+
+    int chunks = static_cast<int>((count + kPointChunk - 1) / kPointChunk);
+    parallel_for(chunks, [&](int chunk) {
+        Pcg32 rng(seed, static_cast<std::uint64_t>(chunk));
+        std::size_t begin = static_cast<std::size_t>(chunk) * kPointChunk;
+        std::size_t end = std::min(begin + kPointChunk, count);
+        for (std::size_t i = begin; i < end; ++i) {
+            float r   = radial.sample(rng.uniform());
+            float w   = polar.sample(rng.uniform());
+            float phi = azimuth.sample(rng.uniform());
+
+            float sin_theta = std::sqrt(std::max(1.0f - w * w, 0.0f));
+            vec3  pos = {r * sin_theta * std::cos(phi), r * sin_theta * std::sin(phi), r * w};
+            cloud.points[i] = {pos.x, pos.y, pos.z, eval_psi(rc, pos, r)};
+        }
+    });
+    return cloud;
+}
+
+// --- File I/O ----------------------------------------------------------------
+
+namespace {
+struct PointCloudHeader {
+    char          magic[4];     // "PTCL"
+    std::uint32_t version;
+    std::int32_t  n, l, m;
+    std::uint32_t point_size;   // bytes per record: x, y, z, psi as float32
+    std::uint64_t count;
+};
+constexpr std::uint32_t kPointCloudVersion = 1;
+}
+
+bool write_point_cloud(const char* path, const PointCloud& cloud) {
+    std::FILE* f = std::fopen(path, "wb");
+    if (!f) {
+        std::fprintf(stderr, "Cannot open %s for writing\n", path);
+        return false;
+    }
+    PointCloudHeader h{};
+    std::memcpy(h.magic, "PTCL", 4);
+    h.version    = kPointCloudVersion;
+    h.n          = cloud.n;
+    h.l          = cloud.l;
+    h.m          = cloud.m;
+    h.point_size = sizeof(CloudPoint);
+    h.count      = cloud.points.size();
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+              std::fwrite(cloud.points.data(), sizeof(CloudPoint), cloud.points.size(), f) ==
+                  cloud.points.size();
+    std::fclose(f);
+    if (!ok) std::fprintf(stderr, "Failed writing %s\n", path);
+    return ok;
+}
+
+bool read_point_cloud(const char* path, PointCloud& cloud) {
+    std::FILE* f = std::fopen(path, "rb");
+    if (!f) return false;
+
+    PointCloudHeader h{};
+    bool ok = std::fread(&h, sizeof(h), 1, f) == 1 &&
+              std::memcmp(h.magic, "PTCL", 4) == 0 &&
+              h.version == kPointCloudVersion &&
+              h.point_size == sizeof(CloudPoint) &&
+              h.count <= file_bytes_left(f) / sizeof(CloudPoint);
+    if (ok) {
+        cloud.n = h.n;
+        cloud.l = h.l;
+        cloud.m = h.m;
+        cloud.points.resize(h.count);
+        ok = std::fread(cloud.points.data(), sizeof(CloudPoint), cloud.points.size(), f) ==
+             cloud.points.size();
+    }
+    std::fclose(f);
+    if (!ok) std::fprintf(stderr, "Ignoring unreadable point cloud %s\n", path);
+    return ok;
+}
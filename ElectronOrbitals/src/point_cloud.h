@@ -0,0 +1,33 @@
+#pragma once
+#include "orbital.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Electron positions drawn from |psi|^2, with psi at each point kept for
+// coloring by sign. Layout matches the .pts file records.
+struct CloudPoint {
+    float x, y, z;
+    float psi;
+};
+
+struct PointCloud {
+    int n = 0, l = 0, m = 0;
+    std::vector<CloudPoint> points;
+
+    std::size_t bytes() const { return points.size() * sizeof(CloudPoint); }
+};
+
+// Points per work item; each gets its own RNG stream, so a given seed gives
+// the same cloud on any number of cores.
+constexpr std::size_t kPointChunk = 65536;
+
+// Draws count points from |psi_nlm|^2. The density factors into
+// r^2 R(r)^2 * P_l^|m|(cos theta)^2 * cos^2 or sin^2(|m| phi), so each
+// coordinate is drawn independently by inverting a tabulated CDF of its
+// marginal (no rejection), one chunk per work item across all cores.
+PointCloud sample_point_cloud(const OrbitalInfo& orb, std::size_t count, std::uint64_t seed);
+
+// Binary .pts file: small header, then the raw CloudPoint array.
+bool write_point_cloud(const char* path, const PointCloud& cloud);
+bool read_point_cloud(const char* path, PointCloud& cloud);
@@ -0,0 +1,274 @@
+#include "post_process.h"
+#include "parallel.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ORBITALS_POST_SSE 1
+#endif
+
+namespace {
+
+// --- One RGBA pixel as a SIMD vector -----------------------------------------
+
+#ifdef ORBITALS_POST_SSE
+using f4 = __m128;
+inline f4   load4(const float* p)                { return _mm_loadu_ps(p); }
+inline void store4(float* p, f4 v)               { _mm_storeu_ps(p, v); }
+inline f4   splat(float s)                       { return _mm_set1_ps(s); }
+inline f4   set4(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+inline f4   add(f4 a, f4 b)                      { return _mm_add_ps(a, b); }
+inline f4   sub(f4 a, f4 b)                      { return _mm_sub_ps(a, b); }
+inline f4   mul(f4 a, f4 b)                      { return _mm_mul_ps(a, b); }
+inline f4   div(f4 a, f4 b)                      { return _mm_div_ps(a, b); }
+inline f4   clamp01(f4 a)                        { return _mm_min_ps(_mm_max_ps(a, _mm_setzero_ps()), splat(1.0f)); }
+
+// RGB at p with alpha 0, reading one float past the pixel unless that
+// would leave the image
+inline f4 load3(const float* p, const float* end) {
+    if (p + 4 <= end)
+        return _mm_and_ps(_mm_loadu_ps(p), _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+    return _mm_setr_ps(p[0], p[1], p[2], 0.0f);
+}
+#else
+struct f4 { float v[4]; };
+inline f4   load4(const float* p)                { return {{p[0], p[1], p[2], p[3]}}; }
+inline void store4(float* p, f4 a)               { std::memcpy(p, a.v, sizeof(a.v)); }
+inline f4   splat(float s)                       { return {{s, s, s, s}}; }
+inline f4   set4(float a, float b, float c, float d) { return {{a, b, c, d}}; }
+inline f4   add(f4 a, f4 b)                      { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+inline f4   sub(f4 a, f4 b)                      { for (int i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+inline f4   mul(f4 a, f4 b)                      { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+inline f4   div(f4 a, f4 b)                      { for (int i = 0; i < 4; ++i) a.v[i] /= b.v[i]; return a; }
+inline f4   clamp01(f4 a)                        { for (float& x : a.v) x = std::clamp(x, 0.0f, 1.0f); return a; }
+inline f4   load3(const float* p, const float*)  { return {{p[0], p[1], p[2], 0.0f}}; }
+#endif
+
+inline f4 lerp(f4 a, f4 b, float t) { return add(a, mul(sub(b, a), splat(t))); }
+
+inline f4 aces(f4 x) {
+    f4 num = mul(x, add(mul(splat(2.51f), x), splat(0.03f)));
+    f4 den = add(mul(x, add(mul(splat(2.43f), x), splat(0.59f))), splat(0.14f));
+    return clamp01(div(num, den));
+}
+
+// --- Constants ---------------------------------------------------------------
+
+constexpr float kBloomThreshold = 0.8f;   // u_threshold in draw_bloom
+constexpr int   kBand = 16;               // rows per work item
+
+// Blur sigma at quarter resolution, in quarter texels, matched to the GL
+// bloom by variance in full-resolution pixels. GL: 0.25 (bright tap) +
+// 3 x 2.85 half texels^2 = 34.3 (the 9-tap kernel truncates to an actual
+// sigma of 1.69) + 0.67 (bilinear upsample) = 35.2 px^2. Here the bright
+// tap and box downsample give 1.25 and the quarter-to-full upsample 2.67,
+// leaving 16 sigma^2 = 31.3 for the blur.
+constexpr float kQuarterSigma = 1.40f;
+
+std::array<float, 5> blur_weights() {
+    std::array<float, 5> w{};
+    float sum = 0.0f;
+    for (int i = 0; i < 5; ++i) {
+        w[i] = std::exp(-0.5f * static_cast<float>(i * i) / (kQuarterSigma * kQuarterSigma));
+        sum += (i == 0) ? w[i] : 2.0f * w[i];
+    }
+    for (float& x : w) x /= sum;
+    return w;
+}
+
+// round(255 x^(1/2.2)) indexed by the top bits of the float: 10 mantissa
+// bits over [2^-20, 1). A relative step of 2^-10 moves the output by at
+// most 0.12 of a level, so codes differ from the exact pow() by at most
+// one, and only next to a rounding boundary. Below 2^-20 rounds to 0.
+constexpr int           kGammaShift    = 23 - 10;
+constexpr std::uint32_t kGammaLowBits  = (127u - 20u) << 23;   // 2^-20
+constexpr std::uint32_t kGammaEntries  = (20u << 23) >> kGammaShift;
+
+const std::uint8_t* gamma_table() {
+    static const std::vector<std::uint8_t> table = [] {
+        std::vector<std::uint8_t> t(kGammaEntries);
+        for (std::uint32_t i = 0; i < kGammaEntries; ++i) {
+            std::uint32_t bits = kGammaLowBits + (i << kGammaShift) + (1u << (kGammaShift - 1));
+            float x;
+            std::memcpy(&x, &bits, sizeof(x));
+            t[i] = static_cast<std::uint8_t>(std::pow(x, 1.0f / 2.2f) * 255.0f + 0.5f);
+        }
+        return t;
+    }();
+    return table.data();
+}
+
+// x in [0, 1] (tone mapped and vignetted)
+inline std::uint8_t encode_gamma(const std::uint8_t* table, float x) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    if (bits >= 0x3F800000u) return 255;   // 1.0
+    if (bits < kGammaLowBits) return 0;
+    return table[(bits - kGammaLowBits) >> kGammaShift];
+}
+
+// --- Passes ------------------------------------------------------------------
+
+template <typename Fn>
+void for_row_bands(int rows, Fn&& fn) {
+    parallel_for((rows + kBand - 1) / kBand, [&](int b) {
+        fn(b * kBand, std::min(rows, (b + 1) * kBand));
+    });
+}
+
+// Floats of blur_rows scratch: one edge-padded RGBA row per band
+std::size_t blur_rows_scratch(int w, int h) {
+    return static_cast<std::size_t>((h + kBand - 1) / kBand) * (w + 8) * 4;
+}
+
+// 9-tap blur of an RGBA image along x, edges clamped like GL_CLAMP_TO_EDGE.
+// scratch holds blur_rows_scratch(w, h) floats.
+void blur_rows(const float* src, float* dst, int w, int h, const std::array<float, 5>& wt,
+               float* scratch) {
+    for_row_bands(h, [&](int y0, int y1) {
+        float* padded = scratch + static_cast<std::size_t>(y0 / kBand) * (w + 8) * 4;
+        for (int y = y0; y < y1; ++y) {
+            const float* row = src + static_cast<std::size_t>(y) * w * 4;
+            for (int x = -4; x < w + 4; ++x)
+                std::memcpy(&padded[(x + 4) * 4], row + std::clamp(x, 0, w - 1) * 4, 4 * sizeof(float));
+
+            float* out = dst + static_cast<std::size_t>(y) * w * 4;
+            for (int x = 0; x < w; ++x) {
+                const float* c = &padded[(x + 4) * 4];
+                f4 acc = mul(load4(c), splat(wt[0]));
+                for (int i = 1; i < 5; ++i)
+                    acc = add(acc, mul(add(load4(c + i * 4), load4(c - i * 4)), splat(wt[i])));
+                store4(out + x * 4, acc);
+            }
+        }
+    });
+}
+
+// The same along y: each output row combines nine clamped source rows
+void blur_columns(const float* src, float* dst, int w, int h, const std::array<float, 5>& wt) {
+    for_row_bands(h, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const float* up[5];
+            const float* down[5];
+            for (int i = 0; i < 5; ++i) {
+                up[i]   = src + static_cast<std::size_t>(std::max(y - i, 0)) * w * 4;
+                down[i] = src + static_cast<std::size_t>(std::min(y + i, h - 1)) * w * 4;
+            }
+            float* out = dst + static_cast<std::size_t>(y) * w * 4;
+            for (int x = 0; x < w * 4; x += 4) {
+                f4 acc = mul(load4(up[0] + x), splat(wt[0]));
+                for (int i = 1; i < 5; ++i)
+                    acc = add(acc, mul(add(load4(up[i] + x), load4(down[i] + x)), splat(wt[i])));
+                store4(out + x, acc);
+            }
+        }
+    });
+}
+
+} // namespace
+
+void PostProcess::make_taps(std::vector<Tap>& taps, int n_src, int n_dst) {
+    taps.resize(n_dst);
+    for (int i = 0; i < n_dst; ++i) {
+        float f = (static_cast<float>(i) + 0.5f) * static_cast<float>(n_src) / static_cast<float>(n_dst) - 0.5f;
+        float fl = std::floor(f);
+        int   i0 = static_cast<int>(fl);
+        taps[i] = {std::clamp(i0, 0, n_src - 1), std::clamp(i0 + 1, 0, n_src - 1), f - fl};
+    }
+}
+
+void PostProcess::apply(const HdrImage& scene, float bloom_intensity, LdrImage& out) {
+    static const std::array<float, 5> weights = blur_weights();
+    const std::uint8_t* gamma = gamma_table();
+
+    const int w = scene.width, h = scene.height;
+    out.resize(w, h);
+    half_w_    = std::max(w / 2, 1);
+    half_h_    = std::max(h / 2, 1);
+    quarter_w_ = std::max(half_w_ / 2, 1);
+    quarter_h_ = std::max(half_h_ / 2, 1);
+    half_.resize(static_cast<std::size_t>(half_w_) * half_h_ * 4);
+    quarter_.resize(static_cast<std::size_t>(quarter_w_) * quarter_h_ * 4);
+    blurred_.resize(quarter_.size());
+    padded_.resize(blur_rows_scratch(quarter_w_, quarter_h_));
+
+    const float* scene_px  = scene.pixels.data();
+    const float* scene_end = scene_px + scene.pixels.size();
+
+    // Bright pass: each half-resolution texel's bilinear tap of the scene
+    make_taps(columns_, w, half_w_);
+    make_taps(rows_, h, half_h_);
+    for_row_bands(half_h_, [&](int y0, int y1) {
+        const f4 lum_weights = set4(0.2126f, 0.7152f, 0.0722f, 0.0f);
+        for (int y = y0; y < y1; ++y) {
+            const Tap&   ty = rows_[y];
+            const float* r0 = scene_px + static_cast<std::size_t>(ty.i0) * w * 3;
+            const float* r1 = scene_px + static_cast<std::size_t>(ty.i1) * w * 3;
+            float* dst = half_.data() + static_cast<std::size_t>(y) * half_w_ * 4;
+            for (int x = 0; x < half_w_; ++x) {
+                const Tap& tx = columns_[x];
+                f4 top = lerp(load3(r0 + tx.i0 * 3, scene_end), load3(r0 + tx.i1 * 3, scene_end), tx.t);
+                f4 bot = lerp(load3(r1 + tx.i0 * 3, scene_end), load3(r1 + tx.i1 * 3, scene_end), tx.t);
+                f4 c = lerp(top, bot, ty.t);
+                float lum[4];
+                store4(lum, mul(c, lum_weights));
+                store4(dst + x * 4, lum[0] + lum[1] + lum[2] > kBloomThreshold ? c : splat(0.0f));
+            }
+        }
+    });
+
+    // Next mip: bilinear taps at quarter-resolution texel centers (a 2x2
+    // box for even sizes), then the separable blur
+    make_taps(columns_, half_w_, quarter_w_);
+    make_taps(rows_, half_h_, quarter_h_);
+    for_row_bands(quarter_h_, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const Tap&   ty = rows_[y];
+            const float* r0 = half_.data() + static_cast<std::size_t>(ty.i0) * half_w_ * 4;
+            const float* r1 = half_.data() + static_cast<std::size_t>(ty.i1) * half_w_ * 4;
+            float* dst = quarter_.data() + static_cast<std::size_t>(y) * quarter_w_ * 4;
+            for (int x = 0; x < quarter_w_; ++x) {
+                const Tap& tx = columns_[x];
+                f4 top = lerp(load4(r0 + tx.i0 * 4), load4(r0 + tx.i1 * 4), tx.t);
+                f4 bot = lerp(load4(r1 + tx.i0 * 4), load4(r1 + tx.i1 * 4), tx.t);
+                store4(dst + x * 4, lerp(top, bot, ty.t));
+            }
+        }
+    });
+    blur_rows(quarter_.data(), blurred_.data(), quarter_w_, quarter_h_, weights, padded_.data());
+    blur_columns(blurred_.data(), quarter_.data(), quarter_w_, quarter_h_, weights);
+
+    // Composite (kCompositeFS) with the bloom tapped straight from the
+    // quarter-resolution mip
+    make_taps(columns_, quarter_w_, w);
+    make_taps(rows_, quarter_h_, h);
+    const f4 intensity = splat(bloom_intensity);
+    for_row_bands(h, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const Tap&    ty = rows_[y];
+            const float*  b0 = quarter_.data() + static_cast<std::size_t>(ty.i0) * quarter_w_ * 4;
+            const float*  b1 = quarter_.data() + static_cast<std::size_t>(ty.i1) * quarter_w_ * 4;
+            const float*  src = scene.row(y);
+            std::uint8_t* dst = out.row(y);
+            float cv = (static_cast<float>(y) + 0.5f) / static_cast<float>(h) - 0.5f;
+            for (int x = 0; x < w; ++x) {
+                const Tap& tx = columns_[x];
+                f4 top = lerp(load4(b0 + tx.i0 * 4), load4(b0 + tx.i1 * 4), tx.t);
+                f4 bot = lerp(load4(b1 + tx.i0 * 4), load4(b1 + tx.i1 * 4), tx.t);
+                f4 hdr = add(load3(src + x * 3, scene_end), mul(lerp(top, bot, ty.t), intensity));
+
+                float cu = (static_cast<float>(x) + 0.5f) / static_cast<float>(w) - 0.5f;
+                float vignette = 1.0f - 0.4f * (cu * cu + cv * cv);
+                float c[4];
+                store4(c, mul(aces(hdr), splat(vignette)));
+                dst[x * 3 + 0] = encode_gamma(gamma, c[0]);
+                dst[x * 3 + 1] = encode_gamma(gamma, c[1]);
+                dst[x * 3 + 2] = encode_gamma(gamma, c[2]);
+            }
+        }
+    });
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "hdr_image.h"
+#include <vector>
+
+// CPU counterpart of the GL post-processing (Renderer::draw_bloom and
+// draw_composite, kBrightFS / kBlurFS / kCompositeFS): bright pass, blur,
+// then bloom added, ACES, vignette and gamma 2.2, quantized to 8 bits.
+//
+// The bright pass matches the shader's half-resolution bilinear taps. The
+// GL blur (three H + V rounds of the 9-tap kernel at half resolution) is
+// replaced by one mip further down: the bright half-resolution image is
+// box-filtered to quarter resolution and blurred once with a 9-tap kernel
+// whose sigma keeps the overall spread the same (see kQuarterSigma), which
+// is about 12x less blur work for the same look. Buffers are RGBA float so
+// every pixel is one SIMD vector; every pass is threaded over row bands.
+class PostProcess {
+public:
+    void apply(const HdrImage& scene, float bloom_intensity, LdrImage& out);
+
+private:
+    int half_w_ = 0, half_h_ = 0;
+    int quarter_w_ = 0, quarter_h_ = 0;
+    std::vector<float> half_;                  // bright pass, RGBA
+    std::vector<float> quarter_, blurred_;     // mip 2 and its H-blurred copy, RGBA
+    std::vector<float> padded_;                // blur scratch: an edge-padded row per band
+
+    // Bilinear taps of the current pass for each output column and row:
+    // source texels i0, i0 + 1 (clamped) and the weight of the second
+    struct Tap {
+        int   i0, i1;
+        float t;
+    };
+    std::vector<Tap> columns_, rows_;
+
+    // texture() taps for an n_dst-texel target sampling an n_src texture
+    static void make_taps(std::vector<Tap>& taps, int n_src, int n_dst);
+};
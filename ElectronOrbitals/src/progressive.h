@@ -0,0 +1,83 @@
+#pragma once
+#include "raymarch_params.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// Progressive refinement for still views. Each frame marches
+// max_steps / kProgressiveStepDivisor samples with the lattice shifted by a
+// per-frame jitter, and the renderer blends it into a history image. The
+// first kProgressiveStepDivisor jitters interleave to exactly the sample
+// density of a full max_steps march, later ones keep filling in between.
+// The frames are marked long_steps: averaging them removes the lattice
+// aliasing but not the overshoot of the linear opacity or the dimmer glow
+// of a coarse lattice's closest approach, which would otherwise leave the
+// result at the quality of the short march.
+//
+// After kProgressiveHistory frames the blend turns into a running average
+// with that weight, so the shimmer animation still comes through (with a
+// short lag) instead of freezing.
+constexpr int kProgressiveStepDivisor = 4;
+constexpr int kProgressiveHistory     = 32;
+
+// Frame counter shared by the GL and CPU renderers. begin_frame() restarts
+// the history whenever anything but the animation time changed since the
+// previous frame; renderers call reset() for their own settings (psi
+// volume, occupancy grid, image size).
+class ProgressiveAccumulator {
+public:
+    // The frame's uniforms: fewer, long steps at this frame's lattice offset
+    RaymarchUniforms begin_frame(const RaymarchUniforms& u) {
+        if (!valid_ || !same_view(u, last_)) frame_ = 0;
+        else ++frame_;
+        last_  = u;
+        valid_ = true;
+
+        RaymarchUniforms f = u;
+        f.max_steps   = std::max(u.max_steps / kProgressiveStepDivisor, 1);
+        f.jitter      = jitter(frame_);
+        f.long_steps  = true;
+        return f;
+    }
+
+    void reset() { valid_ = false; }
+
+    // Weight of the current frame against the history: 1 on the first frame
+    // (history ignored), then a plain average up to kProgressiveHistory
+    float weight() const {
+        return 1.0f / static_cast<float>(std::min(frame_, kProgressiveHistory - 1) + 1);
+    }
+
+    // Frames blended into the history, including the current one
+    int frames() const { return valid_ ? frame_ + 1 : 0; }
+
+    // Lattice offset of frame k in [0, 1): 0.5 (the regular lattice) first,
+    // then the base-2 van der Corput sequence shifted by a half step, i.e.
+    // 0.5, 0, 0.75, 0.25, 0.625, ...
+    static float jitter(int k) {
+        std::uint32_t bits = static_cast<std::uint32_t>(k);
+        bits = (bits << 16) | (bits >> 16);
+        bits = ((bits & 0x00ff00ffu) << 8) | ((bits & 0xff00ff00u) >> 8);
+        bits = ((bits & 0x0f0f0f0fu) << 4) | ((bits & 0xf0f0f0f0u) >> 4);
+        bits = ((bits & 0x33333333u) << 2) | ((bits & 0xccccccccu) >> 2);
+        bits = ((bits & 0x55555555u) << 1) | ((bits & 0xaaaaaaaau) >> 1);
+        float v = static_cast<float>(bits >> 8) * (1.0f / 16777216.0f) + 0.5f;
+        return v < 1.0f ? v : v - 1.0f;
+    }
+
+private:
+    RaymarchUniforms last_{};
+    bool             valid_ = false;
+    int              frame_ = 0;
+
+    static bool same_view(const RaymarchUniforms& a, const RaymarchUniforms& b) {
+        return std::memcmp(a.inv_view_proj.data(), b.inv_view_proj.data(), 16 * sizeof(float)) == 0 &&
+               a.camera_pos.x == b.camera_pos.x && a.camera_pos.y == b.camera_pos.y &&
+               a.camera_pos.z == b.camera_pos.z &&
+               a.n == b.n && a.l == b.l && a.m == b.m &&
+               a.bounding_radius == b.bounding_radius &&
+               a.density_scale == b.density_scale &&
+               a.max_steps == b.max_steps &&
+               a.anim_speed == b.anim_speed;
+    }
+};
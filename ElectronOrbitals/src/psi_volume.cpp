@@ -0,0 +1,210 @@
+#include "psi_volume.h"
+#include "wavefunction.h"
+#include "parallel.h"
+#include "fast_math.h"
+#include "image_io.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+// --- Sampling ----------------------------------------------------------------
+
+float PsiVolume::sample(vec3 pos) const {
+    // Continuous voxel coordinates: voxel i covers [i, i + 1), center i + 0.5
+    float scale = 0.5f * static_cast<float>(resolution) / extent;
+    float half  = 0.5f * static_cast<float>(resolution) - 0.5f;
+    float hi    = static_cast<float>(resolution - 1);
+    float fx = std::clamp(pos.x * scale + half, 0.0f, hi);
+    float fy = std::clamp(pos.y * scale + half, 0.0f, hi);
+    float fz = std::clamp(pos.z * scale + half, 0.0f, hi);
+
+    int x0 = std::min(static_cast<int>(fx), resolution - 2);
+    int y0 = std::min(static_cast<int>(fy), resolution - 2);
+    int z0 = std::min(static_cast<int>(fz), resolution - 2);
+    float tx = fx - static_cast<float>(x0);
+    float ty = fy - static_cast<float>(y0);
+    float tz = fz - static_cast<float>(z0);
+
+    std::size_t sx = 1, sy = static_cast<std::size_t>(resolution), sz = sy * sy;
+    const float* c = psi.data() + z0 * sz + y0 * sy + x0;
+
+    float c00 = c[0]       + (c[sx]           - c[0])       * tx;
+    float c10 = c[sy]      + (c[sy + sx]      - c[sy])      * tx;
+    float c01 = c[sz]      + (c[sz + sx]      - c[sz])      * tx;
+    float c11 = c[sz + sy] + (c[sz + sy + sx] - c[sz + sy]) * tx;
+    float c0 = c00 + (c10 - c00) * ty;
+    float c1 = c01 + (c11 - c01) * ty;
+    return c0 + (c1 - c0) * tz;
+}
+
+void eval_packet_volume(const PsiVolume& vol, const PacketParams& p, vec3 ro, vec3 rd,
+                        SamplePacket& io) {
+    for (int i = 0; i < kPacketWidth; ++i) {
+        vec3  pos = ro + rd * io.t[i];
+        float d2 = dot(pos, pos);
+        float r = std::sqrt(d2);
+
+        float psi = vol.sample(pos);
+        float density = psi * psi * p.density_scale;
+        density *= 1.0f + 0.06f * fast_sin(p.phase + r * 4.0f
+                                           + dot(pos, vec3{1.7f, 2.3f, 3.1f}));
+        io.psi[i] = psi;
+        io.density[i] = density;
+        io.dist_sq[i] = d2;
+    }
+}
+
+// --- Building ----------------------------------------------------------------
+
+PsiVolume build_psi_volume(const OrbitalInfo& orb, int resolution) {
+    PsiVolume vol;
+    vol.n = orb.n;
+    vol.l = orb.l;
+    vol.m = orb.m;
+    vol.resolution = std::max(resolution, 2);
+    vol.extent = orb.bounding_radius;
+
+    const int res = vol.resolution;
+    vol.psi.assign(static_cast<std::size_t>(res) * res * res, 0.0f);
+
+    const float voxel = 2.0f * vol.extent / static_cast<float>(res);
+    const PsiRecurrence rc = make_psi_recurrence(orb);
+    auto center = [&](int i) { return -vol.extent + (static_cast<float>(i) + 0.5f) * voxel; };
+
+    parallel_for(res, [&](int z) {
+        float* slice = vol.psi.data() + static_cast<std::size_t>(z) * res * res;
+        for (int y = 0; y < res; ++y) {
+            for (int x = 0; x < res; ++x) {
+                vec3  pos = {center(x), center(y), center(z)};
+                slice[y * res + x] = eval_psi(rc, pos, length(pos));
+            }
+        }
+    });
+    return vol;
+}
+
+// --- File I/O ----------------------------------------------------------------
+
+namespace {
+struct PsiVolumeHeader {
+    char          magic[4];     // "PSIV"
+    std::uint32_t version;
+    std::int32_t  n, l, m;
+    std::int32_t  resolution;
+    float         extent;
+};
+constexpr std::uint32_t kPsiVolumeVersion = 2;   // 2: recurrence-normalized Y_lm
+}
+
+// Written to a temporary file renamed into place, so a crash mid-write
+// never leaves a truncated grid under the cache name
+bool write_psi_volume(const char* path, const PsiVolume& vol) {
+    std::string tmp = std::string(path) + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) {
+        std::fprintf(stderr, "Cannot open %s for writing\n", tmp.c_str());
+        return false;
+    }
+    PsiVolumeHeader h{};
+    std::memcpy(h.magic, "PSIV", 4);
+    h.version    = kPsiVolumeVersion;
+    h.n          = vol.n;
+    h.l          = vol.l;
+    h.m          = vol.m;
+    h.resolution = vol.resolution;
+    h.extent     = vol.extent;
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+              std::fwrite(vol.psi.data(), sizeof(float), vol.psi.size(), f) == vol.psi.size();
+    ok = std::fclose(f) == 0 && ok;
+    std::error_code ec;
+    if (ok) std::filesystem::rename(tmp, path, ec);
+    if (!ok || ec) {
+        std::fprintf(stderr, "Cannot write %s\n", path);
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+bool read_psi_volume(const char* path, PsiVolume& vol) {
+    std::FILE* f = std::fopen(path, "rb");
+    if (!f) return false;
+
+    PsiVolumeHeader h{};
+    bool ok = std::fread(&h, sizeof(h), 1, f) == 1 &&
+              std::memcmp(h.magic, "PSIV", 4) == 0 &&
+              h.version == kPsiVolumeVersion &&
+              h.resolution >= 2 && h.resolution <= 2048 &&
+              static_cast<std::uint64_t>(h.resolution) * h.resolution * h.resolution <=
+                  file_bytes_left(f) / sizeof(float);
+    if (ok) {
+        vol.n = h.n;
+        vol.l = h.l;
+        vol.m = h.m;
+        vol.resolution = h.resolution;
+        vol.extent = h.extent;
+        vol.psi.resize(static_cast<std::size_t>(h.resolution) * h.resolution * h.resolution);
+        ok = std::fread(vol.psi.data(), sizeof(float), vol.psi.size(), f) == vol.psi.size();
+    }
+    std::fclose(f);
+    if (!ok) std::fprintf(stderr, "Ignoring unreadable volume %s\n", path);
+    return ok;
+}
+
+// --- Cache -------------------------------------------------------------------
+
+PsiVolumeCache::Key PsiVolumeCache::key(const OrbitalInfo& orb, int resolution) {
+    return Key{orb.n, orb.l, orb.m, resolution, std::bit_cast<int>(orb.bounding_radius)};
+}
+
+std::string PsiVolumeCache::file_path(const OrbitalInfo& orb, int resolution) const {
+    char name[96];
+    int  len = std::snprintf(name, sizeof(name), "psi_%d_%d_%d_%d", orb.n, orb.l, orb.m, resolution);
+    if (orb.bounding_radius != compute_bounding_radius(orb.n, orb.l))
+        len += std::snprintf(name + len, sizeof(name) - len, "_r%g", orb.bounding_radius);
+    std::snprintf(name + len, sizeof(name) - len, ".psiv");
+    return (std::filesystem::path(dir_) / name).string();
+}
+
+const PsiVolume* PsiVolumeCache::find(const OrbitalInfo& orb, int resolution) const {
+    resolution = std::max(resolution, 2);   // as build_psi_volume
+    auto it = volumes_.find(key(orb, resolution));
+    return it != volumes_.end() ? it->second.get() : nullptr;
+}
+
+const PsiVolume& PsiVolumeCache::get(const OrbitalInfo& orb, int resolution) {
+    // Clamped as build_psi_volume does, so the key, file name and stale
+    // check all match the grid that gets built
+    resolution = std::max(resolution, 2);
+    Key k = key(orb, resolution);
+    auto it = volumes_.find(k);
+    if (it != volumes_.end()) return *it->second;
+
+    auto vol = std::make_unique<PsiVolume>();
+    std::string path = dir_.empty() ? std::string() : file_path(orb, resolution);
+
+    // A file built for another orbital (renamed or copied over) or another
+    // bounding radius is stale
+    if (path.empty() || !read_psi_volume(path.c_str(), *vol) ||
+        vol->n != orb.n || vol->l != orb.l || vol->m != orb.m ||
+        vol->resolution != resolution || vol->extent != orb.bounding_radius) {
+        *vol = build_psi_volume(orb, resolution);
+        if (!path.empty()) {
+            std::error_code ec;
+            std::filesystem::create_directories(dir_, ec);
+            write_psi_volume(path.c_str(), *vol);
+        }
+    }
+    return *volumes_.emplace(k, std::move(vol)).first->second;
+}
+
+std::size_t PsiVolumeCache::memory_bytes() const {
+    std::size_t total = 0;
+    for (const auto& [key, vol] : volumes_) total += vol->bytes();
+    return total;
+}
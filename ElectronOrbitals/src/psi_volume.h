@@ -0,0 +1,69 @@
+#pragma once
+#include "vec3.h"
+#include "orbital.h"
+#include "wavefunction_simd.h"
+#include <array>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Signed psi sampled on a regular grid over the orbital's bounding cube
+// [-extent, extent]^3. Voxel centers sit where a GL 3D texture puts its
+// texels, so sample() and texture() on the uploaded grid agree.
+struct PsiVolume {
+    int   n = 0, l = 0, m = 0;
+    int   resolution = 0;       // voxels per axis
+    float extent     = 0.0f;    // half-size of the cube (the bounding radius)
+    std::vector<float> psi;     // resolution^3, x fastest, then y, then z
+
+    float voxel(int x, int y, int z) const {
+        return psi[(static_cast<std::size_t>(z) * resolution + y) * resolution + x];
+    }
+
+    // Trilinear interpolation, clamped to the edge voxels like GL_CLAMP_TO_EDGE
+    float sample(vec3 pos) const;
+
+    std::size_t bytes() const { return psi.size() * sizeof(float); }
+};
+
+// Evaluates psi at every voxel center, one z slice per work item.
+PsiVolume build_psi_volume(const OrbitalInfo& orb, int resolution);
+
+// Binary .psiv file: small header, then the raw float grid.
+bool write_psi_volume(const char* path, const PsiVolume& vol);
+bool read_psi_volume(const char* path, PsiVolume& vol);
+
+// Same contract as the analytic packet kernels, with psi read from the grid
+// instead of evaluated; the shimmer term is still applied per sample.
+void eval_packet_volume(const PsiVolume& vol, const PacketParams& p, vec3 ro, vec3 rd,
+                        SamplePacket& io);
+
+// Volumes keyed by (n, l, m, resolution, extent), the extent being the
+// orbital's bounding_radius (superpositions pass a larger shared one).
+// get() returns the in-memory copy, else loads
+// <dir>/psi_<n>_<l>_<m>_<res>.psiv (with an _r<extent> suffix for a
+// non-default extent), else builds and writes it. An empty dir keeps the
+// cache in memory only. Returned references stay valid for the cache's
+// lifetime.
+class PsiVolumeCache {
+public:
+    explicit PsiVolumeCache(std::string dir = {}) : dir_(std::move(dir)) {}
+
+    const PsiVolume& get(const OrbitalInfo& orb, int resolution);
+    const PsiVolume* find(const OrbitalInfo& orb, int resolution) const;
+
+    std::size_t count() const { return volumes_.size(); }
+    std::size_t memory_bytes() const;
+
+private:
+    using Key = std::array<int, 5>;   // n, l, m, resolution, extent (float bits)
+
+    std::string dir_;
+    std::map<Key, std::unique_ptr<PsiVolume>> volumes_;
+
+    static Key key(const OrbitalInfo& orb, int resolution);
+    std::string file_path(const OrbitalInfo& orb, int resolution) const;
+};
@@ -0,0 +1,25 @@
+#pragma once
+#include "mat4.h"
+
+// Inputs to one ray march pass. Shared by the GL renderer (uploaded as
+// uniforms) and the CPU renderer, so both paths render the same frame.
+struct RaymarchUniforms {
+    mat4  inv_view_proj;
+    vec3  camera_pos;
+    int   n, l, m;
+    float radial_norm;
+    float angular_norm;
+    float bounding_radius;
+    float density_scale;
+    int   max_steps;
+    float time;
+    float anim_speed;
+    float jitter = 0.5f;   // sample offset within a step; 0.5 = step midpoints
+    // Steps too long for the linear opacity and for the lattice's closest
+    // approach to the nucleus (progressive frames): composite with
+    // 1 - exp(-tau) and take the glow from the exact closest approach
+    bool  long_steps = false;
+    // Leave the nucleus glow out and output transmittance (1 - alpha) with
+    // the color, for an upsample that adds the glow per output pixel
+    bool  defer_nucleus = false;
+};
@@ -1,5 +1,8 @@
 #include "renderer.h"
+#include "wavefunction.h"
+#include <algorithm>
 #include <cstdio>
+#include <string>
 
 #define STB_EASY_FONT_IMPLEMENTATION
 #include "stb_easy_font.h"
@@ -24,8 +27,12 @@ void main() {
 
 // ---------------------------------------------------------------------------
 // Ray march fragment shader
+//
+// Assembled from three pieces: kRaymarchHeadFS, an orbital_psi() definition
+// (kRaymarchGenericPsiFS, or one generated per orbital by orbital_psi_glsl())
+// and kRaymarchMainFS.
 // ---------------------------------------------------------------------------
-static constexpr const char* kRaymarchFS = R"glsl(
+static constexpr const char* kRaymarchHeadFS = R"glsl(
 #version 460 core
 in vec2 v_uv;
 out vec4 frag_color;
@@ -42,6 +49,9 @@ uniform float u_density_scale;
 uniform int   u_max_steps;
 uniform float u_time;
 uniform float u_anim_speed;
+uniform float u_jitter;   // sample offset within a step; 0.5 = step midpoints
+uniform bool  u_long_steps;   // exact opacity and nucleus closest approach
+uniform bool  u_defer_nucleus;   // output (volume color, transmittance) for kUpsampleFS
 
 // Reconstruct world ray from UV + inverse view-projection
 void get_ray(out vec3 ro, out vec3 rd) {
@@ -64,71 +74,6 @@ vec2 intersect_sphere(vec3 ro, vec3 rd, float radius) {
     return vec2(-b - sq, -b + sq);
 }
 
-// Associated Laguerre polynomial L^alpha_k(x) via recurrence
-float laguerre(int k, float alpha, float x) {
-    if (k == 0) return 1.0;
-    float L0 = 1.0;
-    float L1 = 1.0 + alpha - x;
-    if (k == 1) return L1;
-    for (int i = 1; i < k; ++i) {
-        float L2 = ((2.0 * float(i) + 1.0 + alpha - x) * L1 - (float(i) + alpha) * L0) / float(i + 1);
-        L0 = L1;
-        L1 = L2;
-    }
-    return L1;
-}
-
-// Evaluate radial part R_nl(r)
-float radial(float r, int n, int l, float norm) {
-    float rho = 2.0 * r / float(n);
-    float alpha = float(2 * l + 1);
-    int k = n - l - 1;
-    float L = laguerre(k, alpha, rho);
-    return norm * exp(-rho * 0.5) * pow(rho, float(l)) * L;
-}
-
-// Evaluate real spherical harmonic Y_lm in Cartesian form
-// pos must not be zero-length
-float spherical_harmonic(vec3 pos, float r, int l, int m, float norm) {
-    if (r < 1e-10) return 0.0;
-    float x = pos.x, y = pos.y, z = pos.z;
-    float r2 = r * r;
-    float r3 = r2 * r;
-
-    float angular = 0.0;
-
-    // l=0
-    if (l == 0) {
-        angular = 1.0;
-    }
-    // l=1
-    else if (l == 1) {
-        if      (m == -1) angular = y / r;
-        else if (m ==  0) angular = z / r;
-        else              angular = x / r;
-    }
-    // l=2
-    else if (l == 2) {
-        if      (m == -2) angular = x * y / r2;
-        else if (m == -1) angular = y * z / r2;
-        else if (m ==  0) angular = (3.0 * z * z - r2) / r2;
-        else if (m ==  1) angular = x * z / r2;
-        else              angular = (x * x - y * y) / r2;
-    }
-    // l=3
-    else if (l == 3) {
-        if      (m == -3) angular = y * (3.0 * x * x - y * y) / r3;
-        else if (m == -2) angular = x * y * z / r3;
-        else if (m == -1) angular = y * (5.0 * z * z - r2) / r3;
-        else if (m ==  0) angular = z * (5.0 * z * z - 3.0 * r2) / r3;
-        else if (m ==  1) angular = x * (5.0 * z * z - r2) / r3;
-        else if (m ==  2) angular = z * (x * x - y * y) / r3;
-        else              angular = x * (x * x - 3.0 * y * y) / r3;
-    }
-
-    return norm * angular;
-}
-
 // Two-tone color palette
 vec3 color_palette(float psi, float density) {
     vec3 deep_blue    = vec3(0.05, 0.15, 0.4);
@@ -147,6 +92,287 @@ vec3 color_palette(float psi, float density) {
     base += vec3(1.0) * max(0.0, intensity - 0.5) * 3.0;
     return base;
 }
+)glsl";
+
+// Evaluation for any (n, l, m) from the recurrence tables of the current
+// orbital (PsiRecurrence, wavefunction.h), uploaded when the orbital changes
+static constexpr const char* kRaymarchGenericPsiFS = R"glsl(
+const int kMaxRecurrenceSteps = 8;
+
+uniform int   u_laguerre_steps;
+uniform vec3  u_laguerre[kMaxRecurrenceSteps];   // L' = (a - b rho) L - c L_prev
+uniform int   u_legendre_steps;
+uniform vec2  u_legendre[kMaxRecurrenceSteps];   // Q' = d w Q - e Q_prev
+uniform float u_psi_norm;
+
+float orbital_psi(vec3 pos, float r) {
+    if (r < 1e-10) return 0.0;
+    float rho = 2.0 * r / float(u_n);
+
+    // Radial: Laguerre recurrence
+    float L0 = 0.0, L1 = 1.0;
+    for (int i = 0; i < u_laguerre_steps; ++i) {
+        float L2 = (u_laguerre[i].x - u_laguerre[i].y * rho) * L1 - u_laguerre[i].z * L0;
+        L0 = L1;
+        L1 = L2;
+    }
+
+    // Azimuthal: (c + is) = (u + iv)^|m|
+    vec3  d = pos / r;
+    float c = 1.0, s = 0.0;
+    for (int i = 0; i < abs(u_m); ++i) {
+        float cn = c * d.x - s * d.y;
+        s = s * d.x + c * d.y;
+        c = cn;
+    }
+
+    // Polar: Legendre recurrence upward in l at fixed |m|
+    float Q0 = 0.0, Q1 = 1.0;
+    for (int j = 0; j < u_legendre_steps; ++j) {
+        float Q2 = u_legendre[j].x * d.z * Q1 - u_legendre[j].y * Q0;
+        Q0 = Q1;
+        Q1 = Q2;
+    }
+
+    float rho_l = 1.0;
+    for (int i = 0; i < u_l; ++i) rho_l *= rho;
+
+    float Y = Q1 * ((u_m < 0) ? s : c);
+    return u_psi_norm * exp(-rho * 0.5) * rho_l * L1 * Y;
+}
+)glsl";
+
+// psi read back from a precomputed grid (PsiVolume) with hardware trilinear
+// filtering; the grid spans [-u_volume_extent, u_volume_extent]^3
+static constexpr const char* kRaymarchVolumePsiFS = R"glsl(
+uniform sampler3D u_psi_volume;
+uniform float     u_volume_extent;
+
+float orbital_psi(vec3 pos, float r) {
+    return texture(u_psi_volume, pos * (0.5 / u_volume_extent) + 0.5).r;
+}
+)glsl";
+
+// psi from separable tables (OrbitalLut): R(r) from a 1D texture and Y
+// from the cube face the direction points at, one layer of a 2D array
+// texture per face. Both tables have texels on the ends of their range,
+// hence the (size - 1) / size remapping; see orbital_lut.h.
+static constexpr const char* kRaymarchLutPsiFS = R"glsl(
+uniform sampler1D      u_radial_lut;
+uniform sampler2DArray u_angular_lut;
+uniform float          u_lut_r_max;
+uniform float          u_lut_radial_size;
+uniform float          u_lut_face_size;
+
+float orbital_psi(vec3 pos, float r) {
+    if (r < 1e-10) return 0.0;
+    float fr = min(r / u_lut_r_max, 1.0) * (u_lut_radial_size - 1.0);
+    float R = texture(u_radial_lut, (fr + 0.5) / u_lut_radial_size).r;
+
+    vec3  a = abs(pos);
+    float face;
+    vec2  uv;
+    if (a.x >= a.y && a.x >= a.z) {
+        face = (pos.x < 0.0) ? 1.0 : 0.0;
+        uv = pos.yz / a.x;
+    } else if (a.y >= a.z) {
+        face = (pos.y < 0.0) ? 3.0 : 2.0;
+        uv = pos.xz / a.y;
+    } else {
+        face = (pos.z < 0.0) ? 5.0 : 4.0;
+        uv = pos.xy / a.z;
+    }
+    vec2 st = ((uv * 0.5 + 0.5) * (u_lut_face_size - 1.0) + 0.5) / u_lut_face_size;
+    return R * texture(u_angular_lut, vec3(st, face)).r;
+}
+)glsl";
+
+// Superposition (superposition.h): up to four basis psi per RGBA texel on
+// a shared grid, combined with this frame's complex weights. Filtering is
+// linear, so weighting the filtered texel equals filtering a per-voxel
+// combination, without writing and rereading one each frame.
+static constexpr const char* kRaymarchSuperpositionPsiFS = R"glsl(
+uniform sampler3D u_basis;
+uniform float     u_volume_extent;
+uniform vec4      u_weight_re;
+uniform vec4      u_weight_im;
+
+float orbital_psi(vec3 pos, float r) {
+    vec4  b  = texture(u_basis, pos * (0.5 / u_volume_extent) + 0.5);
+    float re = dot(b, u_weight_re);
+    float im = dot(b, u_weight_im);
+    float mag = sqrt(re * re + im * im);
+    return (re < 0.0) ? -mag : mag;   // superposition_psi()
+}
+)glsl";
+
+static constexpr const char* kRaymarchMainFS = R"glsl(
+// Empty-space skipping (OccupancyGrid): max |psi|^2 per cell over the
+// bounding cube; cells below u_occ_threshold are not sampled
+uniform bool      u_skip_empty;
+uniform sampler3D u_occupancy;
+uniform int       u_occ_res;
+uniform float     u_occ_extent;
+uniform float     u_occ_threshold;
+
+// Adaptive steps: the same grid's max density bounds the opacity a sample
+// can add, and the step budget is spread by adaptive_weight() instead of
+// evenly; cells below u_adaptive_threshold are not sampled
+uniform bool      u_adaptive;
+uniform float     u_adaptive_threshold;
+
+struct March {
+    vec3  ro, rd;
+    float t_near, step_size;
+    vec3  color;
+    float alpha;
+    float min_dist_sq;
+};
+
+// Composites the sample at t, standing for ray length h. Long adaptive
+// steps need the exact 1 - exp(-tau) instead of the linear form.
+void march_sample(inout March m, float t, float h, bool exact_alpha) {
+    vec3  pos = m.ro + m.rd * t;
+    float r = length(pos);
+
+    // Track closest approach to origin for nucleus glow
+    float d2 = dot(pos, pos);
+    m.min_dist_sq = min(m.min_dist_sq, d2);
+
+    if (r < 1e-6) return;
+
+    // Evaluate wave function
+    float psi = orbital_psi(pos, r);
+    float density = psi * psi * u_density_scale;
+
+    // Animated perturbation (subtle shimmer)
+    density *= 1.0 + 0.06 * sin(u_time * u_anim_speed + r * 4.0
+                     + dot(pos, vec3(1.7, 2.3, 3.1)));
+
+    // Color from sign of psi
+    vec3  sample_color = color_palette(psi, density);
+    float tau = density * h * 0.5;
+    float sample_alpha = exact_alpha ? 1.0 - exp(-tau) : clamp(tau, 0.0, 1.0);
+
+    // Front-to-back compositing
+    m.color += (1.0 - m.alpha) * sample_color * sample_alpha;
+    m.alpha += (1.0 - m.alpha) * sample_alpha;
+}
+
+// Samples i0 <= i < i1 of the uniform lattice t_near + (i + u_jitter) * step_size
+void march_range(inout March m, int i0, int i1) {
+    for (int i = i0; i < i1; ++i) {
+        if (m.alpha > 0.99) break;
+        march_sample(m, m.t_near + (float(i) + u_jitter) * m.step_size, m.step_size, u_long_steps);
+    }
+}
+
+// First lattice sample at or after t
+int first_sample(March m, float t) {
+    return clamp(int(ceil((t - m.t_near) / m.step_size - u_jitter)), 0, u_max_steps);
+}
+
+// 3D DDA over the occupancy cells; the current cell spans [t, exit)
+struct Dda {
+    ivec3 c, stp;
+    vec3  t_max, t_delta;
+    float t;
+};
+
+Dda dda_begin(March m) {
+    float cell = 2.0 * u_occ_extent / float(u_occ_res);
+    vec3  dir = mix(vec3(1e-12), m.rd, notEqual(m.rd, vec3(0.0)));
+    vec3  g = (m.ro + m.rd * m.t_near + u_occ_extent) / cell;
+
+    Dda d;
+    d.c = clamp(ivec3(floor(g)), ivec3(0), ivec3(u_occ_res - 1));
+    d.stp = ivec3(sign(dir));
+    d.t_max = ((vec3(d.c) + step(vec3(0.0), dir)) * cell - u_occ_extent - m.ro) / dir;
+    d.t_delta = cell / abs(dir);
+    d.t = m.t_near;
+    return d;
+}
+
+float dda_density(Dda d) {
+    return texelFetch(u_occupancy, d.c, 0).r;
+}
+
+// Moves to the next cell; false once the walk leaves the grid or passes
+// t_far, in which case the current cell runs to t_far
+bool dda_step(inout Dda d, float t_far) {
+    d.t = min(min(min(d.t_max.x, d.t_max.y), d.t_max.z), t_far);
+    if (d.t_max.x < d.t_max.y && d.t_max.x < d.t_max.z) { d.c.x += d.stp.x; d.t_max.x += d.t_delta.x; }
+    else if (d.t_max.y < d.t_max.z)                     { d.c.y += d.stp.y; d.t_max.y += d.t_delta.y; }
+    else                                                { d.c.z += d.stp.z; d.t_max.z += d.t_delta.z; }
+    return d.t < t_far && all(greaterThanEqual(d.c, ivec3(0))) && all(lessThan(d.c, ivec3(u_occ_res)));
+}
+
+// Marches only the lattice samples inside runs of occupied cells
+void march_occupied(inout March m, float t_far) {
+    Dda d = dda_begin(m);
+    float span_begin = -1.0;
+    for (int n = 0; n < 3 * u_occ_res; ++n) {
+        bool occupied = dda_density(d) >= u_occ_threshold;
+        if (occupied && span_begin < 0.0) {
+            span_begin = d.t;
+        } else if (!occupied && span_begin >= 0.0) {
+            march_range(m, first_sample(m, span_begin), first_sample(m, d.t));
+            if (m.alpha > 0.99) return;
+            span_begin = -1.0;
+        }
+        if (!dda_step(d, t_far)) break;
+    }
+    if (span_begin >= 0.0)
+        march_range(m, first_sample(m, span_begin), first_sample(m, t_far));
+}
+
+// Samples per unit length in a cell; mirrors adaptive_weight() on the CPU
+float adaptive_weight(float max_density) {
+    if (max_density < u_adaptive_threshold) return 0.0;
+    return sqrt(max_density * u_density_scale * 1.06 * 0.5);
+}
+
+// Spends u_max_steps samples evenly in weighted length: two walks over the
+// cells, the first for the total weight
+void march_adaptive(inout March m, float t_far) {
+    float total = 0.0;
+    Dda d = dda_begin(m);
+    for (int n = 0; n < 3 * u_occ_res; ++n) {
+        float t0 = d.t;
+        float w = adaptive_weight(dda_density(d));
+        bool  more = dda_step(d, t_far);
+        total += w * ((more ? d.t : t_far) - t0);
+        if (!more) break;
+    }
+
+    float du = total / float(u_max_steps);
+    float u_next = u_jitter * du;
+    float u_cell = 0.0;
+    int   issued = 0;
+    d = dda_begin(m);
+    for (int n = 0; n < 3 * u_occ_res; ++n) {
+        float t0 = d.t;
+        float w = adaptive_weight(dda_density(d));
+        bool  more = dda_step(d, t_far);
+        if (w > 0.0) {
+            float u_end = u_cell + w * ((more ? d.t : t_far) - t0);
+            for (; u_next < u_end && issued < u_max_steps; u_next += du, ++issued) {
+                march_sample(m, t0 + (u_next - u_cell) / w, du / w, true);
+                if (m.alpha > 0.99) return;
+            }
+            u_cell = u_end;
+        }
+        if (!more) break;
+    }
+}
+
+// Squared distance to the origin of the lattice sample nearest to it
+float lattice_min_dist_sq(March m) {
+    float i = round((-dot(m.ro, m.rd) - m.t_near) / m.step_size - u_jitter);
+    i = clamp(i, 0.0, float(u_max_steps - 1));
+    vec3 pos = m.ro + m.rd * (m.t_near + (i + u_jitter) * m.step_size);
+    return dot(pos, pos);
+}
 
 void main() {
     vec3 ro, rd;
@@ -162,47 +388,114 @@ void main() {
     float t_far  = t_hit.y;
     float step_size = (t_far - t_near) / float(u_max_steps);
 
-    vec3  accum_color = vec3(0.0);
-    float accum_alpha = 0.0;
-    float min_dist_sq = 1e10;
+    March m = March(ro, rd, t_near, step_size, vec3(0.0), 0.0, 1e10);
+    if (u_skip_empty && u_adaptive) {
+        march_adaptive(m, t_far);
+    } else if (u_skip_empty) {
+        march_occupied(m, t_far);
+        // Skipped samples may include the one nearest the nucleus
+        m.min_dist_sq = min(m.min_dist_sq, lattice_min_dist_sq(m));
+    } else {
+        march_range(m, 0, u_max_steps);
+    }
+    if (u_long_steps || (u_skip_empty && u_adaptive)) {
+        // Long steps miss the nucleus, which is glow only, so use the
+        // exact closest approach
+        vec3 p = ro + rd * clamp(-dot(ro, rd), t_near, t_far);
+        m.min_dist_sq = min(m.min_dist_sq, dot(p, p));
+    }
 
-    for (int i = 0; i < u_max_steps; ++i) {
-        if (accum_alpha > 0.99) break;
+    if (u_defer_nucleus) {
+        frag_color = vec4(m.color, 1.0 - m.alpha);
+        return;
+    }
 
-        float t = t_near + (float(i) + 0.5) * step_size;
-        vec3  pos = ro + rd * t;
-        float r = length(pos);
+    // Nucleus glow
+    vec3 nucleus = vec3(1.0, 0.9, 0.7) * exp(-m.min_dist_sq * 500.0);
+    vec3 accum_color = m.color + (1.0 - m.alpha) * nucleus;
 
-        // Track closest approach to origin for nucleus glow
-        float d2 = dot(pos, pos);
-        min_dist_sq = min(min_dist_sq, d2);
+    frag_color = vec4(accum_color, 1.0);
+}
+)glsl";
 
-        if (r < 1e-6) continue;
+// ---------------------------------------------------------------------------
+// Progressive accumulate fragment shader: blends the frame just marched
+// into the history (weight 1 replaces it, so a reset never reads stale or
+// uninitialized history). Alpha is blended too: it carries the
+// transmittance when the nucleus is deferred to kUpsampleFS.
+// ---------------------------------------------------------------------------
+static constexpr const char* kAccumulateFS = R"glsl(
+#version 460 core
+out vec4 frag_color;
 
-        // Evaluate wave function
-        float R = radial(r, u_n, u_l, u_radial_norm);
-        float Y = spherical_harmonic(pos, r, u_l, u_m, u_angular_norm);
-        float psi = R * Y;
-        float density = psi * psi * u_density_scale;
+uniform sampler2D u_frame;
+uniform sampler2D u_history;
+uniform float u_weight;
 
-        // Animated perturbation (subtle shimmer)
-        density *= 1.0 + 0.06 * sin(u_time * u_anim_speed + r * 4.0
-                         + dot(pos, vec3(1.7, 2.3, 3.1)));
+void main() {
+    ivec2 p = ivec2(gl_FragCoord.xy);
+    vec4 frame = texelFetch(u_frame, p, 0);
+    vec4 history = texelFetch(u_history, p, 0);
+    frag_color = u_weight >= 1.0 ? frame : mix(history, frame, u_weight);
+}
+)glsl";
 
-        // Color from sign of psi
-        vec3 sample_color = color_palette(psi, density);
-        float sample_alpha = clamp(density * step_size * 0.5, 0.0, 1.0);
+// ---------------------------------------------------------------------------
+// Upsample fragment shader (appended to kRaymarchHeadFS for get_ray and the
+// frame uniforms): bilateral 2x2 taps of the scaled march's volume color
+// and transmittance, plus the nucleus glow from each output pixel's own
+// ray. Mirrors CpuRenderer::upsample() and dynamic_resolution.h.
+// ---------------------------------------------------------------------------
+static constexpr const char* kUpsampleFS = R"glsl(
+uniform sampler2D u_scaled;
+uniform bool      u_exact_nucleus;
+uniform float     u_range_sigma;
 
-        // Front-to-back compositing
-        accum_color += (1.0 - accum_alpha) * sample_color * sample_alpha;
-        accum_alpha += (1.0 - accum_alpha) * sample_alpha;
+void main() {
+    ivec2 size = textureSize(u_scaled, 0);
+    vec2  p  = v_uv * vec2(size) - 0.5;
+    ivec2 i0 = ivec2(floor(p));
+    vec2  f  = p - vec2(i0);
+
+    vec4 taps[4];
+    float bilinear[4] = float[4]((1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y),
+                                 (1.0 - f.x) * f.y,         f.x * f.y);
+    for (int k = 0; k < 4; ++k) {
+        ivec2 c = clamp(i0 + ivec2(k & 1, k >> 1), ivec2(0), size - 1);
+        taps[k] = texelFetch(u_scaled, c, 0);
     }
+    float t_center = taps[(f.y >= 0.5 ? 2 : 0) + (f.x >= 0.5 ? 1 : 0)].a;
+
+    vec4  sum = vec4(0.0);
+    float total = 0.0;
+    for (int k = 0; k < 4; ++k) {
+        float d = (taps[k].a - t_center) / u_range_sigma;
+        float w = bilinear[k] * exp(-d * d);
+        sum += taps[k] * w;
+        total += w;
+    }
+    sum /= total;
 
-    // Nucleus glow
-    vec3 nucleus = vec3(1.0, 0.9, 0.7) * exp(-min_dist_sq * 500.0);
-    accum_color += (1.0 - accum_alpha) * nucleus;
-
-    frag_color = vec4(accum_color, 1.0);
+    // Nucleus glow at full resolution
+    vec3 ro, rd;
+    get_ray(ro, rd);
+    vec2 t_hit = intersect_sphere(ro, rd, u_bounding_radius);
+    float glow = 0.0;
+    if (t_hit.x >= 0.0) {
+        float min_dist_sq;
+        if (u_exact_nucleus) {
+            vec3 q = ro + rd * clamp(-dot(ro, rd), t_hit.x, t_hit.y);
+            min_dist_sq = dot(q, q);
+        } else {
+            float step_size = (t_hit.y - t_hit.x) / float(u_max_steps);
+            float i = round((-dot(ro, rd) - t_hit.x) / step_size - u_jitter);
+            i = clamp(i, 0.0, float(u_max_steps - 1));
+            vec3 q = ro + rd * (t_hit.x + (i + u_jitter) * step_size);
+            min_dist_sq = dot(q, q);
+        }
+        glow = exp(-min_dist_sq * 500.0) * sum.a;
+    }
+    frag_color = vec4(sum.rgb + vec3(1.0, 0.9, 0.7) * glow, 1.0);
 }
 )glsl";
 
@@ -361,13 +654,14 @@ static GLuint build_program(const char* vs_src, const char* fs_src) {
     return link_program(v, f);
 }
 
-static void create_hdr_fbo(GLuint& fbo, GLuint& tex, int w, int h) {
+static void create_hdr_fbo(GLuint& fbo, GLuint& tex, int w, int h,
+                           GLenum format = GL_RGBA16F) {
     if (fbo) { glDeleteFramebuffers(1, &fbo); fbo = 0; }
     if (tex) { glDeleteTextures(1, &tex); tex = 0; }
 
     glGenTextures(1, &tex);
     glBindTexture(GL_TEXTURE_2D, tex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, w, h, 0, GL_RGBA, GL_FLOAT, nullptr);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, w, h, 0, GL_RGBA, GL_FLOAT, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -383,33 +677,119 @@ static void create_hdr_fbo(GLuint& fbo, GLuint& tex, int w, int h) {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+// Float 3D texture (res^3, x fastest), clamped at the edges; one channel
+// unless given another format
+static GLuint create_grid_texture(int res, const float* data, GLint filter,
+                                  GLint internal_format = GL_R32F, GLenum format = GL_RED) {
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_3D, tex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage3D(GL_TEXTURE_3D, 0, internal_format, res, res, res, 0, format, GL_FLOAT, data);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_3D, 0);
+    return tex;
+}
+
 // ============================================================================
 // Renderer implementation
 // ============================================================================
 
+void Renderer::RaymarchProgram::build(const char* psi_src) {
+    std::string fs = std::string(kRaymarchHeadFS) + psi_src + kRaymarchMainFS;
+    prog = build_program(kFullscreenVS, fs.c_str());
+
+    inv_vp        = glGetUniformLocation(prog, "u_inv_view_proj");
+    camera_pos    = glGetUniformLocation(prog, "u_camera_pos");
+    n             = glGetUniformLocation(prog, "u_n");
+    l             = glGetUniformLocation(prog, "u_l");
+    m             = glGetUniformLocation(prog, "u_m");
+    radial_norm   = glGetUniformLocation(prog, "u_radial_norm");
+    angular_norm  = glGetUniformLocation(prog, "u_angular_norm");
+    bounding_r    = glGetUniformLocation(prog, "u_bounding_radius");
+    density_scale = glGetUniformLocation(prog, "u_density_scale");
+    max_steps     = glGetUniformLocation(prog, "u_max_steps");
+    time          = glGetUniformLocation(prog, "u_time");
+    anim_speed    = glGetUniformLocation(prog, "u_anim_speed");
+    jitter        = glGetUniformLocation(prog, "u_jitter");
+    long_steps    = glGetUniformLocation(prog, "u_long_steps");
+    defer_nucleus = glGetUniformLocation(prog, "u_defer_nucleus");
+    psi_volume    = glGetUniformLocation(prog, "u_psi_volume");
+    volume_extent = glGetUniformLocation(prog, "u_volume_extent");
+    radial_lut    = glGetUniformLocation(prog, "u_radial_lut");
+    angular_lut   = glGetUniformLocation(prog, "u_angular_lut");
+    lut_r_max     = glGetUniformLocation(prog, "u_lut_r_max");
+    lut_radial_size = glGetUniformLocation(prog, "u_lut_radial_size");
+    lut_face_size = glGetUniformLocation(prog, "u_lut_face_size");
+    basis         = glGetUniformLocation(prog, "u_basis");
+    weight_re     = glGetUniformLocation(prog, "u_weight_re");
+    weight_im     = glGetUniformLocation(prog, "u_weight_im");
+    skip_empty    = glGetUniformLocation(prog, "u_skip_empty");
+    occupancy     = glGetUniformLocation(prog, "u_occupancy");
+    occ_res       = glGetUniformLocation(prog, "u_occ_res");
+    occ_extent    = glGetUniformLocation(prog, "u_occ_extent");
+    occ_threshold = glGetUniformLocation(prog, "u_occ_threshold");
+    adaptive      = glGetUniformLocation(prog, "u_adaptive");
+    laguerre_steps = glGetUniformLocation(prog, "u_laguerre_steps");
+    laguerre      = glGetUniformLocation(prog, "u_laguerre");
+    legendre_steps = glGetUniformLocation(prog, "u_legendre_steps");
+    legendre      = glGetUniformLocation(prog, "u_legendre");
+    psi_norm      = glGetUniformLocation(prog, "u_psi_norm");
+    adaptive_thr  = glGetUniformLocation(prog, "u_adaptive_threshold");
+}
+
+Renderer::RaymarchProgram& Renderer::raymarch_program(const RaymarchUniforms& u) {
+    if (superposition_) return raymarch_superposition_;
+    if (volume_) return raymarch_volume_;
+    if (lut_) return raymarch_lut_;
+
+    int index = specialized_shaders_ ? specialized_index(u.n, u.l, u.m) : -1;
+    if (index < 0) return raymarch_generic_;
+
+    RaymarchProgram& p = raymarch_orbital_[index];
+    if (!p.prog) {
+        std::string psi = orbital_psi_glsl(u.n, u.l, u.m, u.radial_norm, u.angular_norm);
+        p.build(psi.c_str());
+    }
+    return p;
+}
+
 void Renderer::init() {
     // Empty VAO for fullscreen triangle
     glGenVertexArrays(1, &empty_vao_);
 
-    // Build shader programs
-    raymarch_prog_  = build_program(kFullscreenVS, kRaymarchFS);
+    // Build shader programs (per-orbital ray march variants are built lazily)
+    raymarch_generic_.build(kRaymarchGenericPsiFS);
+    raymarch_volume_.build(kRaymarchVolumePsiFS);
+    raymarch_lut_.build(kRaymarchLutPsiFS);
+    raymarch_superposition_.build(kRaymarchSuperpositionPsiFS);
     bright_prog_    = build_program(kFullscreenVS, kBrightFS);
     blur_prog_      = build_program(kFullscreenVS, kBlurFS);
     composite_prog_ = build_program(kFullscreenVS, kCompositeFS);
-
-    // Cache ray march uniforms
-    rm_inv_vp_        = glGetUniformLocation(raymarch_prog_, "u_inv_view_proj");
-    rm_camera_pos_    = glGetUniformLocation(raymarch_prog_, "u_camera_pos");
-    rm_n_             = glGetUniformLocation(raymarch_prog_, "u_n");
-    rm_l_             = glGetUniformLocation(raymarch_prog_, "u_l");
-    rm_m_             = glGetUniformLocation(raymarch_prog_, "u_m");
-    rm_radial_norm_   = glGetUniformLocation(raymarch_prog_, "u_radial_norm");
-    rm_angular_norm_  = glGetUniformLocation(raymarch_prog_, "u_angular_norm");
-    rm_bounding_r_    = glGetUniformLocation(raymarch_prog_, "u_bounding_radius");
-    rm_density_scale_ = glGetUniformLocation(raymarch_prog_, "u_density_scale");
-    rm_max_steps_     = glGetUniformLocation(raymarch_prog_, "u_max_steps");
-    rm_time_          = glGetUniformLocation(raymarch_prog_, "u_time");
-    rm_anim_speed_    = glGetUniformLocation(raymarch_prog_, "u_anim_speed");
+    accum_prog_     = build_program(kFullscreenVS, kAccumulateFS);
+    upsample_prog_  = build_program(kFullscreenVS,
+                                    (std::string(kRaymarchHeadFS) + kUpsampleFS).c_str());
+
+    // Accumulate uniforms
+    accum_frame_   = glGetUniformLocation(accum_prog_, "u_frame");
+    accum_history_ = glGetUniformLocation(accum_prog_, "u_history");
+    accum_weight_  = glGetUniformLocation(accum_prog_, "u_weight");
+
+    // Upsample uniforms
+    up_scaled_     = glGetUniformLocation(upsample_prog_, "u_scaled");
+    up_exact_      = glGetUniformLocation(upsample_prog_, "u_exact_nucleus");
+    up_sigma_      = glGetUniformLocation(upsample_prog_, "u_range_sigma");
+    up_inv_vp_     = glGetUniformLocation(upsample_prog_, "u_inv_view_proj");
+    up_camera_pos_ = glGetUniformLocation(upsample_prog_, "u_camera_pos");
+    up_bounding_r_ = glGetUniformLocation(upsample_prog_, "u_bounding_radius");
+    up_max_steps_  = glGetUniformLocation(upsample_prog_, "u_max_steps");
+    up_jitter_     = glGetUniformLocation(upsample_prog_, "u_jitter");
+
+    glGenQueries(kTimerQueries, timer_queries_);
 
     // Bright pass uniforms
     bright_scene_     = glGetUniformLocation(bright_prog_, "u_scene");
@@ -470,8 +850,9 @@ void Renderer::resize_fbos(int width, int height) {
     fb_width_  = width;
     fb_height_ = height;
 
-    // Full-res HDR FBO
-    create_hdr_fbo(hdr_fbo_, hdr_tex_, width, height);
+    // Ray march targets follow in draw_raymarch(), at the render scale
+    march_width_ = march_height_ = 0;
+    if (upsample_fbo_) create_hdr_fbo(upsample_fbo_, upsample_tex_, width, height);
 
     // Half-res bloom FBOs
     int hw = width / 2, hh = height / 2;
@@ -481,36 +862,291 @@ void Renderer::resize_fbos(int width, int height) {
     create_hdr_fbo(bloom_fbo_b_, bloom_tex_b_, hw, hh);
 }
 
+void Renderer::set_render_scale(float scale) {
+    render_scale_ = std::clamp(scale, kMinRenderScale, 1.0f);
+}
+
+void Renderer::resize_march_targets() {
+    int w = scaled_size(fb_width_, render_scale_);
+    int h = scaled_size(fb_height_, render_scale_);
+    if (render_scale_ < 1.0f && !upsample_fbo_)
+        create_hdr_fbo(upsample_fbo_, upsample_tex_, fb_width_, fb_height_);
+    if (w == march_width_ && h == march_height_) return;
+    march_width_  = w;
+    march_height_ = h;
+
+    create_hdr_fbo(hdr_fbo_, hdr_tex_, w, h);
+    if (history_fbo_[0]) {
+        for (int i = 0; i < 2; ++i)
+            create_hdr_fbo(history_fbo_[i], history_tex_[i], w, h, GL_RGBA32F);
+    }
+    accumulator_.reset();
+}
+
+bool Renderer::poll_march_time(float& ms, float& scale) {
+    if (!timing_ready_) return false;
+    timing_ready_ = false;
+    ms = timing_ms_;
+    scale = timing_scale_;
+    return true;
+}
+
 void Renderer::draw_fullscreen_triangle() {
     glBindVertexArray(empty_vao_);
     glDrawArrays(GL_TRIANGLES, 0, 3);
     glBindVertexArray(0);
 }
 
-void Renderer::draw_raymarch(const RaymarchUniforms& u) {
+void Renderer::draw_raymarch(const RaymarchUniforms& frame) {
+    resize_march_targets();
+    const bool scaled = march_width_ != fb_width_ || march_height_ != fb_height_;
+    // A superposition's density moves with time: a new time is a new image
+    if (superposition_ && (!weights_valid_ || weights_time_ != frame.time)) {
+        weights_time_  = frame.time;
+        weights_valid_ = true;
+        accumulator_.reset();
+    }
+    const OccupancyGrid* occupancy = superposition_ ? nullptr : occupancy_;
+    RaymarchUniforms u = progressive_ ? accumulator_.begin_frame(frame) : frame;
+    u.defer_nucleus = scaled;
+
+    // Time the march, accumulate and upsample passes. Results are read a
+    // few frames later, once available, so the CPU never waits on the GPU;
+    // if the oldest query is still in flight this frame goes untimed.
+    GLuint query = timer_queries_[timer_next_];
+    bool   timed = true;
+    if (timer_pending_[timer_next_]) {
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+            timing_ms_    = static_cast<float>(static_cast<double>(ns) * 1e-6);
+            timing_scale_ = timer_scales_[timer_next_];
+            timing_ready_ = true;
+            timer_pending_[timer_next_] = false;
+        } else {
+            timed = false;
+        }
+    }
+    if (timed) {
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        timer_scales_[timer_next_] = render_scale_;
+    }
+
     glBindFramebuffer(GL_FRAMEBUFFER, hdr_fbo_);
-    glViewport(0, 0, fb_width_, fb_height_);
+    glViewport(0, 0, march_width_, march_height_);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    glUseProgram(raymarch_prog_);
-    glUniformMatrix4fv(rm_inv_vp_, 1, GL_FALSE, u.inv_view_proj.data());
-    glUniform3f(rm_camera_pos_, u.camera_pos.x, u.camera_pos.y, u.camera_pos.z);
-    glUniform1i(rm_n_, u.n);
-    glUniform1i(rm_l_, u.l);
-    glUniform1i(rm_m_, u.m);
-    glUniform1f(rm_radial_norm_, u.radial_norm);
-    glUniform1f(rm_angular_norm_, u.angular_norm);
-    glUniform1f(rm_bounding_r_, u.bounding_radius);
-    glUniform1f(rm_density_scale_, u.density_scale);
-    glUniform1i(rm_max_steps_, u.max_steps);
-    glUniform1f(rm_time_, u.time);
-    glUniform1f(rm_anim_speed_, u.anim_speed);
+    RaymarchProgram& rm = raymarch_program(u);
+    glUseProgram(rm.prog);
+
+    // Recurrence tables are program state: upload once per orbital change
+    if (rm.psi_norm >= 0 && (rm.tables_n != u.n || rm.tables_l != u.l || rm.tables_m != u.m)) {
+        PsiRecurrence rc = make_psi_recurrence(u.n, u.l, u.m, u.radial_norm, u.angular_norm);
+        glUniform1i(rm.laguerre_steps, rc.laguerre_steps);
+        glUniform3fv(rm.laguerre, kMaxRecurrenceSteps, &rc.laguerre[0][0]);
+        glUniform1i(rm.legendre_steps, rc.legendre_steps);
+        glUniform2fv(rm.legendre, kMaxRecurrenceSteps, &rc.legendre[0][0]);
+        glUniform1f(rm.psi_norm, rc.norm);
+        rm.tables_n = u.n;
+        rm.tables_l = u.l;
+        rm.tables_m = u.m;
+    }
+    glUniformMatrix4fv(rm.inv_vp, 1, GL_FALSE, u.inv_view_proj.data());
+    glUniform3f(rm.camera_pos, u.camera_pos.x, u.camera_pos.y, u.camera_pos.z);
+    glUniform1i(rm.n, u.n);
+    glUniform1i(rm.l, u.l);
+    glUniform1i(rm.m, u.m);
+    glUniform1f(rm.radial_norm, u.radial_norm);
+    glUniform1f(rm.angular_norm, u.angular_norm);
+    glUniform1f(rm.bounding_r, u.bounding_radius);
+    glUniform1f(rm.density_scale, u.density_scale);
+    glUniform1i(rm.max_steps, u.max_steps);
+    glUniform1f(rm.time, u.time);
+    glUniform1f(rm.anim_speed, u.anim_speed);
+    glUniform1f(rm.jitter, u.jitter);
+    glUniform1i(rm.long_steps, u.long_steps ? 1 : 0);
+    glUniform1i(rm.defer_nucleus, u.defer_nucleus ? 1 : 0);
+
+    if (superposition_) {
+        float re[kMaxSuperpositionTerms], im[kMaxSuperpositionTerms];
+        superposition_->weights(u.time, re, im);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_3D, basis_tex_);
+        glUniform1i(rm.basis, 0);
+        glUniform1f(rm.volume_extent, superposition_->grid_extent());
+        glUniform4fv(rm.weight_re, 1, re);
+        glUniform4fv(rm.weight_im, 1, im);
+    } else if (volume_) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_3D, volume_tex_);
+        glUniform1i(rm.psi_volume, 0);
+        glUniform1f(rm.volume_extent, volume_->extent);
+    } else if (lut_) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_1D, radial_lut_tex_);
+        glUniform1i(rm.radial_lut, 0);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, angular_lut_tex_);
+        glUniform1i(rm.angular_lut, 2);
+        glUniform1f(rm.lut_r_max, lut_->r_max);
+        glUniform1f(rm.lut_radial_size, static_cast<float>(lut_->radial_size));
+        glUniform1f(rm.lut_face_size, static_cast<float>(lut_->face_size));
+    }
+
+    glUniform1i(rm.skip_empty, occupancy ? 1 : 0);
+    glUniform1i(rm.occupancy, 1);
+    if (occupancy) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_3D, occupancy_tex_);
+        glUniform1i(rm.occ_res, occupancy->resolution);
+        glUniform1f(rm.occ_extent, occupancy->extent);
+        glUniform1f(rm.occ_threshold, occupancy_threshold(*occupancy, u.density_scale));
+        glUniform1i(rm.adaptive, adaptive_steps_ ? 1 : 0);
+        glUniform1f(rm.adaptive_thr, occupancy_threshold(*occupancy, u.density_scale,
+                                                         kAdaptiveSkipOpacity));
+    }
 
     draw_fullscreen_triangle();
+
+    scene_tex_ = hdr_tex_;
+    if (progressive_) {
+        // 32-bit history: at weight 1/kProgressiveHistory the per-frame
+        // change is below half-float resolution
+        if (!history_fbo_[0]) {
+            for (int i = 0; i < 2; ++i)
+                create_hdr_fbo(history_fbo_[i], history_tex_[i], march_width_, march_height_,
+                               GL_RGBA32F);
+        }
+        int prev = history_cur_;
+        history_cur_ ^= 1;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, history_fbo_[history_cur_]);
+        glViewport(0, 0, march_width_, march_height_);
+        glUseProgram(accum_prog_);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, hdr_tex_);
+        glUniform1i(accum_frame_, 0);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, history_tex_[prev]);
+        glUniform1i(accum_history_, 1);
+        glUniform1f(accum_weight_, accumulator_.weight());
+        draw_fullscreen_triangle();
+
+        scene_tex_ = history_tex_[history_cur_];
+    }
+
+    if (scaled) {
+        glBindFramebuffer(GL_FRAMEBUFFER, upsample_fbo_);
+        glViewport(0, 0, fb_width_, fb_height_);
+        glUseProgram(upsample_prog_);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, scene_tex_);
+        glUniform1i(up_scaled_, 0);
+        glUniform1i(up_exact_, (u.long_steps || (occupancy && adaptive_steps_)) ? 1 : 0);
+        glUniform1f(up_sigma_, kUpsampleSigma);
+        glUniformMatrix4fv(up_inv_vp_, 1, GL_FALSE, u.inv_view_proj.data());
+        glUniform3f(up_camera_pos_, u.camera_pos.x, u.camera_pos.y, u.camera_pos.z);
+        glUniform1f(up_bounding_r_, u.bounding_radius);
+        glUniform1i(up_max_steps_, u.max_steps);
+        glUniform1f(up_jitter_, u.jitter);
+        draw_fullscreen_triangle();
+        scene_tex_ = upsample_tex_;
+    }
+
+    if (timed) {
+        glEndQuery(GL_TIME_ELAPSED);
+        timer_pending_[timer_next_] = true;
+        timer_next_ = (timer_next_ + 1) % kTimerQueries;
+    }
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+void Renderer::set_progressive(bool on) {
+    if (on != progressive_) accumulator_.reset();
+    progressive_ = on;
+}
+
+void Renderer::set_adaptive_steps(bool on) {
+    if (on != adaptive_steps_) accumulator_.reset();
+    adaptive_steps_ = on;
+}
+
+void Renderer::set_psi_volume(const PsiVolume* vol) {
+    if (vol != volume_) accumulator_.reset();
+    volume_ = vol;
+    volume_tex_ = 0;
+    if (!vol) return;
+
+    GLuint& tex = grid_textures_[vol->psi.data()];
+    if (!tex) tex = create_grid_texture(vol->resolution, vol->psi.data(), GL_LINEAR);
+    volume_tex_ = tex;
+}
+
+void Renderer::set_orbital_lut(const OrbitalLut* lut) {
+    if (lut != lut_) accumulator_.reset();
+    lut_ = lut;
+    radial_lut_tex_ = angular_lut_tex_ = 0;
+    if (!lut) return;
+
+    GLuint& radial = grid_textures_[lut->radial.data()];
+    if (!radial) {
+        glGenTextures(1, &radial);
+        glBindTexture(GL_TEXTURE_1D, radial);
+        glTexImage1D(GL_TEXTURE_1D, 0, GL_R32F, lut->radial_size, 0, GL_RED, GL_FLOAT,
+                     lut->radial.data());
+        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_1D, 0);
+    }
+    GLuint& angular = grid_textures_[lut->angular.data()];
+    if (!angular) {
+        glGenTextures(1, &angular);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, angular);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R32F, lut->face_size, lut->face_size, 6, 0,
+                     GL_RED, GL_FLOAT, lut->angular.data());
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+    radial_lut_tex_  = radial;
+    angular_lut_tex_ = angular;
+}
+
+void Renderer::set_superposition(const Superposition* s) {
+    if (s != superposition_) {
+        accumulator_.reset();
+        weights_valid_ = false;
+    }
+    superposition_ = s;
+    if (!s || s->version() == basis_version_) return;
+
+    // A rebuild may reuse the same buffer, so this texture is not keyed by
+    // its data like the psi grids but replaced per basis version
+    if (basis_tex_) glDeleteTextures(1, &basis_tex_);
+    basis_tex_ = create_grid_texture(s->resolution(), s->basis().data(), GL_LINEAR,
+                                     GL_RGBA32F, GL_RGBA);
+    basis_version_ = s->version();
+    accumulator_.reset();
+}
+
+void Renderer::set_occupancy(const OccupancyGrid* grid) {
+    if (grid != occupancy_) accumulator_.reset();
+    occupancy_ = grid;
+    occupancy_tex_ = 0;
+    if (!grid) return;
+
+    GLuint& tex = grid_textures_[grid->max_density.data()];
+    if (!tex) tex = create_grid_texture(grid->resolution, grid->max_density.data(), GL_NEAREST);
+    occupancy_tex_ = tex;
+}
+
 void Renderer::draw_bloom() {
     int hw = fb_width_ / 2, hh = fb_height_ / 2;
     if (hw < 1) hw = 1;
@@ -523,7 +1159,7 @@ void Renderer::draw_bloom() {
 
     glUseProgram(bright_prog_);
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, hdr_tex_);
+    glBindTexture(GL_TEXTURE_2D, scene_tex_);
     glUniform1i(bright_scene_, 0);
     glUniform1f(bright_threshold_, 0.8f);
     draw_fullscreen_triangle();
@@ -565,7 +1201,7 @@ void Renderer::draw_composite(float bloom_intensity) {
     glUseProgram(composite_prog_);
 
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, hdr_tex_);
+    glBindTexture(GL_TEXTURE_2D, scene_tex_);
     glUniform1i(comp_scene_, 0);
 
     glActiveTexture(GL_TEXTURE1);
@@ -579,6 +1215,20 @@ void Renderer::draw_composite(float bloom_intensity) {
     draw_fullscreen_triangle();
 }
 
+void Renderer::read_hdr(HdrImage& out) {
+    out.resize(fb_width_, fb_height_);
+    HdrImage flipped;
+    flipped.resize(fb_width_, fb_height_);
+
+    glBindTexture(GL_TEXTURE_2D, scene_tex_);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_FLOAT, flipped.pixels.data());
+
+    // GL rows run bottom-up
+    for (int y = 0; y < fb_height_; ++y)
+        std::copy(flipped.row(y), flipped.row(y) + fb_width_ * 3, out.row(fb_height_ - 1 - y));
+}
+
 void Renderer::draw_text(const char* text, float x, float y, float scale,
                          float r, float g, float b,
                          int win_w, int win_h) {
@@ -607,12 +1257,24 @@ void Renderer::draw_text(const char* text, float x, float y, float scale,
 }
 
 void Renderer::cleanup() {
-    if (raymarch_prog_)  glDeleteProgram(raymarch_prog_);
+    if (raymarch_generic_.prog) glDeleteProgram(raymarch_generic_.prog);
+    if (raymarch_volume_.prog)  glDeleteProgram(raymarch_volume_.prog);
+    if (raymarch_lut_.prog)     glDeleteProgram(raymarch_lut_.prog);
+    if (raymarch_superposition_.prog) glDeleteProgram(raymarch_superposition_.prog);
+    for (auto& p : raymarch_orbital_)
+        if (p.prog) glDeleteProgram(p.prog);
     if (bright_prog_)    glDeleteProgram(bright_prog_);
     if (blur_prog_)      glDeleteProgram(blur_prog_);
     if (composite_prog_) glDeleteProgram(composite_prog_);
+    if (accum_prog_)     glDeleteProgram(accum_prog_);
+    if (upsample_prog_)  glDeleteProgram(upsample_prog_);
+    glDeleteQueries(kTimerQueries, timer_queries_);
     if (text_shader_)    glDeleteProgram(text_shader_);
 
+    for (auto& [data, tex] : grid_textures_) glDeleteTextures(1, &tex);
+    grid_textures_.clear();
+    if (basis_tex_) glDeleteTextures(1, &basis_tex_);
+
     if (empty_vao_)    glDeleteVertexArrays(1, &empty_vao_);
     if (text_vao_)     glDeleteVertexArrays(1, &text_vao_);
     if (text_vbo_)     glDeleteBuffers(1, &text_vbo_);
@@ -620,6 +1282,12 @@ void Renderer::cleanup() {
 
     if (hdr_fbo_)      glDeleteFramebuffers(1, &hdr_fbo_);
     if (hdr_tex_)      glDeleteTextures(1, &hdr_tex_);
+    if (upsample_fbo_) glDeleteFramebuffers(1, &upsample_fbo_);
+    if (upsample_tex_) glDeleteTextures(1, &upsample_tex_);
+    for (int i = 0; i < 2; ++i) {
+        if (history_fbo_[i]) glDeleteFramebuffers(1, &history_fbo_[i]);
+        if (history_tex_[i]) glDeleteTextures(1, &history_tex_[i]);
+    }
     if (bloom_fbo_a_)  glDeleteFramebuffers(1, &bloom_fbo_a_);
     if (bloom_tex_a_)  glDeleteTextures(1, &bloom_tex_a_);
     if (bloom_fbo_b_)  glDeleteFramebuffers(1, &bloom_fbo_b_);
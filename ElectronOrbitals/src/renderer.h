@@ -1,20 +1,17 @@
 #pragma once
 #include "mat4.h"
+#include "raymarch_params.h"
+#include "progressive.h"
+#include "dynamic_resolution.h"
+#include "hdr_image.h"
+#include "orbital_kernels.h"
+#include "psi_volume.h"
+#include "superposition.h"
+#include "orbital_lut.h"
+#include "occupancy_grid.h"
 #include <glad/gl.h>
 #include <cstddef>
-
-struct RaymarchUniforms {
-    mat4  inv_view_proj;
-    vec3  camera_pos;
-    int   n, l, m;
-    float radial_norm;
-    float angular_norm;
-    float bounding_radius;
-    float density_scale;
-    int   max_steps;
-    float time;
-    float anim_speed;
-};
+#include <unordered_map>
 
 class Renderer {
 public:
@@ -26,6 +23,62 @@ public:
     void draw_bloom();
     void draw_composite(float bloom_intensity);
 
+    // Per-orbital ray march shaders (generated from Orbital<n,l,m>, built on
+    // first use) versus the generic one that branches on u_l / u_m.
+    void set_specialized_shaders(bool on) { specialized_shaders_ = on; }
+    bool specialized_shaders() const { return specialized_shaders_; }
+
+    // Sample psi from a 3D texture of this grid instead of evaluating it;
+    // nullptr goes back to the analytic shaders. Each volume is uploaded
+    // once (the first time it is passed in) and kept until cleanup(), so
+    // the volume must stay alive as long as the renderer.
+    void set_psi_volume(const PsiVolume* vol);
+
+    // Sample psi from separable radial / angular tables (orbital_lut.h): a
+    // 1D texture and a six-layer 2D array texture, uploaded once per table
+    // like psi volumes. A psi volume takes precedence; nullptr goes back to
+    // the analytic shaders.
+    void set_orbital_lut(const OrbitalLut* lut);
+
+    // Render a built superposition (see superposition.h) instead of the
+    // frame's orbital. Its packed basis is uploaded as an RGBA32F 3D
+    // texture once per build() and the shader weights each filtered texel with the frame's
+    // complex weights. Takes precedence over set_psi_volume() and disables
+    // the occupancy grid; nullptr goes back to single orbitals.
+    void set_superposition(const Superposition* s);
+
+    // Empty-space skipping with this grid (uploaded once, like psi volumes);
+    // nullptr marches every lattice sample.
+    void set_occupancy(const OccupancyGrid* grid);
+
+    // With an occupancy grid, size steps from its density bounds instead of
+    // skipping on the uniform lattice (see CpuRenderer::set_adaptive).
+    void set_adaptive_steps(bool on);
+    bool adaptive_steps() const { return adaptive_steps_; }
+
+    // Progressive refinement (see progressive.h and CpuRenderer): each
+    // draw_raymarch() marches fewer, jittered steps and blends them into an
+    // RGBA32F history, which bloom, composite and read_hdr() then use.
+    void set_progressive(bool on);
+    bool progressive() const { return progressive_; }
+    int  progressive_frames() const { return progressive_ ? accumulator_.frames() : 0; }
+
+    // Ray march at scale x scale of the framebuffer (clamped to
+    // [kMinRenderScale, 1]), upsampled to full size before bloom and
+    // composite (see dynamic_resolution.h); ResolutionScaler picks the
+    // scale from poll_march_time().
+    void  set_render_scale(float scale);
+    float render_scale() const { return render_scale_; }
+
+    // GPU time of the ray march passes (march, accumulate, upsample) from
+    // GL_TIME_ELAPSED queries, and the scale they ran at. Results trail by
+    // a few frames; returns true once per new result.
+    bool poll_march_time(float& ms, float& scale);
+
+    // Read back the HDR ray march result (top row first), e.g. to compare
+    // against the CPU reference renderer.
+    void read_hdr(HdrImage& out);
+
     // 2D text overlay
     void draw_text(const char* text, float x, float y, float scale,
                    float r, float g, float b,
@@ -38,24 +91,128 @@ private:
     // Empty VAO for fullscreen triangle
     GLuint empty_vao_ = 0;
 
-    // Ray march program
-    GLuint raymarch_prog_    = 0;
-    GLint  rm_inv_vp_        = -1;
-    GLint  rm_camera_pos_    = -1;
-    GLint  rm_n_             = -1;
-    GLint  rm_l_             = -1;
-    GLint  rm_m_             = -1;
-    GLint  rm_radial_norm_   = -1;
-    GLint  rm_angular_norm_  = -1;
-    GLint  rm_bounding_r_    = -1;
-    GLint  rm_density_scale_ = -1;
-    GLint  rm_max_steps_     = -1;
-    GLint  rm_time_          = -1;
-    GLint  rm_anim_speed_    = -1;
-
-    // HDR FBO (full resolution)
+    // Ray march program and its uniform locations. Specialized programs
+    // compile the quantum numbers and norms away, so those locations are -1
+    // there and the glUniform calls are no-ops.
+    struct RaymarchProgram {
+        GLuint prog           = 0;
+        GLint  inv_vp         = -1;
+        GLint  camera_pos     = -1;
+        GLint  n              = -1;
+        GLint  l              = -1;
+        GLint  m              = -1;
+        GLint  radial_norm    = -1;
+        GLint  angular_norm   = -1;
+        GLint  bounding_r     = -1;
+        GLint  density_scale  = -1;
+        GLint  max_steps      = -1;
+        GLint  time           = -1;
+        GLint  anim_speed     = -1;
+        GLint  jitter         = -1;
+        GLint  long_steps     = -1;
+        GLint  defer_nucleus  = -1;
+        GLint  psi_volume     = -1;
+        GLint  volume_extent  = -1;
+        GLint  radial_lut     = -1;
+        GLint  angular_lut    = -1;
+        GLint  lut_r_max      = -1;
+        GLint  lut_radial_size = -1;
+        GLint  lut_face_size  = -1;
+        GLint  basis          = -1;
+        GLint  weight_re      = -1;
+        GLint  weight_im      = -1;
+        GLint  skip_empty     = -1;
+        GLint  occupancy      = -1;
+        GLint  occ_res        = -1;
+        GLint  occ_extent     = -1;
+        GLint  occ_threshold  = -1;
+        GLint  adaptive       = -1;
+        GLint  adaptive_thr   = -1;
+        GLint  laguerre_steps = -1;
+        GLint  laguerre       = -1;
+        GLint  legendre_steps = -1;
+        GLint  legendre       = -1;
+        GLint  psi_norm       = -1;
+
+        // Orbital whose recurrence tables are loaded (generic program only)
+        int    tables_n = 0, tables_l = 0, tables_m = 0;
+
+        void build(const char* psi_src);
+    };
+
+    RaymarchProgram raymarch_generic_;
+    RaymarchProgram raymarch_orbital_[kSpecializedCount];
+    RaymarchProgram raymarch_volume_;
+    RaymarchProgram raymarch_lut_;
+    RaymarchProgram raymarch_superposition_;
+    bool            specialized_shaders_ = true;
+
+    // Uploaded psi / occupancy grids (GL_R32F 3D textures) and orbital
+    // tables, keyed by their data, and the ones in use
+    std::unordered_map<const float*, GLuint> grid_textures_;
+    const PsiVolume*     volume_        = nullptr;
+    GLuint               volume_tex_    = 0;
+    const OrbitalLut*    lut_           = nullptr;
+    GLuint               radial_lut_tex_  = 0;
+    GLuint               angular_lut_tex_ = 0;
+    const OccupancyGrid* occupancy_     = nullptr;
+    const Superposition* superposition_ = nullptr;
+    GLuint               basis_tex_     = 0;      // superposition_'s basis
+    int                  basis_version_ = -1;
+    float                weights_time_  = 0.0f;   // frame time the history was reset for
+    bool                 weights_valid_ = false;
+    GLuint               occupancy_tex_ = 0;
+    bool                 adaptive_steps_ = false;
+
+    RaymarchProgram& raymarch_program(const RaymarchUniforms& u);
+
+    // HDR FBO (ray march target, render scale x framebuffer size)
     GLuint hdr_fbo_ = 0;
     GLuint hdr_tex_ = 0;
+    int    march_width_  = 0;
+    int    march_height_ = 0;
+    float  render_scale_ = 1.0f;
+
+    void resize_march_targets();
+
+    // Upsample to full resolution (allocated on first use below scale 1)
+    GLuint upsample_fbo_   = 0;
+    GLuint upsample_tex_   = 0;
+    GLuint upsample_prog_  = 0;
+    GLint  up_scaled_      = -1;
+    GLint  up_exact_       = -1;
+    GLint  up_sigma_       = -1;
+    GLint  up_inv_vp_      = -1;
+    GLint  up_camera_pos_  = -1;
+    GLint  up_bounding_r_  = -1;
+    GLint  up_max_steps_   = -1;
+    GLint  up_jitter_      = -1;
+
+    // Ring of GL_TIME_ELAPSED queries around the ray march passes
+    static constexpr int kTimerQueries = 4;
+    GLuint timer_queries_[kTimerQueries] = {};
+    float  timer_scales_[kTimerQueries]  = {};
+    bool   timer_pending_[kTimerQueries] = {};
+    int    timer_next_   = 0;
+    float  timing_ms_    = 0.0f;
+    float  timing_scale_ = 1.0f;
+    bool   timing_ready_ = false;
+
+    // Progressive history (RGBA32F at the march size, ping-pong; allocated
+    // on first use) and the accumulate program
+    bool                   progressive_ = false;
+    ProgressiveAccumulator accumulator_;
+    GLuint history_fbo_[2] = {};
+    GLuint history_tex_[2] = {};
+    int    history_cur_    = 0;
+    GLuint accum_prog_     = 0;
+    GLint  accum_frame_    = -1;
+    GLint  accum_history_  = -1;
+    GLint  accum_weight_   = -1;
+
+    // Image the post passes read: hdr_tex_, the history when progressive,
+    // or the upsampled image below full scale
+    GLuint scene_tex_ = 0;
 
     // Bright pass program
     GLuint bright_prog_      = 0;
@@ -0,0 +1,145 @@
+#include "superposition.h"
+#include "parallel.h"
+#include "fast_math.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// --- Sampling ----------------------------------------------------------------
+
+float SuperpositionFrame::sample(vec3 pos) const {
+    // Same voxel coordinates as PsiVolume::sample(), two channels
+    float scale = 0.5f * static_cast<float>(resolution) / extent;
+    float half  = 0.5f * static_cast<float>(resolution) - 0.5f;
+    float hi    = static_cast<float>(resolution - 1);
+    float fx = std::clamp(pos.x * scale + half, 0.0f, hi);
+    float fy = std::clamp(pos.y * scale + half, 0.0f, hi);
+    float fz = std::clamp(pos.z * scale + half, 0.0f, hi);
+
+    int x0 = std::min(static_cast<int>(fx), resolution - 2);
+    int y0 = std::min(static_cast<int>(fy), resolution - 2);
+    int z0 = std::min(static_cast<int>(fz), resolution - 2);
+    float tx = fx - static_cast<float>(x0);
+    float ty = fy - static_cast<float>(y0);
+    float tz = fz - static_cast<float>(z0);
+
+    std::size_t sx = 2, sy = 2 * static_cast<std::size_t>(resolution), sz = sy * resolution;
+    const float* c = psi.data() + z0 * sz + y0 * sy + x0 * sx;
+
+    float v[2];
+    for (int ch = 0; ch < 2; ++ch, ++c) {
+        float c00 = c[0]       + (c[sx]           - c[0])       * tx;
+        float c10 = c[sy]      + (c[sy + sx]      - c[sy])      * tx;
+        float c01 = c[sz]      + (c[sz + sx]      - c[sz])      * tx;
+        float c11 = c[sz + sy] + (c[sz + sy + sx] - c[sz + sy]) * tx;
+        float c0 = c00 + (c10 - c00) * ty;
+        float c1 = c01 + (c11 - c01) * ty;
+        v[ch] = c0 + (c1 - c0) * tz;
+    }
+    return superposition_psi(v[0], v[1]);
+}
+
+void eval_packet_superposition(const SuperpositionFrame& frame, const PacketParams& p,
+                               vec3 ro, vec3 rd, SamplePacket& io) {
+    for (int i = 0; i < kPacketWidth; ++i) {
+        vec3  pos = ro + rd * io.t[i];
+        float d2 = dot(pos, pos);
+        float r = std::sqrt(d2);
+
+        float psi = frame.sample(pos);
+        float density = psi * psi * p.density_scale;
+        density *= 1.0f + 0.06f * fast_sin(p.phase + r * 4.0f
+                                           + dot(pos, vec3{1.7f, 2.3f, 3.1f}));
+        io.psi[i] = psi;
+        io.density[i] = density;
+        io.dist_sq[i] = d2;
+    }
+}
+
+// --- Terms -------------------------------------------------------------------
+
+bool Superposition::add(const OrbitalInfo& orb, float amplitude, float phase) {
+    if (count() >= kMaxSuperpositionTerms) {
+        std::fprintf(stderr, "Superposition holds at most %d orbitals, ignoring %s\n",
+                     kMaxSuperpositionTerms, orb.name);
+        return false;
+    }
+    terms_.push_back({orb, amplitude, phase});
+    resolution_ = 0;
+    return true;
+}
+
+void Superposition::clear() {
+    terms_.clear();
+    resolution_ = 0;
+    basis_.clear();
+}
+
+float Superposition::extent() const {
+    float e = 0.0f;
+    for (const auto& t : terms_) e = std::max(e, t.orbital.bounding_radius);
+    return e;
+}
+
+void Superposition::build(PsiVolumeCache& cache, int resolution) {
+    grid_extent_ = extent();
+    resolution_  = std::max(resolution, 2);
+    const std::size_t voxels = static_cast<std::size_t>(resolution_) * resolution_ * resolution_;
+    basis_.assign(voxels * kMaxSuperpositionTerms, 0.0f);
+
+    for (int k = 0; k < count(); ++k) {
+        // Every term on the shared cube, so voxel i means the same point
+        OrbitalInfo orb = terms_[k].orbital;
+        orb.bounding_radius = grid_extent_;
+        const PsiVolume& vol = cache.get(orb, resolution_);
+        for (std::size_t i = 0; i < voxels; ++i)
+            basis_[i * kMaxSuperpositionTerms + k] = vol.psi[i];
+    }
+    ++version_;
+}
+
+void Superposition::weights(float time, float re[kMaxSuperpositionTerms],
+                            float im[kMaxSuperpositionTerms]) const {
+    double norm = 0.0;
+    for (const auto& t : terms_) norm += static_cast<double>(t.amplitude) * t.amplitude;
+    norm = (norm > 0.0) ? 1.0 / std::sqrt(norm) : 0.0;
+
+    // Phases in double: t grows without bound while the beat stays small
+    const double tau = static_cast<double>(time) * kSuperpositionTimeScale;
+    const double e0  = terms_.empty() ? 0.0 : orbital_energy(terms_[0].orbital.n);
+    for (int k = 0; k < kMaxSuperpositionTerms; ++k) {
+        re[k] = im[k] = 0.0f;
+        if (k >= count()) continue;
+        const auto& t = terms_[k];
+        double phase = t.phase - (orbital_energy(t.orbital.n) - e0) * tau;
+        re[k] = static_cast<float>(t.amplitude * norm * std::cos(phase));
+        im[k] = static_cast<float>(t.amplitude * norm * std::sin(phase));
+    }
+}
+
+void Superposition::combine(float time, SuperpositionFrame& out) const {
+    const int res = resolution_;
+    out.resolution = res;
+    out.extent = grid_extent_;
+    out.time = time;
+    out.version = version_;
+    out.psi.resize(static_cast<std::size_t>(res) * res * res * 2);
+
+    float re[kMaxSuperpositionTerms], im[kMaxSuperpositionTerms];
+    weights(time, re, im);
+
+    const std::size_t slice = static_cast<std::size_t>(res) * res;
+    parallel_for(res, [&](int z) {
+        const float* b = basis_.data() + z * slice * kMaxSuperpositionTerms;
+        float*       o = out.psi.data() + z * slice * 2;
+        for (std::size_t i = 0; i < slice; ++i, b += kMaxSuperpositionTerms, o += 2) {
+            float r = 0.0f, j = 0.0f;
+            for (int k = 0; k < kMaxSuperpositionTerms; ++k) {
+                r += b[k] * re[k];
+                j += b[k] * im[k];
+            }
+            o[0] = r;
+            o[1] = j;
+        }
+    });
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "vec3.h"
+#include "orbital.h"
+#include "psi_volume.h"
+#include "wavefunction_simd.h"
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Time-dependent superpositions psi(t) = sum_k c_k psi_k exp(-i E_k t) of
+// up to kMaxSuperpositionTerms orbitals, E_n = -1 / (2 n^2) hartree. The
+// basis functions are real, so each one is sampled once on a psi grid
+// (PsiVolumeCache, all on the largest bounding cube) and a frame only
+// needs a complex weight per term: Re and Im psi are two weighted sums of
+// the same voxels. The density |psi|^2 oscillates at the energy
+// differences, e.g. a 1s + 2p_z dipole swinging along z.
+constexpr int kMaxSuperpositionTerms = 4;   // one RGBA texel on the GPU
+
+// Atomic time units per second of animation time; the 1s - 2p beat
+// (delta E = 3/8 hartree) then has a period of about 4 s
+constexpr float kSuperpositionTimeScale = 4.0f;
+
+inline float orbital_energy(int n) {
+    return -0.5f / static_cast<float>(n * n);
+}
+
+// The signed value the ray march colors and squares: |psi| with the sign
+// of Re psi, so the density is |psi|^2 and the two-tone palette follows
+// the phase. A single term renders exactly like its own psi grid.
+inline float superposition_psi(float re, float im) {
+    return std::copysign(std::sqrt(re * re + im * im), re);
+}
+
+struct SuperpositionTerm {
+    OrbitalInfo orbital;
+    float       amplitude;   // |c_k| before normalization
+    float       phase;       // arg c_k at t = 0, radians
+};
+
+// (Re, Im) psi of a superposition at one time, on its basis grid
+struct SuperpositionFrame {
+    int   resolution = 0;
+    float extent     = 0.0f;
+    float time       = 0.0f;    // animation time it was combined for
+    int   version    = -1;      // Superposition::version() it was combined from
+    std::vector<float> psi;     // resolution^3 (re, im) pairs, x fastest
+
+    // Trilinear (re, im), clamped like PsiVolume::sample(), then
+    // superposition_psi()
+    float sample(vec3 pos) const;
+};
+
+class Superposition {
+public:
+    // Appends c = amplitude * exp(i phase) times the orbital's psi; false
+    // (and an error) once kMaxSuperpositionTerms are in use
+    bool add(const OrbitalInfo& orb, float amplitude, float phase = 0.0f);
+    void clear();
+
+    int count() const { return static_cast<int>(terms_.size()); }
+    const SuperpositionTerm& term(int k) const { return terms_[k]; }
+
+    // Half-size of the shared grid: the largest term's bounding radius
+    float extent() const;
+
+    // Gets every term's psi on the shared grid from the cache and packs
+    // them four floats per voxel (unused terms 0). Call after the last add().
+    void build(PsiVolumeCache& cache, int resolution);
+    bool built() const { return resolution_ > 0; }
+
+    // Bumped by every build(), so renderers can tell a rebuilt basis from
+    // the one they uploaded or combined
+    int version() const { return version_; }
+
+    int   resolution() const { return resolution_; }
+    float grid_extent() const { return grid_extent_; }
+    const std::vector<float>& basis() const { return basis_; }   // resolution^3 x 4
+
+    // Complex weights c_k exp(-i E_k t) at animation time t, amplitudes
+    // normalized to sum |c_k|^2 = 1. The first term's energy is factored
+    // out as a global phase, so a first term added at phase 0 stays real.
+    // Unused terms get 0.
+    void weights(float time, float re[kMaxSuperpositionTerms],
+                 float im[kMaxSuperpositionTerms]) const;
+
+    // Per-voxel combination at time t, one z slice per work item
+    void combine(float time, SuperpositionFrame& out) const;
+
+private:
+    std::vector<SuperpositionTerm> terms_;
+    int                resolution_  = 0;
+    int                version_     = 0;
+    float              grid_extent_ = 0.0f;
+    std::vector<float> basis_;
+};
+
+// Packet kernel contract (see eval_packet_volume) with psi from a combined
+// superposition frame; the shimmer term is still applied per sample.
+void eval_packet_superposition(const SuperpositionFrame& frame, const PacketParams& p,
+                               vec3 ro, vec3 rd, SamplePacket& io);
@@ -0,0 +1,131 @@
+#pragma once
+#include "vec3.h"
+#include "fast_math.h"
+#include "orbital.h"
+
+// CPU port of the wave-function evaluation in the generic ray march shader
+// (kRaymarchGenericPsiFS, renderer.cpp). Kept statement-for-statement with
+// the GLSL so the CPU renderer can act as a reference for shader changes;
+// keep the two in sync.
+
+// Longest recurrence the tables hold. Both n - l - 1 and l - |m| are below
+// n, so this covers every orbital up to n = kMaxRecurrenceSteps + 1.
+constexpr int kMaxRecurrenceSteps = 8;
+static_assert(OrbitalCatalog::kMaxN - 1 <= kMaxRecurrenceSteps, "catalog outgrows the tables");
+
+// Three-term recurrence coefficients for one orbital, built once and shared
+// by every sample (uploaded as uniform arrays for the generic shader):
+//
+//   L_(i+1) = (a_i - b_i rho) L_i - c_i L_(i-1)    L_(-1) = 0, L_0 = 1
+//   Q_(j+1) = d_j w Q_j - e_j Q_(j-1)              Q_(-1) = 0, Q_0 = 1
+//
+// L ends as the associated Laguerre polynomial L^(2l+1)_(n-l-1)(rho). Q
+// ends as P_l^|m|(w) / (1 - w^2)^(|m|/2), scaled so Q_0 = 1; norm absorbs
+// the (2|m|-1)!! that P_|m|^|m| really starts from. The dropped
+// (1 - w^2)^(|m|/2) times cos or sin(|m| phi) is Re or Im of (u + iv)^|m|,
+// built by the multiple-angle recurrence, so no trigonometry is needed.
+// No Condon-Shortley phase, matching the l = 1 table (p_x = x / r).
+struct PsiRecurrence {
+    int   n = 0, l = 0, m = 0;
+    int   laguerre_steps = 0;                     // n - l - 1
+    float laguerre[kMaxRecurrenceSteps][3] = {};  // (a_i, b_i, c_i)
+    int   legendre_steps = 0;                     // l - |m|
+    float legendre[kMaxRecurrenceSteps][2] = {};  // (d_j, e_j)
+    float norm = 0.0f;                            // radial * angular * (2|m|-1)!!
+};
+
+inline PsiRecurrence make_psi_recurrence(int n, int l, int m, float radial_norm, float angular_norm) {
+    PsiRecurrence rc;
+    rc.n = n;
+    rc.l = l;
+    rc.m = m;
+
+    int alpha = 2 * l + 1;
+    rc.laguerre_steps = n - l - 1;
+    for (int i = 0; i < rc.laguerre_steps; ++i) {
+        float inv = 1.0f / static_cast<float>(i + 1);
+        rc.laguerre[i][0] = static_cast<float>(2 * i + 1 + alpha) * inv;
+        rc.laguerre[i][1] = inv;
+        rc.laguerre[i][2] = static_cast<float>(i + alpha) * inv;
+    }
+
+    int am = m < 0 ? -m : m;
+    rc.legendre_steps = l - am;
+    for (int s = 0; s < rc.legendre_steps; ++s) {
+        int   j = am + 1 + s;                       // degree this step produces
+        float inv = 1.0f / static_cast<float>(j - am);
+        rc.legendre[s][0] = static_cast<float>(2 * j - 1) * inv;
+        rc.legendre[s][1] = static_cast<float>(j + am - 1) * inv;
+    }
+
+    double double_factorial = 1.0;
+    for (int i = 3; i <= 2 * am - 1; i += 2) double_factorial *= i;
+    rc.norm = static_cast<float>(radial_norm * static_cast<double>(angular_norm) * double_factorial);
+    return rc;
+}
+
+inline PsiRecurrence make_psi_recurrence(const OrbitalInfo& orb) {
+    return make_psi_recurrence(orb.n, orb.l, orb.m, orb.radial_norm, orb.angular_norm);
+}
+
+// L^(2l+1)_(n-l-1)(rho) by the Laguerre recurrence
+inline float laguerre_recurrence(const PsiRecurrence& rc, float rho) {
+    float L0 = 0.0f, L1 = 1.0f;
+    for (int i = 0; i < rc.laguerre_steps; ++i) {
+        float L2 = (rc.laguerre[i][0] - rc.laguerre[i][1] * rho) * L1 - rc.laguerre[i][2] * L0;
+        L0 = L1;
+        L1 = L2;
+    }
+    return L1;
+}
+
+// Q(w) = P_l^|m|(w) / ((2|m|-1)!! (1 - w^2)^(|m|/2)), upward in l at fixed |m|
+inline float legendre_recurrence(const PsiRecurrence& rc, float w) {
+    float Q0 = 0.0f, Q1 = 1.0f;
+    for (int j = 0; j < rc.legendre_steps; ++j) {
+        float Q2 = rc.legendre[j][0] * w * Q1 - rc.legendre[j][1] * Q0;
+        Q0 = Q1;
+        Q1 = Q2;
+    }
+    return Q1;
+}
+
+// psi_nlm at pos, r = |pos|
+inline float eval_psi(const PsiRecurrence& rc, vec3 pos, float r) {
+    if (r < 1e-10f) return 0.0f;
+    float rho = 2.0f * r / static_cast<float>(rc.n);
+
+    // Radial: Laguerre recurrence
+    float L = laguerre_recurrence(rc, rho);
+
+    // Azimuthal: (c + is) = (u + iv)^|m|
+    float u = pos.x / r, v = pos.y / r, w = pos.z / r;
+    float c = 1.0f, s = 0.0f;
+    for (int i = 0; i < (rc.m < 0 ? -rc.m : rc.m); ++i) {
+        float cn = c * u - s * v;
+        s = s * u + c * v;
+        c = cn;
+    }
+
+    // Polar: Legendre recurrence upward in l at fixed |m|
+    float Q = legendre_recurrence(rc, w);
+
+    float Y = Q * ((rc.m < 0) ? s : c);
+    return rc.norm * fast_exp(-rho * 0.5f) * fast_ipow(rho, rc.l) * L * Y;
+}
+
+// Two-tone color palette
+inline vec3 color_palette(float psi, float density) {
+    constexpr vec3 deep_blue    = {0.05f, 0.15f, 0.4f};
+    constexpr vec3 teal         = {0.1f, 0.6f, 0.8f};
+    constexpr vec3 deep_magenta = {0.4f, 0.05f, 0.3f};
+    constexpr vec3 coral        = {0.9f, 0.4f, 0.3f};
+
+    float intensity = density;
+    float t = intensity * 2.0f < 1.0f ? intensity * 2.0f : 1.0f;
+    vec3 base = (psi > 0.0f) ? deep_blue + (teal - deep_blue) * t
+                             : deep_magenta + (coral - deep_magenta) * t;
+    // Hot white core for high density
+    float hot = intensity - 0.5f > 0.0f ? (intensity - 0.5f) * 3.0f : 0.0f;
+    return base + vec3{hot, hot, hot};
+}
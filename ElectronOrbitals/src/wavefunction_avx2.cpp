@@ -0,0 +1,170 @@
+// AVX2 + FMA packet kernel. Compiled with -mavx2 -mfma (see CMakeLists.txt)
+// and only called after select_packet_kernel() has checked the CPU.
+
+#include "wavefunction_simd.h"
+#include "wavefunction.h"
+#include "orbital_kernels.h"
+#include "fast_math.h"
+#include <immintrin.h>
+#include <utility>
+
+static inline __m256 splat(float v) { return _mm256_set1_ps(v); }
+
+// fast_exp, eight lanes at a time
+static inline __m256 exp8(__m256 x) {
+    x = _mm256_min_ps(x, splat(kFastExpMax));
+    x = _mm256_max_ps(x, splat(kFastExpMin));
+
+    __m256 fn = _mm256_round_ps(_mm256_mul_ps(x, splat(kFastLog2e)),
+                                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(fn, splat(kFastLn2Hi), x);
+    r = _mm256_fnmadd_ps(fn, splat(kFastLn2Lo), r);
+    __m256 z = _mm256_mul_ps(r, r);
+
+    __m256 y = splat(kFastExpP0);
+    y = _mm256_fmadd_ps(y, r, splat(kFastExpP1));
+    y = _mm256_fmadd_ps(y, r, splat(kFastExpP2));
+    y = _mm256_fmadd_ps(y, r, splat(kFastExpP3));
+    y = _mm256_fmadd_ps(y, r, splat(kFastExpP4));
+    y = _mm256_fmadd_ps(y, r, splat(kFastExpP5));
+    y = _mm256_fmadd_ps(y, z, _mm256_add_ps(r, splat(1.0f)));
+
+    __m256i n = _mm256_cvtps_epi32(fn);
+    __m256i pow2 = _mm256_slli_epi32(_mm256_add_epi32(n, _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(pow2));
+}
+
+// fast_sin, eight lanes at a time
+static inline __m256 sin8(__m256 x) {
+    __m256 fj = _mm256_round_ps(_mm256_mul_ps(x, splat(kFastTwoOverPi)),
+                                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256i j = _mm256_cvtps_epi32(fj);
+    __m256 r = _mm256_fnmadd_ps(fj, splat(kFastPio2Hi), x);
+    r = _mm256_fnmadd_ps(fj, splat(kFastPio2Mid), r);
+    r = _mm256_fnmadd_ps(fj, splat(kFastPio2Lo), r);
+    __m256 z = _mm256_mul_ps(r, r);
+
+    __m256 s = _mm256_fmadd_ps(splat(kFastSinP0), z, splat(kFastSinP1));
+    s = _mm256_fmadd_ps(s, z, splat(kFastSinP2));
+    s = _mm256_fmadd_ps(_mm256_mul_ps(s, z), r, r);
+
+    __m256 c = _mm256_fmadd_ps(splat(kFastCosP0), z, splat(kFastCosP1));
+    c = _mm256_fmadd_ps(c, z, splat(kFastCosP2));
+    c = _mm256_fmadd_ps(_mm256_mul_ps(c, z), z, _mm256_fnmadd_ps(splat(0.5f), z, splat(1.0f)));
+
+    // Odd quadrants take the cosine branch; quadrants 2 and 3 flip the sign
+    __m256i one = _mm256_set1_epi32(1);
+    __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(j, one), one));
+    __m256 v = _mm256_blendv_ps(s, c, swap);
+    __m256i sign = _mm256_slli_epi32(_mm256_and_si256(j, _mm256_set1_epi32(2)), 30);
+    return _mm256_xor_ps(v, _mm256_castsi256_ps(sign));
+}
+
+// The eval_psi() recurrences, eight lanes at a time. The tables are
+// uniform across the packet, so only the values are vectors.
+
+static inline __m256 laguerre8(const PsiRecurrence& rc, __m256 rho) {
+    __m256 L0 = _mm256_setzero_ps();
+    __m256 L1 = splat(1.0f);
+    for (int i = 0; i < rc.laguerre_steps; ++i) {
+        __m256 a = _mm256_fnmadd_ps(splat(rc.laguerre[i][1]), rho, splat(rc.laguerre[i][0]));
+        __m256 L2 = _mm256_fnmadd_ps(splat(rc.laguerre[i][2]), L0, _mm256_mul_ps(a, L1));
+        L0 = L1;
+        L1 = L2;
+    }
+    return L1;
+}
+
+static inline __m256 angular8(const PsiRecurrence& rc, __m256 u, __m256 v, __m256 w) {
+    // (c + is) = (u + iv)^|m|
+    __m256 c = splat(1.0f);
+    __m256 s = _mm256_setzero_ps();
+    for (int i = 0; i < (rc.m < 0 ? -rc.m : rc.m); ++i) {
+        __m256 cn = _mm256_fmsub_ps(c, u, _mm256_mul_ps(s, v));
+        s = _mm256_fmadd_ps(s, u, _mm256_mul_ps(c, v));
+        c = cn;
+    }
+
+    __m256 Q0 = _mm256_setzero_ps();
+    __m256 Q1 = splat(1.0f);
+    for (int j = 0; j < rc.legendre_steps; ++j) {
+        __m256 dw = _mm256_mul_ps(splat(rc.legendre[j][0]), w);
+        __m256 Q2 = _mm256_fnmadd_ps(splat(rc.legendre[j][1]), Q0, _mm256_mul_ps(dw, Q1));
+        Q0 = Q1;
+        Q1 = Q2;
+    }
+    return _mm256_mul_ps(Q1, (rc.m < 0) ? s : c);
+}
+
+// Shared packet body: positions, sphere-origin guard, density and shimmer.
+// psi_fn(rho, u, v, w) returns psi without the constant norm and without
+// exp(-rho/2), which are applied here.
+template <typename PsiFn>
+static inline void eval_packet_avx2_impl(const PacketParams& p, vec3 ro, vec3 rd,
+                                         float rho_scale, float norm, SamplePacket& io,
+                                         PsiFn psi_fn) {
+    __m256 t = _mm256_loadu_ps(io.t);
+
+    __m256 x = _mm256_fmadd_ps(t, splat(rd.x), splat(ro.x));
+    __m256 y = _mm256_fmadd_ps(t, splat(rd.y), splat(ro.y));
+    __m256 z = _mm256_fmadd_ps(t, splat(rd.z), splat(ro.z));
+
+    __m256 d2 = _mm256_fmadd_ps(z, z, _mm256_fmadd_ps(y, y, _mm256_mul_ps(x, x)));
+    __m256 r = _mm256_sqrt_ps(d2);
+    __m256 valid = _mm256_cmp_ps(r, splat(1e-6f), _CMP_GE_OQ);
+    __m256 inv_r = _mm256_and_ps(valid, _mm256_div_ps(splat(1.0f), r));
+
+    // psi = norm * exp(-rho/2) * [rho^l * L(rho) * Y(u, v, w)]
+    __m256 rho = _mm256_mul_ps(r, splat(rho_scale));
+    __m256 scale = _mm256_mul_ps(splat(norm), exp8(_mm256_mul_ps(rho, splat(-0.5f))));
+    __m256 psi = _mm256_mul_ps(scale, psi_fn(rho, _mm256_mul_ps(x, inv_r),
+                                             _mm256_mul_ps(y, inv_r), _mm256_mul_ps(z, inv_r)));
+    psi = _mm256_and_ps(valid, psi);
+    __m256 density = _mm256_mul_ps(_mm256_mul_ps(psi, psi), splat(p.density_scale));
+
+    // Shimmer: 1 + 0.06 * sin(phase + 4r + dot(pos, (1.7, 2.3, 3.1)))
+    __m256 arg = _mm256_fmadd_ps(r, splat(4.0f), splat(p.phase));
+    arg = _mm256_fmadd_ps(x, splat(1.7f), arg);
+    arg = _mm256_fmadd_ps(y, splat(2.3f), arg);
+    arg = _mm256_fmadd_ps(z, splat(3.1f), arg);
+    density = _mm256_mul_ps(density, _mm256_fmadd_ps(splat(0.06f), sin8(arg), splat(1.0f)));
+
+    _mm256_storeu_ps(io.psi, psi);
+    _mm256_storeu_ps(io.density, density);
+    _mm256_storeu_ps(io.dist_sq, d2);
+}
+
+void eval_packet_avx2(const PacketParams& p, vec3 ro, vec3 rd, SamplePacket& io) {
+    const PsiRecurrence& rc = *p.recurrence;
+    float rho_scale = 2.0f / static_cast<float>(rc.n);
+    eval_packet_avx2_impl(p, ro, rd, rho_scale, rc.norm, io,
+                          [&](__m256 rho, __m256 u, __m256 v, __m256 w) {
+        __m256 R = laguerre8(rc, rho);
+        for (int i = 0; i < rc.l; ++i) R = _mm256_mul_ps(R, rho);
+        return _mm256_mul_ps(R, angular8(rc, u, v, w));
+    });
+}
+
+// --- Specialized kernels ------------------------------------------------------
+
+template <int N, int L, int M>
+static void eval_packet_avx2_orbital(const PacketParams& p, vec3 ro, vec3 rd, SamplePacket& io) {
+    using Orb = Orbital<N, L, M>;
+    eval_packet_avx2_impl(p, ro, rd, Orb::kRhoScale, p.radial_norm * p.angular_norm, io,
+                          [](__m256 rho, __m256 u, __m256 v, __m256 w) {
+        return Orb::radial_poly(rho) * Orb::angular(u, v, w);
+    });
+}
+
+template <std::size_t... I>
+static constexpr std::array<PacketKernel, sizeof...(I)> make_kernel_table(std::index_sequence<I...>) {
+    return {{&eval_packet_avx2_orbital<specialized_orbital(I).n,
+                                       specialized_orbital(I).l,
+                                       specialized_orbital(I).m>...}};
+}
+
+static constexpr auto kAvx2Kernels = make_kernel_table(std::make_index_sequence<kSpecializedCount>{});
+
+PacketKernel specialized_avx2_kernel(int index) {
+    return (index >= 0 && index < kSpecializedCount) ? kAvx2Kernels[index] : nullptr;
+}
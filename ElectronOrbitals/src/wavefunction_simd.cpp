@@ -0,0 +1,70 @@
+#include "wavefunction_simd.h"
+#include "wavefunction.h"
+#include "orbital_kernels.h"
+#include "fast_math.h"
+#include <cmath>
+
+// Specialized kernel tables, indexed by specialized_index()
+PacketKernel specialized_scalar_kernel(int index);
+
+#ifdef ORBITALS_HAVE_AVX2
+void eval_packet_avx2(const PacketParams& p, vec3 ro, vec3 rd, SamplePacket& io);
+PacketKernel specialized_avx2_kernel(int index);
+
+static bool cpu_has_avx2() {
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+#endif
+
+void eval_packet_scalar(const PacketParams& p, vec3 ro, vec3 rd, SamplePacket& io) {
+    for (int i = 0; i < kPacketWidth; ++i) {
+        vec3  pos = ro + rd * io.t[i];
+        float d2 = dot(pos, pos);
+        float r = std::sqrt(d2);
+        io.dist_sq[i] = d2;
+
+        if (r < 1e-6f) {
+            io.psi[i] = 0.0f;
+            io.density[i] = 0.0f;
+            continue;
+        }
+
+        float psi = eval_psi(*p.recurrence, pos, r);
+        float density = psi * psi * p.density_scale;
+        density *= 1.0f + 0.06f * fast_sin(p.phase + r * 4.0f
+                                           + dot(pos, vec3{1.7f, 2.3f, 3.1f}));
+        io.psi[i] = psi;
+        io.density[i] = density;
+    }
+}
+
+PacketKernel select_packet_kernel(bool allow_simd) {
+#ifdef ORBITALS_HAVE_AVX2
+    if (allow_simd && cpu_has_avx2()) return eval_packet_avx2;
+#endif
+    (void)allow_simd;
+    return eval_packet_scalar;
+}
+
+PacketKernel select_orbital_kernel(int n, int l, int m, bool allow_simd) {
+    int index = specialized_index(n, l, m);
+    if (index < 0) return select_packet_kernel(allow_simd);
+#ifdef ORBITALS_HAVE_AVX2
+    if (allow_simd && cpu_has_avx2()) return specialized_avx2_kernel(index);
+#endif
+    return specialized_scalar_kernel(index);
+}
+
+const char* packet_kernel_name(PacketKernel k) {
+    if (k == eval_packet_scalar) return "scalar";
+#ifdef ORBITALS_HAVE_AVX2
+    if (k == eval_packet_avx2) return "avx2";
+#endif
+    for (int i = 0; i < kSpecializedCount; ++i) {
+        if (k == specialized_scalar_kernel(i)) return "scalar specialized";
+#ifdef ORBITALS_HAVE_AVX2
+        if (k == specialized_avx2_kernel(i)) return "avx2 specialized";
+#endif
+    }
+    return "unknown";
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "vec3.h"
+
+// Packet evaluation of the wave function: kPacketWidth samples along one
+// ray per call. Samples along a ray share (n, l, m) and never
+// diverge, so the lanes run the Laguerre and Legendre recurrences, exp
+// and rho^l in lockstep; compositing stays sequential.
+constexpr int kPacketWidth = 8;
+
+struct PsiRecurrence;
+
+struct PacketParams {
+    int   n, l, m;
+    float radial_norm;
+    float angular_norm;
+    float density_scale;
+    float phase;                       // time * anim_speed, for the shimmer term
+    const PsiRecurrence* recurrence;   // tables for (n, l, m); generic kernels only
+};
+
+struct SamplePacket {
+    float t[kPacketWidth];         // in: ray parameter of each sample
+    float psi[kPacketWidth];
+    float density[kPacketWidth];   // |psi|^2 * scale * shimmer; 0 at the origin
+    float dist_sq[kPacketWidth];   // |pos|^2, for the nucleus glow
+};
+
+// Evaluates the samples at ro + rd * io.t[i] and fills the other fields.
+using PacketKernel = void (*)(const PacketParams& p, vec3 ro, vec3 rd, SamplePacket& io);
+
+// Portable reference: one lane at a time through wavefunction.h.
+void eval_packet_scalar(const PacketParams& p, vec3 ro, vec3 rd, SamplePacket& io);
+
+// Fastest generic kernel the running CPU supports (AVX2+FMA when built
+// with ORBITALS_HAVE_AVX2 and available at runtime, scalar otherwise).
+// allow_simd = false always returns the scalar kernel.
+PacketKernel select_packet_kernel(bool allow_simd = true);
+
+// Kernel compiled for this one orbital (Orbital<n,l,m>, orbital_kernels.h):
+// no l/m branches and an unrolled Laguerre polynomial. Falls back to
+// select_packet_kernel() for orbitals without a specialization.
+PacketKernel select_orbital_kernel(int n, int l, int m, bool allow_simd = true);
+
+const char* packet_kernel_name(PacketKernel k);
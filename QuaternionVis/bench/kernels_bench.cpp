@@ -0,0 +1,51 @@
+// Kernel microbenchmarks for quaternion interpolation (bench.h):
+//
+//   slerp  spherical interpolation between random unit quaternions
+//   nlerp  the normalized-lerp fallback, for comparison (lerp() in quat.h)
+
+#include "quat.h"
+#include "bench.h"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+constexpr int kCount = 1024;
+
+struct QuatPair {
+    quat  a, b;
+    float t;
+};
+
+static std::vector<QuatPair> random_pairs() {
+    std::srand(11);
+    auto r = [] { return 2.0f * static_cast<float>(std::rand()) / RAND_MAX - 1.0f; };
+    std::vector<QuatPair> pairs(kCount);
+    for (auto& p : pairs) {
+        p.a = normalize(quat{r(), r(), r(), r()});
+        p.b = normalize(quat{r(), r(), r(), r()});
+        p.t = 0.5f + 0.5f * r();
+    }
+    return pairs;
+}
+
+BENCHMARK(slerp) {
+    std::vector<QuatPair> pairs = random_pairs();
+    std::vector<quat> out(kCount);
+    state.set_items(kCount);
+    while (state.keep_running()) {
+        for (int i = 0; i < kCount; ++i) out[i] = slerp(pairs[i].a, pairs[i].b, pairs[i].t);
+        bench_keep(out[kCount / 2]);
+    }
+}
+
+BENCHMARK(nlerp) {
+    std::vector<QuatPair> pairs = random_pairs();
+    std::vector<quat> out(kCount);
+    state.set_items(kCount);
+    while (state.keep_running()) {
+        for (int i = 0; i < kCount; ++i) out[i] = lerp(pairs[i].a, pairs[i].b, pairs[i].t);
+        bench_keep(out[kCount / 2]);
+    }
+}
+
+BENCHMARK_MAIN()
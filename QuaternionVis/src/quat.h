@@ -1,6 +1,7 @@
 #pragma once
 #include "vec3.h"
 #include "mat4.h"
+#include "fast_math.h"
 #include <cmath>
 
 struct quat {
@@ -85,10 +86,10 @@ inline quat slerp(quat a, quat b, float t) {
         return lerp(a, b, t);
     }
 
-    float theta = std::acos(d);
-    float sin_theta = std::sin(theta);
-    float wa = std::sin((1.0f - t) * theta) / sin_theta;
-    float wb = std::sin(t * theta) / sin_theta;
+    float theta = fast_acos(d);
+    float sin_theta = fast_sin(theta);
+    float wa = fast_sin((1.0f - t) * theta) / sin_theta;
+    float wb = fast_sin(t * theta) / sin_theta;
 
     return {
         wa * a.w + wb * b.w,
@@ -0,0 +1,97 @@
+// Step benchmark and allocation check for the Verlet chain.
+//
+// Steps a short chain (the app's, solved sequentially) and a long one (solved
+// as parallel red-black colors) with the app's gravity and iteration count,
+// and reports time per step and heap allocations per step.
+//
+//   verlet_chain_bench [--particles N] [--steps N] [--warmup N] [--fail-on-alloc]
+//
+// With --fail-on-alloc it exits non-zero if any step after the warmup
+// allocates; the verlet_chain_alloc_check target runs it that way. Counting
+// needs a -DPHYSICS_ALLOC_TRACKING=ON build.
+
+#include "chain.h"
+#include "job_system.h"
+#include "alloc_hooks.h"
+#include "alloc_tracking.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+constexpr int   kShortParticles       = 20;
+constexpr float kSegmentLength        = 25.0f;
+constexpr Vec2  kGravity              = {0.0f, -980.0f};
+constexpr int   kConstraintIterations = 8;
+constexpr float kDt                   = 1.0f / 60.0f;
+
+static void print_usage() {
+    std::fprintf(stderr,
+        "usage: verlet_chain_bench [options]\n"
+        "  --particles N     particles in the long chain (default 20000)\n"
+        "  --steps N         steps to time after the warmup (default 600)\n"
+        "  --warmup N        steps allowed to allocate (default 10)\n"
+        "  --fail-on-alloc   exit 1 if any step after the warmup allocates\n");
+}
+
+int main(int argc, char** argv) {
+    int  particles     = 20000;
+    int  steps         = 600;
+    int  warmup        = 10;
+    bool fail_on_alloc = false;
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--particles") == 0 && has_value) {
+            particles = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--steps") == 0 && has_value) {
+            steps = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--warmup") == 0 && has_value) {
+            warmup = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--fail-on-alloc") == 0) {
+            fail_on_alloc = true;
+        } else {
+            print_usage();
+            return 1;
+        }
+    }
+    if (particles < 2 || steps < 1 || warmup < 0) {
+        print_usage();
+        return 1;
+    }
+    if (fail_on_alloc && !alloc_tracking_enabled()) {
+        std::fprintf(stderr, "--fail-on-alloc needs a build configured with -DPHYSICS_ALLOC_TRACKING=ON\n");
+        return 1;
+    }
+
+    Chain short_chain({0.0f, 0.0f}, kShortParticles, kSegmentLength);
+    Chain long_chain({0.0f, 0.0f}, particles, kSegmentLength * kShortParticles / particles);
+    long_chain.set_parallel_solve(true);
+
+    AllocFrameStats allocs(warmup);
+    double short_ms = 0.0, long_ms = 0.0;
+    for (int step = 0; step < warmup + steps; ++step) {
+        auto t0 = std::chrono::steady_clock::now();
+        short_chain.update(kDt, kGravity, kConstraintIterations);
+        auto t1 = std::chrono::steady_clock::now();
+        long_chain.update(kDt, kGravity, kConstraintIterations);
+        auto t2 = std::chrono::steady_clock::now();
+        allocs.end_frame();
+        if (step >= warmup) {
+            short_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+            long_ms  += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        }
+    }
+
+    std::printf("%d threads: %d particles %.4f ms/step, %d particles %.3f ms/step  (tip y %.1f, %.1f)\n",
+                JobSystem::instance().thread_count(), kShortParticles, short_ms / steps, particles,
+                long_ms / steps, short_chain.positions().back().y, long_chain.positions().back().y);
+    allocs.print(stdout);
+
+    if (fail_on_alloc && allocs.steady_allocates()) {
+        std::fprintf(stderr, "FAIL: %llu allocations after the %d-step warmup\n",
+                     static_cast<unsigned long long>(allocs.steady_allocs()), warmup);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+// Kernel microbenchmarks for the chain solver (bench.h):
+//
+//   constraint_projection  one distance projection, in a Gauss-Seidel sweep
+//                          down a 4096-particle chain (the sequential solver)
+//   constraint_red_black   the same sweep as even then odd constraints (the
+//                          order the parallel solver uses), on one thread
+//   chain_update_app       a whole step of the app's 20-particle chain, 8 iterations
+
+#include "chain.h"
+#include "bench.h"
+#include <vector>
+
+constexpr int   kParticles  = 4096;
+constexpr float kRestLength = 1.0f;
+constexpr int   kIterations = 8;
+
+// A chain stretched to 1.5x its rest length, with some sideways wiggle, so
+// every projection has work to do
+static std::vector<Particle> stretched_chain() {
+    std::vector<Particle> particles(kParticles);
+    for (int i = 0; i < kParticles; ++i) {
+        particles[i].pos      = {0.3f * static_cast<float>(i % 7), -1.5f * kRestLength * i};
+        particles[i].prev_pos = particles[i].pos;
+    }
+    particles[0].pinned = true;
+    return particles;
+}
+
+BENCHMARK(constraint_projection) {
+    std::vector<Particle> particles = stretched_chain();
+    state.set_items(static_cast<double>(kParticles - 1));
+    while (state.keep_running()) {
+        for (int i = 0; i + 1 < kParticles; ++i) project_distance(particles[i], particles[i + 1], kRestLength);
+        bench_keep(particles[kParticles / 2].pos);
+    }
+}
+
+BENCHMARK(constraint_red_black) {
+    std::vector<Particle> particles = stretched_chain();
+    state.set_items(static_cast<double>(kParticles - 1));
+    while (state.keep_running()) {
+        for (int i = 0; i + 1 < kParticles; i += 2) project_distance(particles[i], particles[i + 1], kRestLength);
+        for (int i = 1; i + 1 < kParticles; i += 2) project_distance(particles[i], particles[i + 1], kRestLength);
+        bench_keep(particles[kParticles / 2].pos);
+    }
+}
+
+BENCHMARK(chain_update_app) {
+    Chain chain({0.0f, 0.0f}, 20, 25.0f);
+    state.set_items(1.0);
+    while (state.keep_running()) {
+        chain.update(1.0f / 60.0f, {0.0f, -980.0f}, kIterations);
+        bench_keep(chain.positions().back());
+    }
+}
+
+BENCHMARK_MAIN()
@@ -1,4 +1,10 @@
 #include "chain.h"
+#include "job_system.h"
+#include "perf_counters.h"
+
+// Work per parallel chunk: particles to integrate, constraints to project
+static constexpr int kIntegrateGrain  = 1024;
+static constexpr int kConstraintGrain = 512;
 
 Chain::Chain(Vec2 anchor_pos, int num_particles, float segment_length) {
     particles_.reserve(num_particles);
@@ -66,27 +72,40 @@ std::size_t Chain::find_nearest(Vec2 pos, float max_dist) const {
 
 void Chain::integrate(float dt, Vec2 gravity) {
     Vec2 gravity_step = gravity * (dt * dt);
-    for (auto& p : particles_) {
-        if (p.pinned) continue;
+    parallel_for(0, static_cast<int>(particles_.size()), kIntegrateGrain, [&](int i) {
+        Particle& p = particles_[i];
+        if (p.pinned) return;
         Vec2 displacement = p.pos - p.prev_pos;
         p.prev_pos = p.pos;
         p.pos = p.pos + displacement + gravity_step;
-    }
+    });
 }
 
-void Chain::solve_constraints(int iterations) {
-    for (int iter = 0; iter < iterations; ++iter) {
-        for (auto& [a, b, rest] : constraints_) {
-            Vec2 delta = particles_[b].pos - particles_[a].pos;
-            float dist = delta.length();
-            if (dist < 1e-6f) continue;
+void Chain::project_constraint(const Constraint& c) {
+    project_distance(particles_[c.a], particles_[c.b], c.rest_length);
+}
 
-            float error = (dist - rest) / dist;
-            Vec2 correction = delta * (0.5f * error);
+void Chain::solve_constraints(int iterations) {
+    int count = static_cast<int>(constraints_.size());
+
+    // Plain Gauss-Seidel down the chain unless a long chain asked for the
+    // parallel order
+    if (!parallel_solve_ || count < 2 * kConstraintGrain) {
+        PERF_SCOPE("constraint solve", static_cast<double>(count) * iterations);
+        for (int iter = 0; iter < iterations; ++iter)
+            for (const auto& c : constraints_) project_constraint(c);
+        return;
+    }
 
-            if (!particles_[a].pinned) particles_[a].pos += correction;
-            if (!particles_[b].pinned) particles_[b].pos -= correction;
-        }
+    // Red-black: constraint i joins particles i and i + 1, so the even
+    // constraints share no particle and neither do the odd ones. Each
+    // iteration projects one colour in parallel, then the other. Not the
+    // sequential order, so the results differ from it.
+    PERF_SCOPE("constraint solve", static_cast<double>(count) * iterations, PerfScope::kAllThreads);
+    int evens = (count + 1) / 2, odds = count / 2;
+    for (int iter = 0; iter < iterations; ++iter) {
+        parallel_for(0, evens, kConstraintGrain, [&](int k) { project_constraint(constraints_[2 * k]); });
+        parallel_for(0, odds, kConstraintGrain, [&](int k) { project_constraint(constraints_[2 * k + 1]); });
     }
 }
 
@@ -16,6 +16,20 @@ struct Constraint {
     float rest_length;
 };
 
+// Moves a and b along the line between them, half the error each, so they
+// end rest_length apart. Pinned particles stay put.
+inline void project_distance(Particle& a, Particle& b, float rest_length) {
+    Vec2 delta = b.pos - a.pos;
+    float dist = delta.length();
+    if (dist < 1e-6f) return;
+
+    float error = (dist - rest_length) / dist;
+    Vec2 correction = delta * (0.5f * error);
+
+    if (!a.pinned) a.pos += correction;
+    if (!b.pinned) b.pos -= correction;
+}
+
 class Chain {
 public:
     static constexpr std::size_t npos = static_cast<std::size_t>(-1);
@@ -33,12 +47,22 @@ public:
 
     std::size_t find_nearest(Vec2 pos, float max_dist) const;
 
+    // Off by default: constraints are projected in order down the chain
+    // (Gauss-Seidel). On, chains of 1024 or more constraints project the
+    // even and then the odd constraints, each colour in parallel. That
+    // order gives different results and converges more slowly per
+    // iteration, so it is for long chains that need the threads.
+    void set_parallel_solve(bool on) { parallel_solve_ = on; }
+    bool parallel_solve() const { return parallel_solve_; }
+
 private:
     std::vector<Particle> particles_;
     std::vector<Constraint> constraints_;
     std::vector<Vec2> pos_cache_;
+    bool parallel_solve_ = false;
 
     void integrate(float dt, Vec2 gravity);
     void solve_constraints(int iterations);
+    void project_constraint(const Constraint& c);
     void sync_pos_cache();
 };
@@ -0,0 +1,58 @@
+// Constraint solve convergence: a long chain with every particle knocked
+// off its rest position must pull its links back to within tolerance of the
+// rest length in both orders, the sequential Gauss-Seidel sweep and the
+// parallel red-black colours.
+
+#include "chain.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+constexpr int   kParticles  = 4096;   // past the parallel threshold
+constexpr float kRestLength = 1.0f;
+constexpr float kJitter     = 0.2f;   // of the rest length, per axis
+constexpr int   kIterations = 256;
+// Of the rest length, worst link. Float positions along a 4096-unit chain
+// floor the error near 1e-3; 256 iterations reach about 2e-3 sequentially
+// and 4e-3 in red-black order, down from 0.44.
+constexpr float kTolerance  = 1e-2f;
+
+// Worst |length - rest| / rest over the chain's links
+static float worst_link_error(const Chain& chain) {
+    auto pos = chain.positions();
+    float worst = 0.0f;
+    for (std::size_t i = 0; i + 1 < pos.size(); ++i)
+        worst = std::max(worst, std::fabs((pos[i + 1] - pos[i]).length() - kRestLength) / kRestLength);
+    return worst;
+}
+
+// Knocks every free particle up to kJitter off its rest position (the same
+// offsets every call), then runs one step with no gravity so only the
+// constraints move it
+static float solve_perturbed(bool parallel, int iterations) {
+    Chain chain({0.0f, 0.0f}, kParticles, kRestLength);
+    chain.set_parallel_solve(parallel);
+    std::srand(3);
+    auto r = [] { return kJitter * kRestLength * (2.0f * static_cast<float>(std::rand()) / RAND_MAX - 1.0f); };
+    for (int i = 1; i < kParticles; ++i) {
+        float dx = r(), dy = r();
+        chain.set_particle_pos(i, {dx, -kRestLength * i + dy});
+    }
+    chain.update(0.0f, {0.0f, 0.0f}, iterations);
+    return worst_link_error(chain);
+}
+
+int main() {
+    bool ok = true;
+    for (bool parallel : {false, true}) {
+        float before = solve_perturbed(parallel, 0);
+        float after  = solve_perturbed(parallel, kIterations);
+        bool  pass   = after <= kTolerance;
+        std::printf("%-10s worst link error %.3g -> %.3g after %d iterations%s\n",
+                    parallel ? "red-black" : "sequential", before, after, kIterations,
+                    pass ? "" : "  FAIL");
+        ok = ok && pass;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
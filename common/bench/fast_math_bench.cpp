@@ -0,0 +1,135 @@
+// Microbenchmark and accuracy check: fast_math.h versus libm.
+//
+// For each function, fills an input array spanning the documented range,
+// times libm and the fast version over the same data (best of several
+// repetitions), and reports ns/element plus max error against a double
+// precision reference.
+
+#include "fast_math.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+constexpr int kCount       = 1 << 16;
+constexpr int kRepetitions = 200;
+
+// --- Input generation --------------------------------------------------------
+
+static std::vector<float> linear_inputs(float lo, float hi) {
+    std::vector<float> v(kCount);
+    for (int i = 0; i < kCount; ++i)
+        v[i] = lo + (hi - lo) * (static_cast<float>(i) + 0.5f) / kCount;
+    return v;
+}
+
+// Log-spaced positive inputs, for log/pow over many decades
+static std::vector<float> log_inputs(float lo, float hi) {
+    std::vector<float> v(kCount);
+    double llo = std::log(lo), lhi = std::log(hi);
+    for (int i = 0; i < kCount; ++i)
+        v[i] = static_cast<float>(std::exp(llo + (lhi - llo) * (i + 0.5) / kCount));
+    return v;
+}
+
+// --- Timing ------------------------------------------------------------------
+
+template <typename Fn>
+static double time_ns_per_elem(const std::vector<float>& in, std::vector<float>& out, Fn fn) {
+    double best = 1e30;
+    for (int rep = 0; rep < kRepetitions; ++rep) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < kCount; ++i) out[i] = fn(in[i]);
+        auto t1 = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+        if (ns < best) best = ns;
+    }
+    // Keep the result observable so the loops are not elided
+    volatile float sink = out[kCount / 2];
+    (void)sink;
+    return best / kCount;
+}
+
+struct ErrorStats {
+    double max_abs = 0.0;
+    double max_rel = 0.0;
+};
+
+template <typename Ref>
+static ErrorStats measure_error(const std::vector<float>& in, const std::vector<float>& out, Ref ref) {
+    ErrorStats e;
+    for (int i = 0; i < kCount; ++i) {
+        double want = ref(static_cast<double>(in[i]));
+        double err = std::fabs(static_cast<double>(out[i]) - want);
+        if (err > e.max_abs) e.max_abs = err;
+        if (std::fabs(want) > 1e-30) {
+            double rel = err / std::fabs(want);
+            if (rel > e.max_rel) e.max_rel = rel;
+        }
+    }
+    return e;
+}
+
+template <typename Libm, typename Fast, typename Ref>
+static void run(const char* name, const char* range, const std::vector<float>& in,
+                Libm libm, Fast fast, Ref ref) {
+    std::vector<float> out(kCount);
+    double libm_ns = time_ns_per_elem(in, out, libm);
+    double fast_ns = time_ns_per_elem(in, out, fast);
+    ErrorStats err = measure_error(in, out, ref);
+
+    std::printf("%-10s %-22s %8.3f %8.3f %7.2fx   %.2e  %.2e\n",
+                name, range, libm_ns, fast_ns, libm_ns / fast_ns, err.max_abs, err.max_rel);
+}
+
+// --- Main --------------------------------------------------------------------
+
+int main() {
+    std::printf("%-10s %-22s %8s %8s %8s   %-9s %-9s\n",
+                "function", "range", "libm ns", "fast ns", "speedup", "max abs", "max rel");
+
+    run("sin", "[-8192, 8192]", linear_inputs(-8192.0f, 8192.0f),
+        [](float x) { return std::sin(x); },
+        [](float x) { return fast_sin(x); },
+        [](double x) { return std::sin(x); });
+
+    run("cos", "[-8192, 8192]", linear_inputs(-8192.0f, 8192.0f),
+        [](float x) { return std::cos(x); },
+        [](float x) { return fast_cos(x); },
+        [](double x) { return std::cos(x); });
+
+    run("sin", "[-pi, pi]", linear_inputs(-kFastPi, kFastPi),
+        [](float x) { return std::sin(x); },
+        [](float x) { return fast_sin(x); },
+        [](double x) { return std::sin(x); });
+
+    run("acos", "[-1, 1]", linear_inputs(-1.0f, 1.0f),
+        [](float x) { return std::acos(x); },
+        [](float x) { return fast_acos(x); },
+        [](double x) { return std::acos(x); });
+
+    run("exp", "[-87, 88]", linear_inputs(-87.0f, 88.0f),
+        [](float x) { return std::exp(x); },
+        [](float x) { return fast_exp(x); },
+        [](double x) { return std::exp(x); });
+
+    run("log", "[1e-30, 1e30]", log_inputs(1e-30f, 1e30f),
+        [](float x) { return std::log(x); },
+        [](float x) { return fast_log(x); },
+        [](double x) { return std::log(x); });
+
+    // pow with a fixed exponent; the orbital radial term is rho^l
+    constexpr float kPowY = 7.5f;
+    run("pow", "x^7.5, [1e-3, 1e3]", log_inputs(1e-3f, 1e3f),
+        [](float x) { return std::pow(x, kPowY); },
+        [](float x) { return fast_pow(x, kPowY); },
+        [](double x) { return std::pow(x, static_cast<double>(kPowY)); });
+
+    run("ipow", "x^3, [0, 40]", linear_inputs(0.0f, 40.0f),
+        [](float x) { return std::pow(x, 3.0f); },
+        [](float x) { return fast_ipow(x, 3); },
+        [](double x) { return x * x * x; });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "alloc_tracking.h"
+
+// Replaces the global operator new and delete so alloc_tracking.h can count
+// them. Include from exactly one source file of a program (next to main);
+// a second copy fails to link. Does nothing unless PHYSICS_ALLOC_TRACKING
+// is defined.
+//
+// Each block carries a small header in front of the pointer handed out,
+// holding what malloc returned and the size requested, so deletes can count
+// the bytes they give back whichever form of delete is called.
+
+#if defined(PHYSICS_ALLOC_TRACKING)
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+struct AllocHeader {
+    void*       raw;
+    std::size_t size;
+};
+
+void* tracked_alloc(std::size_t size, std::size_t align) {
+    if (align < alignof(std::max_align_t)) align = alignof(std::max_align_t);
+    void* raw = std::malloc(size + sizeof(AllocHeader) + align);
+    if (!raw) return nullptr;
+    auto at = reinterpret_cast<std::uintptr_t>(raw) + sizeof(AllocHeader);
+    at = (at + align - 1) & ~(static_cast<std::uintptr_t>(align) - 1);
+    auto* header = reinterpret_cast<AllocHeader*>(at) - 1;
+    header->raw  = raw;
+    header->size = size;
+    g_alloc_counters.on_alloc(size);
+    t_alloc_counts.allocs++;
+    t_alloc_counts.bytes += size;
+    return reinterpret_cast<void*>(at);
+}
+
+// As the standard operator new: retry through the new_handler until it
+// frees memory, throws, or there is none
+void* tracked_alloc_or_throw(std::size_t size, std::size_t align) {
+    for (;;) {
+        if (void* p = tracked_alloc(size, align)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+// The nothrow forms: the same, with nullptr instead of bad_alloc
+void* tracked_alloc_nothrow(std::size_t size, std::size_t align) noexcept {
+    try {
+        return tracked_alloc_or_throw(size, align);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void tracked_free(void* p) {
+    if (!p) return;
+    auto* header = static_cast<AllocHeader*>(p) - 1;
+    g_alloc_counters.on_free(header->size);
+    std::free(header->raw);
+}
+
+constexpr std::size_t kDefaultAlign = alignof(std::max_align_t);
+
+// Tells the reports that this program's allocations are being counted
+[[maybe_unused]] const bool kAllocHooksLinked = (g_alloc_hooks_linked.store(true, std::memory_order_relaxed), true);
+
+}   // namespace
+
+void* operator new(std::size_t n)                                         { return tracked_alloc_or_throw(n, kDefaultAlign); }
+void* operator new[](std::size_t n)                                       { return tracked_alloc_or_throw(n, kDefaultAlign); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept         { return tracked_alloc_nothrow(n, kDefaultAlign); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept       { return tracked_alloc_nothrow(n, kDefaultAlign); }
+void* operator new(std::size_t n, std::align_val_t a)                     { return tracked_alloc_or_throw(n, static_cast<std::size_t>(a)); }
+void* operator new[](std::size_t n, std::align_val_t a)                   { return tracked_alloc_or_throw(n, static_cast<std::size_t>(a)); }
+void* operator new(std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept   { return tracked_alloc_nothrow(n, static_cast<std::size_t>(a)); }
+void* operator new[](std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept { return tracked_alloc_nothrow(n, static_cast<std::size_t>(a)); }
+
+void operator delete(void* p) noexcept                                        { tracked_free(p); }
+void operator delete[](void* p) noexcept                                      { tracked_free(p); }
+void operator delete(void* p, std::size_t) noexcept                           { tracked_free(p); }
+void operator delete[](void* p, std::size_t) noexcept                         { tracked_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept                 { tracked_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept               { tracked_free(p); }
+void operator delete(void* p, std::align_val_t) noexcept                      { tracked_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept                    { tracked_free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept         { tracked_free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept       { tracked_free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept   { tracked_free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { tracked_free(p); }
+#endif
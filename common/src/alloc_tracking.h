@@ -0,0 +1,146 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Heap allocation counters, for holding the frame loops to "no allocations
+// once warmed up". Configure with -DPHYSICS_ALLOC_TRACKING=ON and include
+// alloc_hooks.h from one source file of the program: every operator new and
+// delete then passes through here. Without the option nothing is counted
+// and the counters stay at zero.
+//
+// Counts are kept for the whole process and for each thread. PERF_SCOPE
+// stages (perf_counters.h) report the allocations made inside them from the
+// same counters, and AllocFrameStats turns them into per-frame numbers.
+
+struct AllocCounts {
+    std::uint64_t allocs = 0;   // calls to operator new
+    std::uint64_t bytes  = 0;   // bytes requested
+};
+
+constexpr bool alloc_tracking_enabled() {
+#if defined(PHYSICS_ALLOC_TRACKING)
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Written by alloc_hooks.h; everything else only reads them
+struct AllocCounters {
+    std::atomic<std::uint64_t> allocs{0};
+    std::atomic<std::uint64_t> bytes{0};
+    std::atomic<std::int64_t>  live_bytes{0};
+    std::atomic<std::int64_t>  peak_live_bytes{0};
+
+    void on_alloc(std::size_t size) {
+        allocs.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(size, std::memory_order_relaxed);
+        std::int64_t live = live_bytes.fetch_add(static_cast<std::int64_t>(size), std::memory_order_relaxed) +
+                            static_cast<std::int64_t>(size);
+        std::int64_t peak = peak_live_bytes.load(std::memory_order_relaxed);
+        while (live > peak && !peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    }
+
+    void on_free(std::size_t size) {
+        live_bytes.fetch_sub(static_cast<std::int64_t>(size), std::memory_order_relaxed);
+    }
+};
+
+inline AllocCounters             g_alloc_counters;
+inline thread_local AllocCounts  t_alloc_counts;
+
+// Set by alloc_hooks.h in programs that include it. Without the hooks the
+// counters never move, so reports show "not tracked" rather than zeros.
+inline std::atomic<bool>         g_alloc_hooks_linked{false};
+
+// Whether allocations are actually being counted in this program
+inline bool alloc_counting() {
+    return alloc_tracking_enabled() && g_alloc_hooks_linked.load(std::memory_order_relaxed);
+}
+
+// Since the program started: all threads, and the calling thread
+inline AllocCounts alloc_counts() {
+    return {g_alloc_counters.allocs.load(std::memory_order_relaxed),
+            g_alloc_counters.bytes.load(std::memory_order_relaxed)};
+}
+inline AllocCounts alloc_thread_counts() { return t_alloc_counts; }
+
+// Bytes allocated and not yet freed, now and at most
+inline std::int64_t alloc_live_bytes()      { return g_alloc_counters.live_bytes.load(std::memory_order_relaxed); }
+inline std::int64_t alloc_peak_live_bytes() { return g_alloc_counters.peak_live_bytes.load(std::memory_order_relaxed); }
+
+// Allocations per frame, from the process-wide counters. The first
+// warmup_frames frames may allocate (buffers growing to size, first-use
+// setup); after that is the steady state, which should allocate nothing.
+//
+//   allocs/frame: peak 41 (18.2 KB) in frame 0; steady state (540 frames) 0, 0 B
+//   heap: 1.4 MB live, 1.9 MB peak
+class AllocFrameStats {
+public:
+    explicit AllocFrameStats(int warmup_frames = 60) : warmup_(warmup_frames) { last_ = alloc_counts(); }
+
+    // Closes the frame that started at the previous call (or construction)
+    void end_frame() {
+        AllocCounts now = alloc_counts();
+        std::uint64_t allocs = now.allocs - last_.allocs;
+        std::uint64_t bytes  = now.bytes - last_.bytes;
+        last_ = now;
+        if (allocs > peak_allocs_ || frames_ == 0) {
+            peak_allocs_ = allocs;
+            peak_bytes_  = bytes;
+            peak_frame_  = frames_;
+        }
+        if (frames_ >= warmup_) {
+            steady_frames_++;
+            steady_allocs_ += allocs;
+            steady_bytes_  += bytes;
+            if (allocs > 0) steady_dirty_frames_++;
+        }
+        frames_++;
+    }
+
+    int           frames() const          { return frames_; }
+    int           steady_frames() const   { return steady_frames_; }
+    std::uint64_t steady_allocs() const   { return steady_allocs_; }
+    bool          steady_allocates() const { return steady_allocs_ > 0; }
+
+    void print(std::FILE* out) const {
+        if (!alloc_tracking_enabled()) {
+            std::fprintf(out, "allocs/frame: not tracked (configure with -DPHYSICS_ALLOC_TRACKING=ON)\n");
+            return;
+        }
+        if (!alloc_counting()) {
+            std::fprintf(out, "allocs/frame: not tracked (this program does not include alloc_hooks.h)\n");
+            return;
+        }
+        std::fprintf(out, "allocs/frame: peak %llu (%.1f KB) in frame %d; ", ull(peak_allocs_),
+                     peak_bytes_ / 1024.0, peak_frame_);
+        if (steady_frames_ == 0) {
+            std::fprintf(out, "no steady state yet (%d warmup frames)\n", warmup_);
+        } else {
+            std::fprintf(out, "steady state (%d frames) %.2f, %.0f B", steady_frames_,
+                         static_cast<double>(steady_allocs_) / steady_frames_,
+                         static_cast<double>(steady_bytes_) / steady_frames_);
+            if (steady_dirty_frames_ > 0) std::fprintf(out, ", %d frames allocated", steady_dirty_frames_);
+            std::fprintf(out, "\n");
+        }
+        std::fprintf(out, "heap: %.1f MB live, %.1f MB peak\n", alloc_live_bytes() / (1024.0 * 1024.0),
+                     alloc_peak_live_bytes() / (1024.0 * 1024.0));
+    }
+
+private:
+    static unsigned long long ull(std::uint64_t v) { return static_cast<unsigned long long>(v); }
+
+    int           warmup_;
+    AllocCounts   last_;
+    int           frames_              = 0;
+    std::uint64_t peak_allocs_         = 0;
+    std::uint64_t peak_bytes_          = 0;
+    int           peak_frame_          = 0;
+    int           steady_frames_       = 0;
+    int           steady_dirty_frames_ = 0;
+    std::uint64_t steady_allocs_       = 0;
+    std::uint64_t steady_bytes_        = 0;
+};
@@ -0,0 +1,348 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+// Microbenchmark harness for the projects' kernels. A benchmark sets up its
+// data, says how many items one iteration covers, and runs its loop body
+// while state.keep_running():
+//
+//   BENCHMARK(aabb_overlap) {
+//       std::vector<AABB> boxes = random_boxes(256);
+//       state.set_items(pairs_of(256));
+//       while (state.keep_running()) {
+//           int hits = count_overlaps(boxes);
+//           bench_keep(hits);
+//       }
+//   }
+//   BENCHMARK_MAIN()
+//
+// Only the loop is timed. The harness first grows the iteration count until
+// one batch takes --min-ms. It then runs --warmup untimed batches, then
+// --samples timed ones, and reports the median time per item with its
+// median absolute deviation (MAD). The thread is pinned to one CPU so the
+// samples do not migrate between cores.
+//
+// --json writes the results as a baseline. --compare reads one back and
+// marks each benchmark faster, slower or unchanged. A change counts only if
+// it is larger than --threshold percent and larger than the noise, which is
+// 3 MADs of the two runs combined. Any significant slowdown makes the exit
+// status 1, so a build target can gate on it.
+
+// Keeps value (and whatever it depends on) from being optimized away
+template <typename T>
+inline void bench_keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+#endif
+}
+
+class BenchState {
+public:
+    explicit BenchState(std::uint64_t iterations) : iterations_(iterations), remaining_(iterations) {}
+
+    // Work one iteration does, for the per-item times (default 1)
+    void set_items(double items) { items_ = items; }
+
+    // True iterations() times; the clock runs from the first call to the last
+    bool keep_running() {
+        if (!started_) {
+            started_ = true;
+            start_   = Clock::now();
+        }
+        if (remaining_ > 0) {
+            --remaining_;
+            return true;
+        }
+        if (!stopped_) {
+            stopped_ = true;
+            elapsed_ns_ = std::chrono::duration<double, std::nano>(Clock::now() - start_).count();
+        }
+        return false;
+    }
+
+    std::uint64_t iterations() const { return iterations_; }
+    double        items() const      { return items_; }
+    bool          finished() const   { return stopped_; }
+    double        elapsed_ns() const { return elapsed_ns_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::uint64_t     iterations_;
+    std::uint64_t     remaining_;
+    double            items_      = 1.0;
+    bool              started_    = false;
+    bool              stopped_    = false;
+    Clock::time_point start_{};
+    double            elapsed_ns_ = 0.0;
+};
+
+using BenchFn = void (*)(BenchState&);
+
+struct BenchCase {
+    const char* name;
+    BenchFn     fn;
+};
+
+inline std::vector<BenchCase>& bench_registry() {
+    static std::vector<BenchCase> cases;
+    return cases;
+}
+
+struct BenchRegistrar {
+    BenchRegistrar(const char* name, BenchFn fn) { bench_registry().push_back({name, fn}); }
+};
+
+#define BENCHMARK(name)                                                        \
+    static void bench_##name(BenchState& state);                               \
+    static BenchRegistrar bench_registrar_##name(#name, bench_##name);         \
+    static void bench_##name(BenchState& state)
+
+#define BENCHMARK_MAIN() \
+    int main(int argc, char** argv) { return bench_main(argc, argv); }
+
+// One benchmark's timings, in ns per item
+struct BenchResult {
+    std::string   name;
+    double        median_ns  = 0.0;
+    double        mad_ns     = 0.0;
+    double        min_ns     = 0.0;
+    std::uint64_t iterations = 0;   // per sample
+    int           samples    = 0;
+};
+
+struct BenchOptions {
+    double      min_ms    = 10.0;
+    int         warmup    = 2;
+    int         samples   = 15;
+    int         cpu       = -1;     // -1: the CPU the harness starts on
+    bool        pin       = true;
+    double      threshold = 5.0;    // percent
+    const char* filter    = nullptr;
+    const char* json      = nullptr;
+    const char* compare   = nullptr;
+};
+
+inline double bench_median(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+    std::size_t n = v.size();
+    return n % 2 ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+}
+
+// Runs fn once with the given iteration count; false if it never ran its loop
+inline bool bench_batch(const BenchCase& bc, std::uint64_t iterations, double& ns, double& items) {
+    BenchState state(iterations);
+    bc.fn(state);
+    if (!state.finished()) {
+        std::fprintf(stderr, "%s: the benchmark body must loop while state.keep_running()\n", bc.name);
+        return false;
+    }
+    ns    = state.elapsed_ns();
+    items = state.items();
+    return true;
+}
+
+inline bool bench_run(const BenchCase& bc, const BenchOptions& opt, BenchResult& result) {
+    // Grow the batch until it takes min_ms; this also warms caches and clocks
+    double target_ns = opt.min_ms * 1e6;
+    std::uint64_t iterations = 1;
+    double ns = 0.0, items = 1.0;
+    for (;;) {
+        if (!bench_batch(bc, iterations, ns, items)) return false;
+        if (ns >= target_ns || iterations >= (std::uint64_t(1) << 40)) break;
+        double grow = ns > 0.0 ? 1.2 * target_ns / ns : 100.0;
+        iterations = static_cast<std::uint64_t>(iterations * std::clamp(grow, 2.0, 100.0));
+    }
+    for (int i = 0; i < opt.warmup; ++i)
+        if (!bench_batch(bc, iterations, ns, items)) return false;
+
+    std::vector<double> per_item(opt.samples);
+    for (int i = 0; i < opt.samples; ++i) {
+        if (!bench_batch(bc, iterations, ns, items)) return false;
+        per_item[i] = ns / (static_cast<double>(iterations) * (items > 0.0 ? items : 1.0));
+    }
+    result.name       = bc.name;
+    result.median_ns  = bench_median(per_item);
+    result.min_ns     = *std::min_element(per_item.begin(), per_item.end());
+    for (double& v : per_item) v = std::fabs(v - result.median_ns);
+    result.mad_ns     = bench_median(per_item);
+    result.iterations = iterations;
+    result.samples    = opt.samples;
+    return true;
+}
+
+// Pins the calling thread to one CPU; returns the CPU, or -1 if not pinned
+inline int bench_pin(int cpu) {
+#if defined(__linux__)
+    if (cpu < 0) cpu = sched_getcpu();
+    if (cpu < 0) return -1;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        std::fprintf(stderr, "Cannot pin to CPU %d, running unpinned\n", cpu);
+        return -1;
+    }
+    return cpu;
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+// Baseline: one benchmark per line, which is all bench_find_baseline has to
+// understand
+inline bool bench_write_json(const char* path, const std::vector<BenchResult>& results, int cpu) {
+    std::FILE* f = std::fopen(path, "w");
+    if (!f) {
+        std::fprintf(stderr, "Cannot open %s for writing\n", path);
+        return false;
+    }
+    std::fprintf(f, "{\n  \"unit\": \"ns_per_item\",\n  \"cpu\": %d,\n  \"benchmarks\": {\n", cpu);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        std::fprintf(f, "    \"%s\": {\"median\": %.6g, \"mad\": %.6g, \"min\": %.6g, "
+                     "\"iterations\": %llu, \"samples\": %d}%s\n",
+                     r.name.c_str(), r.median_ns, r.mad_ns, r.min_ns,
+                     static_cast<unsigned long long>(r.iterations), r.samples,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(f, "  }\n}\n");
+    std::fclose(f);
+    return true;
+}
+
+// Median and MAD of one benchmark from a baseline file's text
+inline bool bench_find_baseline(const std::string& json, const std::string& name, double& median, double& mad) {
+    std::size_t at = json.find("\"" + name + "\": {");
+    if (at == std::string::npos) return false;
+    std::size_t m = json.find("\"median\": ", at);
+    std::size_t d = json.find("\"mad\": ", at);
+    if (m == std::string::npos || d == std::string::npos) return false;
+    median = std::strtod(json.c_str() + m + 10, nullptr);
+    mad    = std::strtod(json.c_str() + d + 7, nullptr);
+    return true;
+}
+
+inline bool bench_read_file(const char* path, std::string& text) {
+    std::FILE* f = std::fopen(path, "r");
+    if (!f) {
+        std::fprintf(stderr, "Cannot open baseline %s\n", path);
+        return false;
+    }
+    char buf[4096];
+    for (std::size_t n; (n = std::fread(buf, 1, sizeof(buf), f)) > 0;) text.append(buf, n);
+    std::fclose(f);
+    return true;
+}
+
+inline void bench_usage(const char* argv0) {
+    std::fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --list              list the benchmarks and exit\n"
+        "  --filter TEXT       run only benchmarks whose name contains TEXT\n"
+        "  --min-ms MS         time per sample batch (default 10)\n"
+        "  --samples N         timed batches per benchmark (default 15)\n"
+        "  --warmup N          untimed batches before sampling (default 2)\n"
+        "  --cpu N             pin to CPU N (default: the CPU it starts on)\n"
+        "  --no-pin            do not pin\n"
+        "  --json PATH         write the results as a baseline\n"
+        "  --compare PATH      compare against a baseline; exit 1 on a significant slowdown\n"
+        "  --threshold PCT     smallest change --compare reports (default 5)\n",
+        argv0);
+}
+
+inline int bench_main(int argc, char** argv) {
+    BenchOptions opt;
+    bool list = false;
+    for (int i = 1; i < argc; ++i) {
+        const char* flag = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        auto takes = [&](const char* name) {
+            if (std::strcmp(flag, name) != 0 || !value) return false;
+            ++i;
+            return true;
+        };
+        if (std::strcmp(flag, "--list") == 0)        list = true;
+        else if (std::strcmp(flag, "--no-pin") == 0) opt.pin = false;
+        else if (takes("--filter"))    opt.filter    = value;
+        else if (takes("--min-ms"))    opt.min_ms    = std::atof(value);
+        else if (takes("--samples"))   opt.samples   = std::atoi(value);
+        else if (takes("--warmup"))    opt.warmup    = std::atoi(value);
+        else if (takes("--cpu"))       opt.cpu       = std::atoi(value);
+        else if (takes("--json"))      opt.json      = value;
+        else if (takes("--compare"))   opt.compare   = value;
+        else if (takes("--threshold")) opt.threshold = std::atof(value);
+        else {
+            bench_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (opt.samples < 1 || opt.warmup < 0 || opt.min_ms <= 0.0) {
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<const BenchCase*> selected;
+    for (const BenchCase& bc : bench_registry())
+        if (!opt.filter || std::strstr(bc.name, opt.filter)) selected.push_back(&bc);
+    if (list) {
+        for (const BenchCase* bc : selected) std::printf("%s\n", bc->name);
+        return 0;
+    }
+
+    std::string baseline;
+    if (opt.compare && !bench_read_file(opt.compare, baseline)) return 1;
+
+    int cpu = opt.pin ? bench_pin(opt.cpu) : -1;
+    if (cpu >= 0) std::printf("pinned to CPU %d, ", cpu);
+    std::printf("%d samples of >= %.0f ms, times in ns per item\n\n", opt.samples, opt.min_ms);
+    std::printf("%-28s %10s %9s %10s %12s", "benchmark", "median", "MAD", "min", "iterations");
+    if (opt.compare) std::printf(" %10s %8s  %s", "baseline", "change", "verdict");
+    std::printf("\n");
+
+    std::vector<BenchResult> results;
+    int regressions = 0;
+    for (const BenchCase* bc : selected) {
+        BenchResult r;
+        if (!bench_run(*bc, opt, r)) return 1;
+        std::printf("%-28s %10.4g %9.3g %10.4g %12llu", r.name.c_str(), r.median_ns, r.mad_ns, r.min_ns,
+                    static_cast<unsigned long long>(r.iterations));
+        double base = 0.0, base_mad = 0.0;
+        if (opt.compare && bench_find_baseline(baseline, r.name, base, base_mad) && base > 0.0) {
+            double change = 100.0 * (r.median_ns - base) / base;
+            double noise  = 3.0 * std::sqrt(r.mad_ns * r.mad_ns + base_mad * base_mad);
+            bool   real   = std::fabs(change) > opt.threshold && std::fabs(r.median_ns - base) > noise;
+            const char* verdict = !real ? "same" : change > 0.0 ? "SLOWER" : "faster";
+            if (real && change > 0.0) regressions++;
+            std::printf(" %10.4g %+7.1f%%  %s", base, change, verdict);
+        } else if (opt.compare) {
+            std::printf(" %10s %8s  %s", "-", "-", "new");
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+        results.push_back(r);
+    }
+
+    if (opt.json && !bench_write_json(opt.json, results, cpu)) return 1;
+    if (opt.compare) {
+        std::printf("\n%d of %zu benchmarks significantly slower than %s\n", regressions, results.size(),
+                    opt.compare);
+        if (regressions > 0) return 1;
+    }
+    return 0;
+}
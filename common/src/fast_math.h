@@ -0,0 +1,185 @@
+#pragma once
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+// Fast single-precision transcendentals shared by all simulations.
+//
+// Every function is branch-free (ternaries compile to selects), so a plain
+// loop over an array of floats auto-vectorizes. GCC only if-converts float
+// compares and sqrt under -fno-trapping-math -fno-math-errno, which the
+// physics_common target adds to its consumers. The polynomials are the
+// Cephes single-precision minimax fits; SIMD kernels reuse the kFast*
+// coefficients below so scalar and vector paths agree.
+//
+// Max error against a double-precision reference, measured by
+// fast_math_bench:
+//
+//   fast_sin / fast_cos   |x| <= 8192        abs 7.4e-8
+//   fast_acos             [-1, 1]            abs 2.9e-7 rad
+//   fast_exp              [-87, 88]          rel 7.9e-8
+//   fast_log              [1e-30, 1e30]      rel 7.3e-8
+//   fast_pow              x^7.5, [1e-3, 1e3] rel 3.9e-6 (grows with |y*log x|)
+//   fast_ipow             exact up to one rounding per multiply
+//
+// Inputs outside the listed ranges are clamped or lose accuracy; NaN/Inf
+// are not handled. sin/cos reduce by pi/2 with a three-part Cody-Waite
+// split, which stays accurate while x * 2/pi fits in 22 bits.
+
+constexpr float kFastPi     = 3.14159265358979323846f;
+constexpr float kFastHalfPi = 1.57079632679489661923f;
+
+// --- sin / cos ---------------------------------------------------------------
+
+constexpr float kFastTwoOverPi  = 0.636619772367581343076f;
+constexpr float kFastPio2Hi     = 1.5703125f;
+constexpr float kFastPio2Mid    = 4.837512969970703125e-4f;
+constexpr float kFastPio2Lo     = 7.54978995489188216e-8f;
+constexpr float kFastRoundMagic = 12582912.0f; // 1.5 * 2^23
+
+constexpr float kFastSinP0 = -1.9515295891e-4f;
+constexpr float kFastSinP1 =  8.3321608736e-3f;
+constexpr float kFastSinP2 = -1.6666654611e-1f;
+
+constexpr float kFastCosP0 =  2.443315711809948e-5f;
+constexpr float kFastCosP1 = -1.388731625493765e-3f;
+constexpr float kFastCosP2 =  4.166664568298827e-2f;
+
+// Computes sin(x) and cos(x) with one shared range reduction.
+inline void fast_sincos(float x, float& out_sin, float& out_cos) {
+    // Quadrant j = round(x / (pi/2)), r = x - j * pi/2 in [-pi/4, pi/4]
+    float fj = (x * kFastTwoOverPi + kFastRoundMagic) - kFastRoundMagic;
+    auto  j  = static_cast<std::int32_t>(fj);
+    float r  = ((x - fj * kFastPio2Hi) - fj * kFastPio2Mid) - fj * kFastPio2Lo;
+    float z  = r * r;
+
+    float s = ((kFastSinP0 * z + kFastSinP1) * z + kFastSinP2) * z * r + r;
+    float c = ((kFastCosP0 * z + kFastCosP1) * z + kFastCosP2) * z * z
+              - 0.5f * z + 1.0f;
+
+    bool swap = (j & 1) != 0;
+    float sv = swap ? c : s;
+    float cv = swap ? s : c;
+    out_sin = (j & 2)       ? -sv : sv;
+    out_cos = ((j + 1) & 2) ? -cv : cv;
+}
+
+inline float fast_sin(float x) {
+    float s, c;
+    fast_sincos(x, s, c);
+    return s;
+}
+
+inline float fast_cos(float x) {
+    float s, c;
+    fast_sincos(x, s, c);
+    return c;
+}
+
+// --- acos --------------------------------------------------------------------
+
+constexpr float kFastAsinP0 = 4.2163199048e-2f;
+constexpr float kFastAsinP1 = 2.4181311049e-2f;
+constexpr float kFastAsinP2 = 4.5470025998e-2f;
+constexpr float kFastAsinP3 = 7.4953002686e-2f;
+constexpr float kFastAsinP4 = 1.6666752422e-1f;
+
+// acos(x) for x in [-1, 1]. |x| > 0.5 goes through asin(sqrt((1-|x|)/2))
+// so the result stays accurate near the endpoints, where slerp lives.
+inline float fast_acos(float x) {
+    float a   = std::fabs(x);
+    bool  big = a > 0.5f;
+    float z   = big ? 0.5f * (1.0f - a) : a * a;
+    float s   = big ? std::sqrt(z) : a;
+
+    float p = ((((kFastAsinP0 * z + kFastAsinP1) * z + kFastAsinP2) * z
+                + kFastAsinP3) * z + kFastAsinP4) * z * s + s;   // asin(s)
+
+    float big_r   = 2.0f * p;                                     // acos(|x|)
+    float big_res = (x < 0.0f) ? kFastPi - big_r : big_r;
+    float small_res = kFastHalfPi - ((x < 0.0f) ? -p : p);
+    return big ? big_res : small_res;
+}
+
+// --- exp / log / pow ---------------------------------------------------------
+
+constexpr float kFastLog2e   = 1.44269504088896341f;
+constexpr float kFastLn2Hi   = 0.693359375f;
+constexpr float kFastLn2Lo   = -2.12194440e-4f;
+constexpr float kFastExpMax  = 88.3762626647949f;
+constexpr float kFastExpMin  = -87.3365447504019f;
+
+constexpr float kFastExpP0 = 1.9875691500e-4f;
+constexpr float kFastExpP1 = 1.3981999507e-3f;
+constexpr float kFastExpP2 = 8.3334519073e-3f;
+constexpr float kFastExpP3 = 4.1665795894e-2f;
+constexpr float kFastExpP4 = 1.6666665459e-1f;
+constexpr float kFastExpP5 = 5.0000001201e-1f;
+
+inline float fast_exp(float x) {
+    x = x > kFastExpMax ? kFastExpMax : x;
+    x = x < kFastExpMin ? kFastExpMin : x;
+
+    // x = n*ln2 + r, |r| <= ln2/2
+    float fn = (x * kFastLog2e + kFastRoundMagic) - kFastRoundMagic;
+    float r  = (x - fn * kFastLn2Hi) - fn * kFastLn2Lo;
+    float z  = r * r;
+
+    float y = (((((kFastExpP0 * r + kFastExpP1) * r + kFastExpP2) * r
+                 + kFastExpP3) * r + kFastExpP4) * r + kFastExpP5) * z + r + 1.0f;
+
+    // Scale by 2^n through the exponent bits
+    auto n = static_cast<std::int32_t>(fn);
+    return y * std::bit_cast<float>(static_cast<std::uint32_t>(n + 127) << 23);
+}
+
+constexpr float kFastSqrtHalf = 0.707106781186547524f;
+
+constexpr float kFastLogP0 =  7.0376836292e-2f;
+constexpr float kFastLogP1 = -1.1514610310e-1f;
+constexpr float kFastLogP2 =  1.1676998740e-1f;
+constexpr float kFastLogP3 = -1.2420140846e-1f;
+constexpr float kFastLogP4 =  1.4249322787e-1f;
+constexpr float kFastLogP5 = -1.6668057665e-1f;
+constexpr float kFastLogP6 =  2.0000714765e-1f;
+constexpr float kFastLogP7 = -2.4999993993e-1f;
+constexpr float kFastLogP8 =  3.3333331174e-1f;
+
+// Natural log for normal, positive x.
+inline float fast_log(float x) {
+    // Split x = m * 2^e with m in [0.5, 1)
+    auto bits = std::bit_cast<std::uint32_t>(x);
+    float e = static_cast<float>(static_cast<std::int32_t>(bits >> 23) - 126);
+    float m = std::bit_cast<float>((bits & 0x007fffffu) | 0x3f000000u);
+
+    // Shift m into [sqrt(1/2), sqrt(2)) so the polynomial argument is small
+    bool low = m < kFastSqrtHalf;
+    e = low ? e - 1.0f : e;
+    float t = low ? (m + m) - 1.0f : m - 1.0f;
+    float z = t * t;
+
+    float y = ((((((((kFastLogP0 * t + kFastLogP1) * t + kFastLogP2) * t
+                    + kFastLogP3) * t + kFastLogP4) * t + kFastLogP5) * t
+                  + kFastLogP6) * t + kFastLogP7) * t + kFastLogP8) * t * z;
+
+    y += e * kFastLn2Lo;
+    y -= 0.5f * z;
+    return t + y + e * kFastLn2Hi;
+}
+
+// x^y for x > 0. Relative error scales with |y * log(x)|; prefer
+// fast_ipow for small integer exponents such as rho^l.
+inline float fast_pow(float x, float y) {
+    return fast_exp(y * fast_log(x));
+}
+
+// x^n for n >= 0 by repeated squaring. Exact up to float rounding.
+inline float fast_ipow(float x, int n) {
+    float result = 1.0f;
+    while (n > 0) {
+        if (n & 1) result *= x;
+        x *= x;
+        n >>= 1;
+    }
+    return result;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Bump allocator for buffers that live for one frame, as a std::pmr memory
+// resource: give it to std::pmr containers, drop the containers at the end of
+// the frame, then reset(). Allocation is a pointer bump; deallocation does
+// nothing; reset() rewinds everything at once.
+//
+// Memory comes in blocks. When a frame outgrows the current block another
+// one is added, and the next reset() merges them into a single block large
+// enough for that frame. Once frames stop growing the arena never goes back
+// to the heap, and nothing it hands out fragments the heap in between.
+//
+// allocate() takes a lock, so the stages of a task graph can share one arena.
+class FrameArena : public std::pmr::memory_resource {
+public:
+    explicit FrameArena(std::size_t initial_bytes = 64 * 1024) { add_block(initial_bytes); }
+
+    ~FrameArena() override {
+        for (auto& b : blocks_) ::operator delete(b.data, std::align_val_t{kBlockAlign});
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Invalidates everything allocated since the last reset
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (blocks_.size() > 1) {
+            std::size_t total = 0;
+            for (auto& b : blocks_) {
+                total += b.size;
+                ::operator delete(b.data, std::align_val_t{kBlockAlign});
+            }
+            blocks_.clear();
+            add_block(total);
+        }
+        high_water_ = std::max(high_water_, used_);
+        used_   = 0;
+        offset_ = 0;
+    }
+
+    // Between frames: bytes handed out since the last reset, the most any
+    // frame used, and the bytes held across all blocks
+    std::size_t used() const { return used_; }
+    std::size_t high_water() const { return std::max(high_water_, used_); }
+    std::size_t capacity() const {
+        std::size_t total = 0;
+        for (auto& b : blocks_) total += b.size;
+        return total;
+    }
+
+private:
+    static constexpr std::size_t kBlockAlign = 64;
+
+    struct Block {
+        std::byte*  data;
+        std::size_t size;
+    };
+
+    void add_block(std::size_t bytes) {
+        bytes = std::max<std::size_t>(bytes, 4096);
+        auto* data = static_cast<std::byte*>(::operator new(bytes, std::align_val_t{kBlockAlign}));
+        blocks_.push_back({data, bytes});
+        offset_ = 0;
+    }
+
+    // Next aligned slot in the current block, or null if it does not fit
+    void* bump(std::size_t bytes, std::size_t align) {
+        Block& b = blocks_.back();
+        auto base = reinterpret_cast<std::uintptr_t>(b.data);
+        std::size_t at = ((base + offset_ + align - 1) & ~(align - 1)) - base;
+        if (at + bytes > b.size) return nullptr;
+        offset_ = at + bytes;
+        used_  += bytes;
+        return b.data + at;
+    }
+
+    void* do_allocate(std::size_t bytes, std::size_t align) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        void* p = bump(bytes, align);
+        if (!p) {
+            // Double up so a growing frame adds few blocks
+            add_block(std::max(bytes + align, 2 * blocks_.back().size));
+            p = bump(bytes, align);
+        }
+        return p;
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {}   // reclaimed by reset()
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::mutex         mutex_;
+    std::vector<Block> blocks_;
+    std::size_t        offset_     = 0;   // into blocks_.back()
+    std::size_t        used_       = 0;
+    std::size_t        high_water_ = 0;
+};
@@ -0,0 +1,333 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Work-stealing job system shared by all simulations: one pool per process,
+// so parallel stages that run at the same time (a render and a post pass,
+// a BVH build inside a batch job) share the cores instead of each spawning
+// a thread per core.
+//
+// Every pool thread owns a Chase-Lev deque: it pushes and pops new work at
+// the bottom (LIFO, cache-warm), idle threads steal from the top (FIFO, the
+// oldest and largest pieces of a recursive split). Threads outside the pool
+// queue into a small locked ring instead. Jobs are plain structs the caller
+// owns, usually on its stack, and a join counter says when they are done:
+// submit() bumps it, finishing a job drops it, and wait() runs queued work
+// (anyone's) until it reaches zero, so a waiting thread never idles while
+// there is work and nested parallelism cannot deadlock. Idle threads spin
+// briefly and then block, so a pool shared with other busy threads does not
+// steal their time slices. Nothing here
+// allocates after the pool starts.
+//
+//   parallel_for(begin, end, grain, fn)   fn(i) for every i, in chunks of at least grain
+//   parallel_invoke(a, b)                 a() and b() as a fork / join pair
+//
+// With one hardware thread the pool has no workers and both run inline.
+
+struct Job {
+    void (*execute)(Job* self) = nullptr;
+    std::atomic<int>* pending = nullptr;   // set by submit()
+};
+
+// Chase-Lev deque (Le et al., "Correct and Efficient Work-Stealing for Weak
+// Memory Models", 2013) over a fixed ring. push() and pop() are for the
+// owning thread only; steal() may be called from any thread.
+class WorkStealingDeque {
+public:
+    static constexpr std::int64_t kCapacity = 4096;
+
+    // False if full; the caller then runs the job itself
+    bool push(Job* job) {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t >= kCapacity) return false;
+        slots_[b & (kCapacity - 1)].store(job, std::memory_order_relaxed);
+        bottom_.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    Job* pop() {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+        Job* job = nullptr;
+        if (t <= b) {
+            job = slots_[b & (kCapacity - 1)].load(std::memory_order_relaxed);
+            if (t == b) {
+                // Last one: race the thieves for it
+                if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                  std::memory_order_relaxed))
+                    job = nullptr;
+                bottom_.store(b + 1, std::memory_order_relaxed);
+            }
+        } else {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* steal() {
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+        Job* job = slots_[t & (kCapacity - 1)].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed))
+            return nullptr;
+        return job;
+    }
+
+private:
+    alignas(64) std::atomic<std::int64_t> top_{0};
+    alignas(64) std::atomic<std::int64_t> bottom_{0};
+    std::atomic<Job*> slots_[kCapacity] = {};
+};
+
+class JobSystem {
+public:
+    // workers < 0: one per hardware thread beyond the caller's
+    explicit JobSystem(int workers = -1)
+        : workers_(workers >= 0 ? workers
+                                : static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) - 1) {
+        for (int i = 0; i < workers_; ++i) deques_.push_back(std::make_unique<WorkStealingDeque>());
+        threads_.reserve(workers_);
+        for (int i = 0; i < workers_; ++i) threads_.emplace_back([this, i] { worker_main(i); });
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stop_.store(true);
+        }
+        wake_.notify_all();
+        for (auto& t : threads_) t.join();
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // The process-wide pool, started on first use
+    static JobSystem& instance() {
+        static JobSystem pool;
+        return pool;
+    }
+
+    int worker_count() const { return workers_; }
+    int thread_count() const { return worker_count() + 1; }   // workers and a waiting caller
+
+    // Queues job under the join counter pending. The job must stay alive
+    // until pending has been waited down past it.
+    void submit(Job& job, std::atomic<int>& pending) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        job.pending = &pending;
+
+        bool queued;
+        if (tls_pool() == this) {
+            queued = deques_[tls_index()]->push(&job);
+        } else {
+            std::lock_guard<std::mutex> lock(inject_mutex_);
+            queued = inject_tail_ - inject_head_ < kInjectCapacity;
+            if (queued) inject_[inject_tail_++ & (kInjectCapacity - 1)] = &job;
+        }
+        if (!queued) {
+            run(&job);
+            return;
+        }
+
+        queued_.fetch_add(1);
+        if (sleepers_.load() > 0) {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            wake_.notify_one();
+        }
+    }
+
+    // Runs queued jobs until pending reaches zero; once there is nothing left
+    // to help with, sleeps until the last job on pending finishes
+    void wait(const std::atomic<int>& pending) {
+        int idle = 0;
+        while (pending.load(std::memory_order_acquire) != 0) {
+            if (Job* job = find_work()) {
+                run(job);
+                idle = 0;
+            } else if (++idle < kSpinRounds) {
+                std::this_thread::yield();
+            } else {
+                waiters_.fetch_add(1);
+                {
+                    std::unique_lock<std::mutex> lock(sleep_mutex_);
+                    done_.wait(lock, [&] { return pending.load() == 0; });
+                }
+                waiters_.fetch_sub(1);
+            }
+        }
+    }
+
+private:
+    static constexpr std::int64_t kInjectCapacity = 1024;
+    static constexpr int          kSpinRounds     = 16;   // yields before an idle thread sleeps
+
+    // Pool membership of the calling thread
+    static JobSystem*& tls_pool() {
+        thread_local JobSystem* pool = nullptr;
+        return pool;
+    }
+    static int& tls_index() {
+        thread_local int index = -1;
+        return index;
+    }
+
+    void run(Job* job) {
+        std::atomic<int>* pending = job->pending;   // job and pending may be gone once it drops
+        job->execute(job);
+        // Same handshake as the worker sleep below, against waiters_
+        if (pending->fetch_sub(1) == 1 && waiters_.load() > 0) {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            done_.notify_all();
+        }
+    }
+
+    Job* take_injected() {
+        if (queued_.load(std::memory_order_relaxed) == 0) return nullptr;
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        if (inject_head_ == inject_tail_) return nullptr;
+        return inject_[inject_head_++ & (kInjectCapacity - 1)];
+    }
+
+    // Own deque, then the injection ring, then the other deques
+    Job* find_work() {
+        int self = (tls_pool() == this) ? tls_index() : -1;
+        Job* job = (self >= 0) ? deques_[self]->pop() : nullptr;
+        if (!job) job = take_injected();
+        for (int k = 1; !job && k <= worker_count(); ++k) {
+            int victim = (self + k) % worker_count();
+            if (victim < 0) victim += worker_count();
+            job = deques_[victim]->steal();
+        }
+        if (job) queued_.fetch_sub(1, std::memory_order_relaxed);
+        return job;
+    }
+
+    void worker_main(int index) {
+        tls_pool() = this;
+        tls_index() = index;
+        int idle = 0;
+        while (!stop_.load(std::memory_order_relaxed)) {
+            if (Job* job = find_work()) {
+                run(job);
+                idle = 0;
+                continue;
+            }
+            if (++idle < kSpinRounds) {
+                std::this_thread::yield();
+                continue;
+            }
+            // Sleep until something is queued. submit() bumps queued_ before
+            // reading sleepers_ and we do the reverse, so one of us sees the other.
+            sleepers_.fetch_add(1);
+            {
+                std::unique_lock<std::mutex> lock(sleep_mutex_);
+                wake_.wait(lock, [this] { return stop_.load() || queued_.load() > 0; });
+            }
+            sleepers_.fetch_sub(1);
+            idle = 0;
+        }
+    }
+
+    const int workers_;
+    std::vector<std::unique_ptr<WorkStealingDeque>> deques_;   // one per worker
+    std::vector<std::thread> threads_;
+
+    std::mutex   inject_mutex_;                 // ring for threads outside the pool
+    Job*         inject_[kInjectCapacity] = {};
+    std::int64_t inject_head_ = 0, inject_tail_ = 0;
+
+    std::atomic<int>        queued_{0};         // jobs sitting in any queue
+    std::atomic<int>        sleepers_{0};        // workers waiting for jobs
+    std::atomic<int>        waiters_{0};         // wait() callers waiting for a counter
+    std::atomic<bool>       stop_{false};
+    std::mutex              sleep_mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+};
+
+// --- parallel_for ------------------------------------------------------------
+
+template <typename Fn>
+struct ParallelForJob : Job {
+    JobSystem* pool;
+    int        begin, end, grain;
+    Fn*        fn;
+};
+
+// Splits [begin, end) in halves, queueing each right half and keeping the
+// left, down to grain; the halves queued first are the largest, which is
+// what thieves take.
+template <typename Fn>
+void parallel_for_split(JobSystem& pool, int begin, int end, int grain, Fn& fn) {
+    ParallelForJob<Fn> halves[32];   // halving an int range takes at most 31 levels
+    std::atomic<int>   pending{0};
+    int depth = 0;
+    while (end - begin > grain) {
+        int mid = begin + (end - begin) / 2;
+        auto& job = halves[depth++];
+        job.execute = [](Job* self) {
+            auto* j = static_cast<ParallelForJob<Fn>*>(self);
+            parallel_for_split(*j->pool, j->begin, j->end, j->grain, *j->fn);
+        };
+        job.pool  = &pool;
+        job.begin = mid;
+        job.end   = end;
+        job.grain = grain;
+        job.fn    = &fn;
+        pool.submit(job, pending);
+        end = mid;
+    }
+    for (int i = begin; i < end; ++i) fn(i);
+    pool.wait(pending);
+}
+
+// fn(i) for every i in [begin, end) across the shared pool; blocks until
+// done. Chunks hold at least grain items, so pick grain so a chunk is worth
+// a few microseconds.
+template <typename Fn>
+void parallel_for(int begin, int end, int grain, Fn&& fn) {
+    if (end <= begin) return;
+    JobSystem& pool = JobSystem::instance();
+    grain = std::max(grain, 1);
+    if (pool.worker_count() == 0 || end - begin <= grain) {
+        for (int i = begin; i < end; ++i) fn(i);
+        return;
+    }
+    parallel_for_split(pool, begin, end, grain, fn);
+}
+
+// --- parallel_invoke ---------------------------------------------------------
+
+// a() on this thread while b() is open to the pool, then joins
+template <typename A, typename B>
+void parallel_invoke(A&& a, B&& b) {
+    JobSystem& pool = JobSystem::instance();
+    if (pool.worker_count() == 0) {
+        a();
+        b();
+        return;
+    }
+    struct InvokeJob : Job {
+        std::remove_reference_t<B>* fn;
+    } job;
+    job.execute = [](Job* self) { (*static_cast<InvokeJob*>(self)->fn)(); };
+    job.fn = &b;
+    std::atomic<int> pending{0};
+    pool.submit(job, pending);
+    a();
+    pool.wait(pending);
+}
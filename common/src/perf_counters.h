@@ -0,0 +1,359 @@
+#pragma once
+#include "alloc_tracking.h"
+#include "job_system.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <dirent.h>
+#include <cstdlib>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware performance counters around named stages of a frame, for finding
+// out whether a stage is bound by instructions, cache misses or mispredicted
+// branches. Built with -DPHYSICS_PERF_COUNTERS=ON, a stage is one line:
+//
+//   PERF_SCOPE("narrow phase", pairs.size());
+//
+// and the process prints a table at exit (or whenever PerfReport::print is
+// called): calls, time, cycles and instructions per element, IPC, and L1D,
+// last-level cache and branch misses per element. Without this option (or
+// PHYSICS_ALLOC_TRACKING, below) PERF_SCOPE expands to nothing.
+//
+// A scope counts either its own thread, which is exact for a stage that runs
+// on one thread, or every thread in the process, for stages that fan out on
+// the job system. The all-threads counters attach to the threads alive when
+// they are first used, so threads started later are not counted, and
+// anything else running at the time (the main thread drawing, another stage)
+// is counted with the stage.
+//
+// Counters come from perf_event_open and count user space only. Where the
+// kernel refuses (no PMU in a VM or container, perf_event_paranoid, not
+// Linux) the missing events print as "-", a one-line notice says why, and
+// stages still report wall time.
+//
+// With -DPHYSICS_ALLOC_TRACKING=ON (alloc_tracking.h) scopes are compiled in
+// too, and two more columns give heap allocations and kilobytes per call,
+// counted over the same threads as the hardware counters. They print as "-"
+// in programs that do not include alloc_hooks.h, where nothing is counted.
+
+enum PerfEvent {
+    kPerfCycles,
+    kPerfInstructions,
+    kPerfL1dMisses,
+    kPerfLlcMisses,
+    kPerfBranchMisses,
+    kPerfEventCount
+};
+
+// Which events this process can count, probed once on first use
+class PerfSupport {
+public:
+    static const PerfSupport& instance() {
+        static PerfSupport support;
+        return support;
+    }
+
+    bool available(int event) const { return available_[event]; }
+    bool any() const {
+        for (bool a : available_) if (a) return true;
+        return false;
+    }
+
+    static const char* event_name(int event) {
+        static const char* names[kPerfEventCount] = {
+            "cycles", "instructions", "L1D misses", "LLC misses", "branch misses"};
+        return names[event];
+    }
+
+#if defined(__linux__)
+    // Counter for one event on thread tid (0 = calling thread), -1 on failure
+    static int open_event(int event, int tid) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        switch (event) {
+        case kPerfCycles:
+            attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+        case kPerfInstructions:
+            attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+        case kPerfL1dMisses:
+            attr.type   = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case kPerfLlcMisses:
+            attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+        default:
+            attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+        }
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, -1, PERF_FLAG_FD_CLOEXEC));
+    }
+#endif
+
+private:
+    PerfSupport() {
+#if defined(__linux__)
+        int first_errno = 0;
+        for (int e = 0; e < kPerfEventCount; ++e) {
+            int fd = open_event(e, 0);
+            available_[e] = fd >= 0;
+            if (fd >= 0) close(fd);
+            else if (!first_errno) first_errno = errno;
+        }
+        if (!any()) {
+            std::fprintf(stderr, "perf counters unavailable (%s), reporting wall time only\n",
+                         std::strerror(first_errno));
+        } else {
+            for (int e = 0; e < kPerfEventCount; ++e)
+                if (!available_[e]) std::fprintf(stderr, "perf counters: %s unavailable\n", event_name(e));
+        }
+#else
+        std::fprintf(stderr, "perf counters need Linux, reporting wall time only\n");
+#endif
+    }
+
+    bool available_[kPerfEventCount] = {};
+};
+
+// One set of counters on one thread
+class PerfThreadCounters {
+public:
+    PerfThreadCounters() = default;
+    explicit PerfThreadCounters(int tid) { open(tid); }
+    ~PerfThreadCounters() { close_all(); }
+
+    PerfThreadCounters(PerfThreadCounters&& o) noexcept {
+        std::memcpy(fd_, o.fd_, sizeof(fd_));
+        for (int& fd : o.fd_) fd = -1;
+    }
+    PerfThreadCounters(const PerfThreadCounters&) = delete;
+    PerfThreadCounters& operator=(const PerfThreadCounters&) = delete;
+
+    void open(int tid) {
+        close_all();
+#if defined(__linux__)
+        const PerfSupport& support = PerfSupport::instance();
+        for (int e = 0; e < kPerfEventCount; ++e)
+            if (support.available(e)) fd_[e] = PerfSupport::open_event(e, tid);
+#else
+        (void)tid;
+#endif
+    }
+
+    // Adds the running totals, scaled up if the kernel multiplexed the counters
+    void accumulate(double* totals) const {
+#if defined(__linux__)
+        for (int e = 0; e < kPerfEventCount; ++e) {
+            if (fd_[e] < 0) continue;
+            std::uint64_t v[3];   // value, time enabled, time running
+            if (::read(fd_[e], v, sizeof(v)) != static_cast<ssize_t>(sizeof(v))) continue;
+            double scale = v[2] > 0 && v[2] < v[1] ? static_cast<double>(v[1]) / v[2] : 1.0;
+            totals[e] += static_cast<double>(v[0]) * scale;
+        }
+#else
+        (void)totals;
+#endif
+    }
+
+private:
+    void close_all() {
+#if defined(__linux__)
+        for (int& fd : fd_)
+            if (fd >= 0) ::close(fd);
+#endif
+        for (int& fd : fd_) fd = -1;
+    }
+
+    int fd_[kPerfEventCount] = {-1, -1, -1, -1, -1};
+};
+
+// Counters on the calling thread, opened on its first scope
+inline const PerfThreadCounters& perf_this_thread() {
+    thread_local PerfThreadCounters counters(0);
+    return counters;
+}
+
+// Counters on every thread of the process: the job system's pool, the
+// caller and whatever else is running when this is first called
+inline const std::vector<PerfThreadCounters>& perf_all_threads() {
+    static const std::vector<PerfThreadCounters> counters = [] {
+        std::vector<PerfThreadCounters> all;
+        JobSystem::instance();   // start the pool so its workers are listed
+#if defined(__linux__)
+        if (PerfSupport::instance().any()) {
+            if (DIR* dir = opendir("/proc/self/task")) {
+                while (dirent* entry = readdir(dir))
+                    if (entry->d_name[0] != '.') all.emplace_back(std::atoi(entry->d_name));
+                closedir(dir);
+            }
+        }
+#endif
+        return all;
+    }();
+    return counters;
+}
+
+// Totals per stage name, printed as a table
+class PerfReport {
+public:
+    static PerfReport& instance() {
+        static PerfReport report;
+        return report;
+    }
+
+    ~PerfReport() {
+        if (count_ > 0) print(stderr);
+    }
+
+    // name must outlive the report (a string literal)
+    void add(const char* name, double ms, double elements, const double* counts, AllocCounts allocs) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stage* s = nullptr;
+        for (int i = 0; i < count_ && !s; ++i)
+            if (stages_[i].name == name || std::strcmp(stages_[i].name, name) == 0) s = &stages_[i];
+        if (!s) {
+            if (count_ == kMaxStages) return;
+            s = &stages_[count_++];
+            *s = Stage{};
+            s->name = name;
+        }
+        s->calls++;
+        s->ms       += ms;
+        s->elements += elements;
+        for (int e = 0; e < kPerfEventCount; ++e) s->counts[e] += counts[e];
+        s->allocs      += allocs.allocs;
+        s->alloc_bytes += allocs.bytes;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        count_ = 0;
+    }
+
+    //   stage         calls  ms/call  elem/call  ns/elem  cyc/elem  IPC  L1D/elem  LLC/elem  br/elem  allocs/call  KB/call
+    //   bvh build       120    0.412        200     2.06      7.40 1.83      0.31      0.02     0.05         0.00     0.00
+    void print(std::FILE* out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::fprintf(out, "%-16s %6s %9s %10s %8s %9s %5s %9s %9s %8s %12s %8s\n", "stage", "calls", "ms/call",
+                     "elem/call", "ns/elem", "cyc/elem", "IPC", "L1D/elem", "LLC/elem", "br/elem",
+                     "allocs/call", "KB/call");
+        for (int i = 0; i < count_; ++i) {
+            const Stage& s = stages_[i];
+            double elems = s.elements > 0.0 ? s.elements : 1.0;
+            std::fprintf(out, "%-16s %6d %9.3f %10.0f %8.2f", s.name, s.calls, s.ms / s.calls,
+                         s.elements / s.calls, s.ms * 1e6 / elems);
+            print_value(out, 9, counted(kPerfCycles), s.counts[kPerfCycles] / elems);
+            print_value(out, 5, counted(kPerfCycles) && counted(kPerfInstructions) && s.counts[kPerfCycles] > 0.0,
+                        s.counts[kPerfInstructions] / s.counts[kPerfCycles]);
+            print_value(out, 9, counted(kPerfL1dMisses), s.counts[kPerfL1dMisses] / elems);
+            print_value(out, 9, counted(kPerfLlcMisses), s.counts[kPerfLlcMisses] / elems);
+            print_value(out, 8, counted(kPerfBranchMisses), s.counts[kPerfBranchMisses] / elems);
+            print_value(out, 12, alloc_counting(), static_cast<double>(s.allocs) / s.calls);
+            print_value(out, 8, alloc_counting(), s.alloc_bytes / 1024.0 / s.calls);
+            std::fprintf(out, "\n");
+        }
+    }
+
+private:
+    static constexpr int kMaxStages = 32;
+
+    struct Stage {
+        const char*   name        = "";
+        int           calls       = 0;
+        double        ms          = 0.0;
+        double        elements    = 0.0;
+        double        counts[kPerfEventCount] = {};
+        std::uint64_t allocs      = 0;
+        std::uint64_t alloc_bytes = 0;
+    };
+
+    // Hardware counters are only read in PHYSICS_PERF_COUNTERS builds
+    static bool counted(int event) {
+#if defined(PHYSICS_PERF_COUNTERS)
+        return PerfSupport::instance().available(event);
+#else
+        (void)event;
+        return false;
+#endif
+    }
+
+    static void print_value(std::FILE* out, int width, bool available, double value) {
+        if (available) std::fprintf(out, " %*.2f", width, value);
+        else           std::fprintf(out, " %*s", width, "-");
+    }
+
+    std::mutex mutex_;
+    Stage      stages_[kMaxStages];
+    int        count_ = 0;
+};
+
+// Counts one run of a stage and adds it to the report when it goes out of
+// scope. elements is what the per-element columns divide by: shapes, pairs,
+// constraints, pixels.
+class PerfScope {
+public:
+    enum Threads { kThisThread, kAllThreads };
+
+    PerfScope(const char* name, double elements, Threads threads = kThisThread)
+        : name_(name), elements_(elements), threads_(threads) {
+        read(start_, start_allocs_);
+        start_time_ = Clock::now();
+    }
+
+    ~PerfScope() {
+        double end_ms = std::chrono::duration<double, std::milli>(Clock::now() - start_time_).count();
+        double end[kPerfEventCount];
+        AllocCounts allocs;
+        read(end, allocs);
+        for (int e = 0; e < kPerfEventCount; ++e) end[e] -= start_[e];
+        allocs.allocs -= start_allocs_.allocs;
+        allocs.bytes  -= start_allocs_.bytes;
+        PerfReport::instance().add(name_, end_ms, elements_, end, allocs);
+    }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void read(double* totals, AllocCounts& allocs) const {
+        for (int e = 0; e < kPerfEventCount; ++e) totals[e] = 0.0;
+        allocs = threads_ == kThisThread ? alloc_thread_counts() : alloc_counts();
+#if defined(PHYSICS_PERF_COUNTERS)
+        if (threads_ == kThisThread) {
+            perf_this_thread().accumulate(totals);
+        } else {
+            for (const auto& t : perf_all_threads()) t.accumulate(totals);
+        }
+#endif
+    }
+
+    const char*       name_;
+    double            elements_;
+    Threads           threads_;
+    double            start_[kPerfEventCount];
+    AllocCounts       start_allocs_;
+    Clock::time_point start_time_;
+};
+
+#define PERF_SCOPE_CONCAT2(a, b) a##b
+#define PERF_SCOPE_CONCAT(a, b) PERF_SCOPE_CONCAT2(a, b)
+
+#if defined(PHYSICS_PERF_COUNTERS) || defined(PHYSICS_ALLOC_TRACKING)
+#define PERF_SCOPE(...) PerfScope PERF_SCOPE_CONCAT(perf_scope_, __LINE__)(__VA_ARGS__)
+#else
+#define PERF_SCOPE(...) ((void)0)
+#endif
@@ -0,0 +1,142 @@
+#pragma once
+#include "job_system.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+// A fixed dependency graph of named tasks, declared once and run as often as
+// needed (typically once per frame) on the shared job system. A task starts
+// as soon as the last of its dependencies finishes, so independent stages
+// overlap without the caller arranging it. Tasks that have nothing to do in
+// a given run simply return.
+//
+// Every run records when each task started and finished. The critical path
+// is the chain that set the run's length: from the task that finished last,
+// back through whichever dependency finished last before it. Shortening
+// anything off that chain does not make the run faster.
+//
+// Declaring the graph allocates; running it does not.
+class TaskGraph {
+public:
+    using TaskId = int;
+
+    // Dependencies must already be in the graph, so ids are a topological order
+    TaskId add(const char* name, std::function<void()> fn,
+               std::initializer_list<TaskId> deps = {}) {
+        TaskId id = static_cast<TaskId>(nodes_.size());
+        auto node = std::make_unique<Node>();
+        node->execute = [](Job* job) {
+            auto* n = static_cast<Node*>(job);
+            n->graph->run_node(*n);
+        };
+        node->graph = this;
+        node->id    = id;
+        node->name  = name;
+        node->fn    = std::move(fn);
+        for (TaskId d : deps) {
+            node->deps.push_back(d);
+            nodes_[d]->successors.push_back(id);
+        }
+        nodes_.push_back(std::move(node));
+        critical_path_.reserve(nodes_.size());
+        return id;
+    }
+
+    // Runs every task once and blocks until all are done
+    void run() {
+        origin_ = Clock::now();
+        for (auto& n : nodes_) n->remaining.store(static_cast<int>(n->deps.size()), std::memory_order_relaxed);
+        JobSystem& pool = JobSystem::instance();
+        for (auto& n : nodes_)
+            if (n->deps.empty()) pool.submit(*n, pending_);
+        pool.wait(pending_);
+        span_ms_ = elapsed_ms();
+        find_critical_path();
+    }
+
+    int         size() const              { return static_cast<int>(nodes_.size()); }
+    const char* name(TaskId id) const     { return nodes_[id]->name; }
+    double      start_ms(TaskId id) const { return nodes_[id]->start_ms; }   // since the run began
+    double      end_ms(TaskId id) const   { return nodes_[id]->end_ms; }
+
+    // Last run: wall time, and the sum of task times (work / span = parallelism)
+    double span_ms() const { return span_ms_; }
+    double work_ms() const {
+        double sum = 0.0;
+        for (auto& n : nodes_) sum += n->end_ms - n->start_ms;
+        return sum;
+    }
+
+    // Last run's critical path, first task first
+    const std::vector<TaskId>& critical_path() const { return critical_path_; }
+
+    // "span 0.84 ms  work 1.21 ms (1.4x)  critical: a 0.10 > b 0.52 > c 0.20"
+    void print_profile(std::FILE* out) const {
+        double work = work_ms();
+        std::fprintf(out, "span %.3f ms  work %.3f ms (%.1fx)  critical:", span_ms_, work,
+                     span_ms_ > 0.0 ? work / span_ms_ : 0.0);
+        for (std::size_t i = 0; i < critical_path_.size(); ++i) {
+            const Node& n = *nodes_[critical_path_[i]];
+            std::fprintf(out, "%s %s %.3f", i ? " >" : "", n.name, n.end_ms - n.start_ms);
+        }
+        std::fprintf(out, "\n");
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Node : Job {
+        TaskGraph*            graph = nullptr;
+        TaskId                id    = 0;
+        const char*           name  = "";
+        std::function<void()> fn;
+        std::vector<TaskId>   deps;
+        std::vector<TaskId>   successors;
+        std::atomic<int>      remaining{0};   // dependencies still running this run
+        double                start_ms = 0.0, end_ms = 0.0;
+    };
+
+    double elapsed_ms() const {
+        return std::chrono::duration<double, std::milli>(Clock::now() - origin_).count();
+    }
+
+    void run_node(Node& n) {
+        n.start_ms = elapsed_ms();
+        n.fn();
+        n.end_ms = elapsed_ms();
+        // Successors are queued before this job's own count drops, so the
+        // run cannot look finished while they are pending
+        for (TaskId s : n.successors)
+            if (nodes_[s]->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                JobSystem::instance().submit(*nodes_[s], pending_);
+    }
+
+    void find_critical_path() {
+        critical_path_.clear();
+        if (nodes_.empty()) return;
+        TaskId at = 0;
+        for (auto& n : nodes_)
+            if (n->end_ms > nodes_[at]->end_ms) at = n->id;
+        for (;;) {
+            critical_path_.push_back(at);
+            const Node& n = *nodes_[at];
+            if (n.deps.empty()) break;
+            TaskId gate = n.deps[0];
+            for (TaskId d : n.deps)
+                if (nodes_[d]->end_ms > nodes_[gate]->end_ms) gate = d;
+            at = gate;
+        }
+        std::reverse(critical_path_.begin(), critical_path_.end());
+    }
+
+    std::vector<std::unique_ptr<Node>> nodes_;
+    std::vector<TaskId>                critical_path_;
+    std::atomic<int>                   pending_{0};
+    Clock::time_point                  origin_{};
+    double                             span_ms_ = 0.0;
+};